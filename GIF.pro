@@ -12,7 +12,18 @@ SOURCES += main.cpp \
     gif.cpp \
     gif2bmp.cpp \
     gifencoder.cpp \
-    gifwriter.cpp
+    gifwriter.cpp \
+    bitreader.cpp \
+    gifstream.cpp \
+    palette.cpp \
+    gifframes.cpp \
+    threadpool.cpp \
+    gifindex.cpp \
+    probe.cpp \
+    gifarena.cpp \
+    colorhistogram.cpp \
+    quantizer.cpp \
+    ditherer.cpp
 
 HEADERS += \
     arguments.h \
@@ -25,9 +36,23 @@ HEADERS += \
     gifencoder.h \
     subblock.h \
     gifwriter.h \
-    gifdictionary.h
+    gifdictionary.h \
+    bitreader.h \
+    gifstream.h \
+    palette.h \
+    gifframes.h \
+    threadpool.h \
+    gifindex.h \
+    probe.h \
+    gifarena.h \
+    colorhistogram.h \
+    quantizer.h \
+    ditherer.h
 
-LIBS += -L/usr/local/lib \
+QMAKE_CXXFLAGS += -pthread
+
+LIBS += -pthread \
+    -L/usr/local/lib \
     -lopencv_core \
     -lopencv_imgproc \
     -lopencv_highgui \
@@ -20,6 +20,12 @@ Arguments::Arguments(int argc, const char *argv[])
     this->rsz = NONE;
     this->grayscale = false;
     this->display = false;
+    this->probe = false;
+    this->crop = false;
+    this->quantize = QUANTIZE_NORMAL;
+    this->dither = DITHER_NONE;
+    this->truecolor = false;
+    this->index_file = "";
     this->out = "";
 
     if (argc < 3)
@@ -66,6 +72,30 @@ Arguments::Arguments(int argc, const char *argv[])
             this->height = atoi(argv[++i]);
         }
 
+        // Parameter -c x y w h
+        else if (strcmp(argv[i], "-c") == 0)
+        {
+            this->crop = true;
+
+            // Parameter -c must be followed by four integer values
+            if (i + 4 >= argc)
+            {
+                this->printHelp();
+                throw "Incorect parameters";
+            }
+
+            this->crop_x = atoi(argv[++i]);
+            this->crop_y = atoi(argv[++i]);
+            this->crop_width = atoi(argv[++i]);
+            this->crop_height = atoi(argv[++i]);
+
+            if (this->crop_width <= 0 || this->crop_height <= 0)
+            {
+                this->printHelp();
+                throw "Incorect parameters";
+            }
+        }
+
         // Parameter -o
         else if (strcmp(argv[i], "-o") == 0)
         {
@@ -82,6 +112,69 @@ Arguments::Arguments(int argc, const char *argv[])
                 this->out += "/";
         }
 
+        // Parameter -q fast|normal|best
+        else if (strcmp(argv[i], "-q") == 0)
+        {
+            // Parameter -q must be followed by level
+            if (i + 1 >= argc)
+            {
+                this->printHelp();
+                throw "Incorect parameters";
+            }
+
+            i++;
+            if (strcmp(argv[i], "fast") == 0)
+                this->quantize = QUANTIZE_FAST;
+            else if (strcmp(argv[i], "normal") == 0)
+                this->quantize = QUANTIZE_NORMAL;
+            else if (strcmp(argv[i], "best") == 0)
+                this->quantize = QUANTIZE_BEST;
+            else
+            {
+                this->printHelp();
+                throw "Incorect parameters";
+            }
+        }
+
+        // Parameter --dither none|fs|bayer|noise
+        else if (strcmp(argv[i], "--dither") == 0)
+        {
+            // Parameter --dither must be followed by mode
+            if (i + 1 >= argc)
+            {
+                this->printHelp();
+                throw "Incorect parameters";
+            }
+
+            i++;
+            if (strcmp(argv[i], "none") == 0)
+                this->dither = DITHER_NONE;
+            else if (strcmp(argv[i], "fs") == 0)
+                this->dither = DITHER_FLOYD_STEINBERG;
+            else if (strcmp(argv[i], "bayer") == 0)
+                this->dither = DITHER_BAYER;
+            else if (strcmp(argv[i], "noise") == 0)
+                this->dither = DITHER_BLUE_NOISE;
+            else
+            {
+                this->printHelp();
+                throw "Incorect parameters";
+            }
+        }
+
+        // Parameter --index file
+        else if (strcmp(argv[i], "--index") == 0)
+        {
+            // Parameter --index must be followed by path
+            if (i + 1 >= argc)
+            {
+                this->printHelp();
+                throw "Incorect parameters";
+            }
+
+            this->index_file = argv[++i];
+        }
+
         // Parameter -d
         else if (strcmp(argv[i], "-d") == 0)
             this->display = true;
@@ -90,6 +183,14 @@ Arguments::Arguments(int argc, const char *argv[])
         else if (strcmp(argv[i], "-g") == 0)
             this->grayscale = true;
 
+        // Parameter --probe
+        else if (strcmp(argv[i], "--probe") == 0)
+            this->probe = true;
+
+        // Parameter --truecolor
+        else if (strcmp(argv[i], "--truecolor") == 0)
+            this->truecolor = true;
+
         // Output file formats
         else
         {
@@ -143,8 +244,11 @@ Arguments::Arguments(int argc, const char *argv[])
         }
     }
 
-    // Determines output path
-    this->out += input_file.substr(0,input_file.find_last_of("."));
+    // Determines output path, standard input has no name
+    if (input_file == "-")
+        this->out += "stdin";
+    else
+        this->out += input_file.substr(0,input_file.find_last_of("."));
 }
 
 /**
@@ -159,12 +263,24 @@ void Arguments::printHelp()
          << "[in_file]    Any of following images both grayscale and RGB:" << endl
          << "                 bmp, dib, jpeg, jpg, jpe, jp2, png, pbm, pgm," << endl
          << "                 ppm, sr, ras, tiff, tif, gif" << endl
+         << "             or - to read image from standard input (output name stdin)" << endl
          << endl
          << "[options]    -s x y            size of output in %" << endl
          << "             -r width height   width and height of the output image" << endl
+         << "             -c x y w h        crop rectangle of the input image" << endl
          << "             -d                display output" << endl
          << "             -g                convert to grayscale" << endl
          << "             -o folder         output folder" << endl
+         << "             -q level          GIF quantizer for more than 256 colors:" << endl
+         << "                               fast, normal (default), best" << endl
+         << "             --dither mode     GIF dithering for more than 256 colors:" << endl
+         << "                               none (default), fs (Floyd-Steinberg)," << endl
+         << "                               bayer, noise (blue noise)" << endl
+         << "             --truecolor       lossless GIF of more than 256 colors, tiles with" << endl
+         << "                               own palettes instead of quantization" << endl
+         << "             --index file      GIF block index cache, it is built and saved" << endl
+         << "                               when file is missing or does not match input" << endl
+         << "             --probe           print image properties as JSON, no decoding" << endl
          << endl
          << "[out_types] bmp, dib           Windows bitmaps" << endl
          << "            jpeg, jpg, jpe     JPEG format" << endl
@@ -13,6 +13,7 @@
 #include <set>
 #include <stdlib.h>
 #include <string.h>
+#include "quantizer.h"
 
 using namespace std;
 
@@ -60,8 +61,18 @@ private:
     double resize_percent_y;
     int width;
     int height;
+    bool crop;
+    int crop_x;
+    int crop_y;
+    int crop_width;
+    int crop_height;
     bool grayscale;
     bool display;
+    bool probe;
+    enum quantize_level quantize;
+    enum dither_mode dither;
+    bool truecolor;
+    string index_file;
     set<enum img_type> output;
 
     void printHelp();
@@ -111,12 +122,72 @@ public:
      */
     inline int getHeight(){return this->height;}
 
+    /**
+     * @brief Tests if crop argument was toggled
+     * @return True if image should be cropped
+     */
+    inline bool isCrop(){return this->crop;}
+
+    /**
+     * @brief Gets x position of crop rectangle
+     * @return X position of crop rectangle
+     */
+    inline int getCropX(){return this->crop_x;}
+
+    /**
+     * @brief Gets y position of crop rectangle
+     * @return Y position of crop rectangle
+     */
+    inline int getCropY(){return this->crop_y;}
+
+    /**
+     * @brief Gets width of crop rectangle
+     * @return Width of crop rectangle
+     */
+    inline int getCropWidth(){return this->crop_width;}
+
+    /**
+     * @brief Gets height of crop rectangle
+     * @return Height of crop rectangle
+     */
+    inline int getCropHeight(){return this->crop_height;}
+
     /**
      * @brief Tests if output should be displayed first
      * @return True if output should be displayed first
      */
     inline bool showOutput(){return this->display;}
 
+    /**
+     * @brief Tests if only image properties should be printed
+     * @return True if probe option was toggled
+     */
+    inline bool isProbe(){return this->probe;}
+
+    /**
+     * @brief Gets quantizer level for GIF output of images with more than 256 colors
+     * @return Quantizer level
+     */
+    inline enum quantize_level getQuantize(){return this->quantize;}
+
+    /**
+     * @brief Gets dithering of GIF output of images with more than 256 colors
+     * @return Dithering mode
+     */
+    inline enum dither_mode getDither(){return this->dither;}
+
+    /**
+     * @brief Tests if GIF output of images with more than 256 colors should be lossless
+     * @return True if truecolor option was toggled
+     */
+    inline bool isTrueColor(){return this->truecolor;}
+
+    /**
+     * @brief Gets file with saved GIF block index, empty when index is not cached
+     * @return GIF index filename
+     */
+    inline const string & getIndexFile(){return this->index_file;}
+
     /**
      * @brief Gets vector containing output file types
      * @return Vector containing output file types
@@ -0,0 +1,98 @@
+/*
+ *  File name: bitreader_bench.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Microbenchmark of LZW code bit reader, reports codes per second for each code size
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../bitreader.h"
+#include "../constant.h"
+
+#define BENCH_DATA_SIZE 					(16 * 1024 * 1024)
+#define BENCH_REPEAT 						4
+
+/**
+ * Function return monotonic time in seconds
+ *
+ * @return time in seconds
+ */
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Function fill bit reader with pseudo random data
+ *
+ * @param bitReader Pointer to bit reader
+ * @param size Data size in bytes
+ * @return 0 on success, 1 on failure
+ */
+static int fillBitReader(tBITREADER *bitReader, u_int32_t size) {
+
+	bitReader->buffer = (u_int8_t *)malloc(size + BITREADER_PADDING);
+	if (bitReader->buffer == NULL)
+		return EXIT_FAILURE;
+
+	// Deterministic xorshift data
+	u_int32_t state = 2463534242u;
+	for (u_int32_t i = 0; i < size; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		bitReader->buffer[i] = (u_int8_t)state;
+	}
+	memset(bitReader->buffer + size, 0, BITREADER_PADDING);
+
+	bitReader->bufferSize = size;
+	bitReader->bufferCapacity = size + BITREADER_PADDING;
+	rewindBitReader(bitReader);
+	return EXIT_SUCCESS;
+}
+
+int main() {
+
+	tBITREADER bitReader;
+
+	initBitReader(&bitReader);
+	if (fillBitReader(&bitReader, BENCH_DATA_SIZE)) {
+		fprintf(stderr, "%s", "Can not allocate benchmark data.\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("%-10s %14s %14s\n", "code size", "codes", "Mcodes/s");
+
+	for (int codeSize = 2; codeSize <= GIF_MAX_CODE_WORD_LENGTH_IN_BITS; codeSize++) {
+
+		u_int64_t codes = 0;
+		u_int32_t checksum = 0;
+		double best = 0;
+
+		// Best of several runs over whole buffer
+		for (int run = 0; run < BENCH_REPEAT; run++) {
+			rewindBitReader(&bitReader);
+			u_int64_t runCodes = 0;
+
+			double start = now();
+			while (!bitReaderEmpty(&bitReader, codeSize)) {
+				checksum += readCode(&bitReader, codeSize);
+				runCodes++;
+			}
+			double elapsed = now() - start;
+
+			if (best == 0 || elapsed < best)
+				best = elapsed;
+			codes = runCodes;
+		}
+
+		printf("%-10d %14llu %14.1f   (checksum %08x)\n", codeSize, (unsigned long long)codes, codes / best / 1e6, checksum);
+	}
+
+	freeBitReader(&bitReader);
+	return EXIT_SUCCESS;
+}
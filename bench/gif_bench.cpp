@@ -0,0 +1,1005 @@
+/*
+ *  File name: gif_bench.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Throughput benchmark of GIF decoder and encoder. Deterministic corpus
+ *               (sizes, palette sizes, flat and noise content, interlaced and animated
+ *               files) is generated first, then block parsing, LZW decoding, palette
+ *               expansion, whole gif2bmp decoding (also with reused decoder context,
+ *               its allocations after first run are counted) and GIFencoder phases
+ *               (histogram and quantization, LZW, write) are timed separately. Frame
+ *               reader of animations is timed sequential and with thread pool, both
+ *               have to composite same canvases. Decoded planes are checked against
+ *               generated content, also after GIF index save and load round trip,
+ *               canvases of animations (disposal methods, frame rectangles,
+ *               transparency) are checked against reference compositing
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include "../gif2bmp.h"
+#include "../gif.h"
+#include "../gifindex.h"
+#include "../gifframes.h"
+#include "../gifstream.h"
+#include "../gifencoder.h"
+#include "../constant.h"
+
+#define BENCH_CORPUS_DIR 					"bench/corpus"
+#define BENCH_MIN_TIME 						0.25
+#define BENCH_MAX_RUNS 						50
+#define BENCH_QUICK_MAX_PIXELS 				(1024 * 1024)
+#define BENCH_ENCODE_MAX_PIXELS 			(256 * 256)
+#define BENCH_FRAME_THREADS 				4
+
+#define BENCH_CONTENT_FLAT 					0
+#define BENCH_CONTENT_NOISE 				1
+
+// LZW encoder of corpus generator
+#define BENCH_LZW_MAX_CODE 					4095
+#define BENCH_LZW_HASH_SIZE 				8192
+#define BENCH_LZW_EMPTY 					0xFFFFFFFF
+
+/**
+ * @brief Corpus file description
+ */
+typedef struct{
+	const char *name;
+	u_int32_t width;
+	u_int32_t height;
+	int colors;
+	int content;
+	int interlaced;
+	int frames;
+	int composite;
+} tBENCHSPEC;
+
+/**
+ * @brief LZW encoder state of corpus generator - hash of (prefix code, color) pairs
+ * and bit packer of data sub blocks
+ */
+typedef struct{
+	u_int32_t keys[BENCH_LZW_HASH_SIZE];
+	u_int16_t codes[BENCH_LZW_HASH_SIZE];
+	std::vector<u_int8_t> data;
+	u_int32_t bits;
+	int bitCount;
+} tBENCHLZW;
+
+static const tBENCHSPEC corpus[] = {
+	{"flat-16-c2", 			16, 	16, 	2, 		BENCH_CONTENT_FLAT, 	0, 	1, 	0},
+	{"noise-16-c256", 		16, 	16, 	256, 	BENCH_CONTENT_NOISE, 	0, 	1, 	0},
+	{"flat-256-c2", 		256, 	256, 	2, 		BENCH_CONTENT_FLAT, 	0, 	1, 	0},
+	{"noise-256-c2", 		256, 	256, 	2, 		BENCH_CONTENT_NOISE, 	0, 	1, 	0},
+	{"flat-256-c16", 		256, 	256, 	16, 	BENCH_CONTENT_FLAT, 	0, 	1, 	0},
+	{"noise-256-c16", 		256, 	256, 	16, 	BENCH_CONTENT_NOISE, 	0, 	1, 	0},
+	{"noise-256-c256", 		256, 	256, 	256, 	BENCH_CONTENT_NOISE, 	0, 	1, 	0},
+	{"flat-1024-c256", 		1024, 	1024, 	256, 	BENCH_CONTENT_FLAT, 	0, 	1, 	0},
+	{"noise-1024-c256", 	1024, 	1024, 	256, 	BENCH_CONTENT_NOISE, 	0, 	1, 	0},
+	{"flat-1024-c64-il", 	1024, 	1024, 	64, 	BENCH_CONTENT_FLAT, 	1, 	1, 	0},
+	{"noise-1024-c256-il", 	1024, 	1024, 	256, 	BENCH_CONTENT_NOISE, 	1, 	1, 	0},
+	{"anim-64-c16-f100", 	64, 	64, 	16, 	BENCH_CONTENT_FLAT, 	0, 	100, 	0},
+	{"anim-256-c256-f10", 	256, 	256, 	256, 	BENCH_CONTENT_FLAT, 	0, 	10, 	0},
+	{"anim-256-noise-f10", 	256, 	256, 	128, 	BENCH_CONTENT_NOISE, 	0, 	10, 	0},
+	{"anim-128-disp-f24", 	128, 	128, 	16, 	BENCH_CONTENT_FLAT, 	0, 	24, 	1},
+	{"anim-96-nz-disp-f12", 	96, 	96, 	64, 	BENCH_CONTENT_NOISE, 	0, 	12, 	1},
+	{"anim-120-il-disp-f9", 	120, 	120, 	32, 	BENCH_CONTENT_FLAT, 	1, 	9, 	1},
+	{"flat-4096-c256", 		4096, 	4096, 	256, 	BENCH_CONTENT_FLAT, 	0, 	1, 	0},
+	{"noise-4096-c256", 	4096, 	4096, 	256, 	BENCH_CONTENT_NOISE, 	0, 	1, 	0},
+	{"flat-8192-c256", 		8192, 	8192, 	256, 	BENCH_CONTENT_FLAT, 	0, 	1, 	0},
+	{"noise-8192-c32", 		8192, 	8192, 	32, 	BENCH_CONTENT_NOISE, 	0, 	1, 	0}
+};
+
+/**
+ * Function return monotonic time in seconds
+ *
+ * @return time in seconds
+ */
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Function return color table size bits (table has 2^(bits+1) entries)
+ *
+ * @param colors Number of used colors
+ * @return Color table size bits
+ */
+static int colorTableBits(int colors) {
+
+	int bits = 0;
+	while ((2 << bits) < colors)
+		bits++;
+
+	return bits;
+}
+
+/**
+ * Function return frame rectangle, frames of composite files after the first one
+ * cover only part of logical screen
+ *
+ * @param spec Corpus file description
+ * @param frame Frame number
+ * @return Frame rectangle
+ */
+static Rect getFrameRect(const tBENCHSPEC *spec, int frame) {
+
+	int width = spec->width;
+	int height = spec->height;
+
+	if (!spec->composite || frame == 0)
+		return Rect(0, 0, width, height);
+
+	int frameWidth = width / 2 + (frame * 13) % (width / 3);
+	int frameHeight = height / 2 + (frame * 7) % (height / 3);
+
+	return Rect((frame * 29) % (width - frameWidth + 1), (frame * 17) % (height - frameHeight + 1), frameWidth, frameHeight);
+}
+
+/**
+ * Function return disposal method of frame, composite files cycle through keep,
+ * restore to background and restore to previous
+ *
+ * @param spec Corpus file description
+ * @param frame Frame number
+ * @return Disposal method
+ */
+static int getFrameDisposal(const tBENCHSPEC *spec, int frame) {
+	return spec->composite ? frame % 3 + DISPOSAL_KEEP : DISPOSAL_KEEP;
+}
+
+/**
+ * Function return transparent color index of frame, frames of composite files after
+ * the first one use the last color as transparent
+ *
+ * @param spec Corpus file description
+ * @param frame Frame number
+ * @return Transparent color index, NO_TRANSPARENT_COLOR when frame is opaque
+ */
+static int getFrameTransparentIndex(const tBENCHSPEC *spec, int frame) {
+	return spec->composite && frame > 0 ? spec->colors - 1 : NO_TRANSPARENT_COLOR;
+}
+
+/**
+ * Function fill color indexes of one frame, content depends only on spec and frame
+ *
+ * @param spec Corpus file description
+ * @param frame Frame number
+ * @param indices Output color indexes (frame width x height)
+ */
+static void fillFrame(const tBENCHSPEC *spec, int frame, u_int8_t *indices) {
+
+	Rect rect = getFrameRect(spec, frame);
+	u_int32_t width = rect.width;
+	u_int32_t height = rect.height;
+	u_int32_t block = spec->width / 16 > 4 ? spec->width / 16 : 4;
+	u_int32_t state = 2463534242u + frame * 2654435761u;
+	int transparentIndex = getFrameTransparentIndex(spec, frame);
+
+	for (u_int32_t y = 0; y < height; y++) {
+		for (u_int32_t x = 0; x < width; x++) {
+			if (spec->content == BENCH_CONTENT_FLAT)
+				indices[y * width + x] = (u_int8_t)(((x + frame * 3) / block + (y / block) * 7) % spec->colors);
+			else {
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+				indices[y * width + x] = (u_int8_t)((state >> 8) % spec->colors);
+			}
+
+			// Diagonal stripes of transparent pixels show previous canvas
+			if (transparentIndex != NO_TRANSPARENT_COLOR && (x / 3 + y / 5 + frame) % 4 == 0)
+				indices[y * width + x] = (u_int8_t)transparentIndex;
+		}
+	}
+}
+
+/**
+ * Function append LZW code to bit packer
+ *
+ * @param lzw Pointer to encoder state
+ * @param code Code
+ * @param codeSize Code size in bits
+ */
+static void putCode(tBENCHLZW *lzw, u_int32_t code, int codeSize) {
+
+	lzw->bits |= code << lzw->bitCount;
+	lzw->bitCount += codeSize;
+
+	while (lzw->bitCount >= 8) {
+		lzw->data.push_back((u_int8_t)lzw->bits);
+		lzw->bits >>= 8;
+		lzw->bitCount -= 8;
+	}
+}
+
+/**
+ * Function write LZW compressed image data as data sub blocks
+ *
+ * @param file Output file
+ * @param indices Color indexes in order of image data
+ * @param count Number of pixels
+ * @param minCodeSize LZW minimum code size
+ */
+static void writeLzwData(FILE *file, const u_int8_t *indices, u_int32_t count, int minCodeSize) {
+
+	static tBENCHLZW lzw;
+	u_int32_t clearCode = 1 << minCodeSize;
+	u_int32_t nextCode = clearCode + 2;
+	int codeSize = minCodeSize + 1;
+	u_int32_t prefix = indices[0];
+
+	lzw.data.clear();
+	lzw.bits = 0;
+	lzw.bitCount = 0;
+	memset(lzw.keys, 0xFF, sizeof(lzw.keys));
+	putCode(&lzw, clearCode, codeSize);
+
+	for (u_int32_t i = 1; i < count; i++) {
+		u_int32_t key = (prefix << 8) | indices[i];
+		u_int32_t slot = (key * 2654435761u) >> 19;
+
+		while (lzw.keys[slot] != BENCH_LZW_EMPTY && lzw.keys[slot] != key)
+			slot = (slot + 1) & (BENCH_LZW_HASH_SIZE - 1);
+
+		if (lzw.keys[slot] == key) {
+			prefix = lzw.codes[slot];
+			continue;
+		}
+
+		putCode(&lzw, prefix, codeSize);
+		if (nextCode >= (1u << codeSize) && codeSize < GIF_MAX_CODE_WORD_LENGTH_IN_BITS)
+			codeSize++;
+
+		// Full dictionary is restarted by clear code
+		if (nextCode >= BENCH_LZW_MAX_CODE) {
+			putCode(&lzw, clearCode, codeSize);
+			memset(lzw.keys, 0xFF, sizeof(lzw.keys));
+			nextCode = clearCode + 2;
+			codeSize = minCodeSize + 1;
+		}
+		else {
+			lzw.keys[slot] = key;
+			lzw.codes[slot] = (u_int16_t)nextCode++;
+		}
+		prefix = indices[i];
+	}
+
+	putCode(&lzw, prefix, codeSize);
+	if (nextCode >= (1u << codeSize) && codeSize < GIF_MAX_CODE_WORD_LENGTH_IN_BITS)
+		codeSize++;
+	putCode(&lzw, clearCode + 1, codeSize);
+	if (lzw.bitCount > 0)
+		lzw.data.push_back((u_int8_t)lzw.bits);
+
+	fputc(minCodeSize, file);
+	for (size_t i = 0; i < lzw.data.size(); i += 255) {
+		size_t length = lzw.data.size() - i < 255 ? lzw.data.size() - i : 255;
+		fputc((int)length, file);
+		fwrite(&lzw.data[i], 1, length, file);
+	}
+	fputc(0, file);
+}
+
+/**
+ * Function write little endian 16 bit value
+ *
+ * @param file Output file
+ * @param value Value
+ */
+static void putWord(FILE *file, u_int32_t value) {
+	fputc(value & 0xFF, file);
+	fputc((value >> 8) & 0xFF, file);
+}
+
+/**
+ * Function generate corpus file
+ *
+ * @param spec Corpus file description
+ * @param filename Output file name
+ * @return 0 on success, 1 on failure
+ */
+static int generateGif(const tBENCHSPEC *spec, const char *filename) {
+
+	int bits = colorTableBits(spec->colors);
+	int minCodeSize = bits + 1 < GIF_MIN_LZW_SIZE ? GIF_MIN_LZW_SIZE : bits + 1;
+	u_int32_t pixels = spec->width * spec->height;
+	std::vector<u_int8_t> indices(pixels);
+	std::vector<u_int8_t> ordered(pixels);
+
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL)
+		return EXIT_FAILURE;
+
+	// Header, logical screen and global color table
+	fwrite("GIF89a", 1, 6, file);
+	putWord(file, spec->width);
+	putWord(file, spec->height);
+	fputc(0x80 | (bits << 4) | bits, file);
+	fputc(0, file);
+	fputc(0, file);
+	for (int i = 0; i < (2 << bits); i++) {
+		fputc((i * 67) & 0xFF, file);
+		fputc((i * 151 + 13) & 0xFF, file);
+		fputc((i * 31 + 101) & 0xFF, file);
+	}
+
+	// Endless loop of animation
+	if (spec->frames > 1) {
+		fwrite("\x21\xFF\x0BNETSCAPE2.0\x03\x01\x00\x00\x00", 1, 19, file);
+	}
+
+	for (int frame = 0; frame < spec->frames; frame++) {
+
+		Rect rect = getFrameRect(spec, frame);
+		u_int32_t width = rect.width;
+		u_int32_t height = rect.height;
+		int transparentIndex = getFrameTransparentIndex(spec, frame);
+
+		// Graphic control - 40 ms delay, disposal and transparent color
+		if (spec->frames > 1) {
+			fwrite("\x21\xF9\x04", 1, 3, file);
+			fputc((getFrameDisposal(spec, frame) << 2) | (transparentIndex != NO_TRANSPARENT_COLOR), file);
+			putWord(file, 4);
+			fputc(transparentIndex != NO_TRANSPARENT_COLOR ? transparentIndex : 0, file);
+			fputc(0, file);
+		}
+
+		fputc(IMAGE_DESCRIPTOR_INTRODUCER, file);
+		putWord(file, rect.x);
+		putWord(file, rect.y);
+		putWord(file, width);
+		putWord(file, height);
+		fputc(spec->interlaced ? 0x40 : 0, file);
+
+		fillFrame(spec, frame, &indices[0]);
+
+		// Interlaced rows are stored in four passes
+		if (spec->interlaced) {
+			static const u_int32_t start[GIF_INTERLACE_PASSES] = {0, 4, 2, 1};
+			static const u_int32_t step[GIF_INTERLACE_PASSES] = {8, 8, 4, 2};
+			u_int32_t row = 0;
+
+			for (int pass = 0; pass < GIF_INTERLACE_PASSES; pass++)
+				for (u_int32_t y = start[pass]; y < height; y += step[pass])
+					memcpy(&ordered[width * row++], &indices[width * y], width);
+			writeLzwData(file, &ordered[0], width * height, minCodeSize);
+		}
+		else
+			writeLzwData(file, &indices[0], width * height, minCodeSize);
+	}
+
+	fputc(GIF_END_OF_FILE, file);
+	return fclose(file) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/**
+ * Function read whole file into memory
+ *
+ * @param filename Input file name
+ * @param data Output file data
+ * @return 0 on success, 1 on failure
+ */
+static int readFile(const char *filename, std::vector<u_int8_t> &data) {
+
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL)
+		return EXIT_FAILURE;
+
+	data.resize(getFileSize(file));
+	size_t size = data.empty() ? 0 : fread(&data[0], 1, data.size(), file);
+	fclose(file);
+
+	return size == data.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Function decode all frames of indexed GIF into color index planes
+ *
+ * @param stream Pointer to input stream
+ * @param index Pointer to GIF index
+ * @param reader Pointer to GIF reader
+ * @param planes Output index planes
+ * @param colorTable Output color table (frames share global color table)
+ * @return 0 on success, 1 on failure
+ */
+static int decodeFrames(const tGIFSTREAM *stream, const tGIFINDEX *index, tGIFREADER *reader, std::vector<Mat> &planes, tRGB colorTable []) {
+
+	for (u_int32_t frame = 0; frame < index->frameCount; frame++)
+		if (decodeGifIndexFrame(stream, index, frame, reader, planes[frame], colorTable, NULL))
+			return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function check decoded index planes against generated content
+ *
+ * @param spec Corpus file description
+ * @param planes Decoded index planes
+ * @return 0 on success, 1 on failure
+ */
+static int checkFrames(const tBENCHSPEC *spec, const std::vector<Mat> &planes) {
+
+	std::vector<u_int8_t> indices(spec->width * spec->height);
+
+	if ((int)planes.size() != spec->frames)
+		return EXIT_FAILURE;
+
+	for (int frame = 0; frame < spec->frames; frame++) {
+		Rect rect = getFrameRect(spec, frame);
+
+		if (planes[frame].rows != rect.height || planes[frame].cols != rect.width)
+			return EXIT_FAILURE;
+
+		fillFrame(spec, frame, &indices[0]);
+		for (int y = 0; y < rect.height; y++)
+			if (memcmp(planes[frame].ptr<u_int8_t>(y), &indices[y * rect.width], rect.width))
+				return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function draw frame into reference canvas, transparent pixels keep canvas
+ *
+ * @param spec Corpus file description
+ * @param frame Frame number
+ * @param indices Buffer for frame color indexes
+ * @param canvas Reference canvas (BGR or BGRA)
+ */
+static void drawReferenceFrame(const tBENCHSPEC *spec, int frame, u_int8_t *indices, Mat &canvas) {
+
+	Rect rect = getFrameRect(spec, frame);
+	int transparentIndex = getFrameTransparentIndex(spec, frame);
+	int channels = canvas.channels();
+
+	fillFrame(spec, frame, indices);
+	for (int y = 0; y < rect.height; y++) {
+		u_int8_t *pixel = canvas.ptr<u_int8_t>(rect.y + y) + rect.x * channels;
+
+		for (int x = 0; x < rect.width; x++, pixel += channels) {
+			int color = indices[y * rect.width + x];
+
+			if (color == transparentIndex)
+				continue;
+			pixel[0] = (u_int8_t)(color * 31 + 101);
+			pixel[1] = (u_int8_t)(color * 151 + 13);
+			pixel[2] = (u_int8_t)(color * 67);
+			if (channels == 4)
+				pixel[3] = 255;
+		}
+	}
+}
+
+/**
+ * Function check canvases composited by frame reader against reference compositing
+ * of generated content (disposal methods, frame rectangles and transparency)
+ *
+ * @param spec Corpus file description
+ * @param data GIF data
+ * @return 0 on success, 1 on failure
+ */
+static int checkFrameReader(const tBENCHSPEC *spec, const std::vector<u_int8_t> &data) {
+
+	std::vector<u_int8_t> indices(spec->width * spec->height);
+	tGIFFRAMEREADER frames;
+	tGIFFRAME frame;
+	int transparent = 0;
+	int result = EXIT_SUCCESS;
+	int count = 0;
+
+	for (int i = 0; i < spec->frames; i++)
+		transparent |= getFrameTransparentIndex(spec, i) != NO_TRANSPARENT_COLOR;
+
+	Mat canvas(spec->height, spec->width, transparent ? CV_8UC4 : CV_8UC3, Scalar(255,255,255,0));
+	Mat backup;
+
+	try {
+		initGifFrames(&data[0], data.size(), &frames, NULL);
+	}
+	catch (const char *e) {
+		return EXIT_FAILURE;
+	}
+
+	try {
+		for (; result == EXIT_SUCCESS && readGifFrame(&frames, &frame); count++) {
+
+			// Disposal of previous frame
+			if (count > 0) {
+				Rect previous = getFrameRect(spec, count - 1);
+				int disposal = getFrameDisposal(spec, count - 1);
+
+				if (disposal == DISPOSAL_BACKGROUND)
+					canvas(previous).setTo(Scalar(255,255,255,0));
+				else if (disposal == DISPOSAL_PREVIOUS)
+					backup(previous).copyTo(canvas(previous));
+			}
+
+			if (count >= spec->frames) {
+				result = EXIT_FAILURE;
+				break;
+			}
+
+			if (getFrameDisposal(spec, count) == DISPOSAL_PREVIOUS)
+				canvas.copyTo(backup);
+			drawReferenceFrame(spec, count, &indices[0], canvas);
+
+			if (frame.index != count || frame.image.type() != canvas.type() || frame.image.size() != canvas.size())
+				result = EXIT_FAILURE;
+			for (int y = 0; y < canvas.rows && result == EXIT_SUCCESS; y++)
+				if (memcmp(frame.image.ptr<u_int8_t>(y), canvas.ptr<u_int8_t>(y), canvas.cols * canvas.elemSize()))
+					result = EXIT_FAILURE;
+		}
+	}
+	catch (const char *e) {
+		result = EXIT_FAILURE;
+	}
+
+	closeGifFrames(&frames);
+	return result || count != spec->frames;
+}
+
+/**
+ * Function check that saved index loads back equal, matches input and decodes same
+ * planes, corrupted copy of loaded index has to be rejected
+ *
+ * @param filename Corpus file name, index is saved next to it
+ * @param stream Pointer to input stream
+ * @param index Pointer to built index
+ * @param reader Pointer to GIF reader
+ * @param planes Output index planes
+ * @param colorTable Output color table
+ * @return 0 on success, 1 on failure
+ */
+static int checkIndexFile(const char *filename, const tGIFSTREAM *stream, const tGIFINDEX *index, tGIFREADER *reader, std::vector<Mat> &planes, tRGB colorTable []) {
+
+	std::string indexFile = std::string(filename) + ".idx";
+	tGIFINDEX loaded;
+	int result = EXIT_SUCCESS;
+
+	initGifIndex(&loaded);
+	if (saveGifIndex(index, indexFile.c_str()) || loadGifIndex(indexFile.c_str(), &loaded))
+		result = EXIT_FAILURE;
+	unlink(indexFile.c_str());
+
+	if (result == EXIT_SUCCESS && (checkGifIndex(&loaded, stream) || loaded.frameCount != index->frameCount ||
+		loaded.complete != index->complete || loaded.loopCount != index->loopCount))
+		result = EXIT_FAILURE;
+
+	for (u_int32_t i = 0; i < loaded.frameCount && result == EXIT_SUCCESS; i++) {
+		const tGIFINDEXFRAME *a = &index->frames[i];
+		const tGIFINDEXFRAME *b = &loaded.frames[i];
+		if (a->dataOffset != b->dataOffset || a->dataLength != b->dataLength ||
+			a->control.delayTime != b->control.delayTime || a->control.disposalMethod != b->control.disposalMethod ||
+			a->control.transparentColorFlag != b->control.transparentColorFlag)
+			result = EXIT_FAILURE;
+	}
+
+	if (result == EXIT_SUCCESS && decodeFrames(stream, &loaded, reader, planes, colorTable))
+		result = EXIT_FAILURE;
+
+	// Offsets out of input and oversized color table are rejected
+	if (result == EXIT_SUCCESS && loaded.frameCount > 0) {
+		tGIFINDEXFRAME frame = loaded.frames[0];
+		loaded.frames[0].dataLength = ~(u_int64_t)0;
+		result |= checkGifIndex(&loaded, stream) == EXIT_SUCCESS;
+		loaded.frames[0] = frame;
+		loaded.frames[0].descriptorOffset = stream->size;
+		result |= checkGifIndex(&loaded, stream) == EXIT_SUCCESS;
+		loaded.frames[0] = frame;
+		loaded.frames[0].colorTableSize = 512;
+		result |= checkGifIndex(&loaded, stream) == EXIT_SUCCESS;
+	}
+
+	freeGifIndex(&loaded);
+	return result;
+}
+
+/**
+ * Function read all frames of animation by frame reader
+ *
+ * @param data GIF data
+ * @param options Pointer to decoder options, NULL for sequential reader
+ * @return Number of frames, -1 on failure
+ */
+static int readFrames(const std::vector<u_int8_t> &data, const tGIFDECODE_OPTIONS *options) {
+
+	tGIFFRAMEREADER frames;
+	tGIFFRAME frame;
+	int count = 0;
+
+	try {
+		initGifFrames(&data[0], data.size(), &frames, options);
+	}
+	catch (const char *e) {
+		return -1;
+	}
+
+	try {
+		while (readGifFrame(&frames, &frame))
+			count++;
+	}
+	catch (const char *e) {
+		count = -1;
+	}
+
+	closeGifFrames(&frames);
+	return count;
+}
+
+/**
+ * Function check that sequential and parallel frame readers composite same canvases,
+ * both readers are run side by side
+ *
+ * @param data GIF data
+ * @param options Pointer to decoder options of parallel reader
+ * @return 0 on success, 1 on failure
+ */
+static int compareFrameReaders(const std::vector<u_int8_t> &data, const tGIFDECODE_OPTIONS *options) {
+
+	tGIFFRAMEREADER sequential, parallel;
+	tGIFFRAME a, b;
+	int result = EXIT_SUCCESS;
+
+	try {
+		initGifFrames(&data[0], data.size(), &sequential, NULL);
+	}
+	catch (const char *e) {
+		return EXIT_FAILURE;
+	}
+	try {
+		initGifFrames(&data[0], data.size(), &parallel, options);
+	}
+	catch (const char *e) {
+		closeGifFrames(&sequential);
+		return EXIT_FAILURE;
+	}
+
+	try {
+		while (result == EXIT_SUCCESS) {
+			int readA = readGifFrame(&sequential, &a);
+			int readB = readGifFrame(&parallel, &b);
+
+			if (readA != readB) {
+				result = EXIT_FAILURE;
+				break;
+			}
+			if (!readA)
+				break;
+
+			if (a.index != b.index || a.delayTime != b.delayTime || a.disposalMethod != b.disposalMethod ||
+				a.transparentIndex != b.transparentIndex || a.left != b.left || a.top != b.top ||
+				a.width != b.width || a.height != b.height ||
+				a.image.type() != b.image.type() || a.image.size() != b.image.size())
+				result = EXIT_FAILURE;
+			for (int y = 0; y < a.image.rows && result == EXIT_SUCCESS; y++)
+				if (memcmp(a.image.ptr<u_int8_t>(y), b.image.ptr<u_int8_t>(y), a.image.cols * a.image.elemSize()))
+					result = EXIT_FAILURE;
+		}
+	}
+	catch (const char *e) {
+		result = EXIT_FAILURE;
+	}
+
+	closeGifFrames(&sequential);
+	closeGifFrames(&parallel);
+	return result;
+}
+
+/**
+ * Function time frame reader of animation sequential and with thread pool, best run
+ * of each mode is used
+ *
+ * @param spec Corpus file description
+ * @param data GIF data
+ * @param threads Number of pool threads of parallel reader
+ * @param sequential Output best time of sequential reader
+ * @param parallel Output best time of parallel reader
+ * @return 0 on success, 1 on failure (frame count or canvases differ)
+ */
+static int benchFrameReader(const tBENCHSPEC *spec, const std::vector<u_int8_t> &data, int threads, double *sequential, double *parallel) {
+
+	tGIFDECODE_OPTIONS options;
+
+	initDecodeOptions(&options);
+	options.threads = threads;
+
+	if (compareFrameReaders(data, &options))
+		return EXIT_FAILURE;
+
+	for (int mode = 0; mode < 2; mode++) {
+		double *best = mode ? parallel : sequential;
+		double begin = now();
+
+		for (int run = 0; run < BENCH_MAX_RUNS && (run == 0 || now() - begin < BENCH_MIN_TIME); run++) {
+			double start = now();
+			if (readFrames(data, mode ? &options : NULL) != spec->frames)
+				return EXIT_FAILURE;
+			double time = now() - start;
+			if (run == 0 || time < *best)
+				*best = time;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function time GIFencoder phases (histogram and quantization, LZW, write) and whole
+ * encoding, best run of each is used
+ *
+ * @param filename Corpus file name, output is written next to it and removed
+ * @param bitMap Encoded image
+ * @param best Output best phase times
+ * @param encode Output best time of whole encoding
+ * @param encodedSize Output size of encoded file in MB
+ */
+static void benchEncoder(const char *filename, const Mat &bitMap, EncoderTimes *best, double *encode, double *encodedSize) {
+
+	std::string output = std::string(filename) + ".enc.gif";
+	double begin = now();
+
+	for (int run = 0; run < BENCH_MAX_RUNS && (run == 0 || now() - begin < BENCH_MIN_TIME); run++) {
+		double start = now();
+		EncoderTimes times;
+		{
+			GIFencoder encoder(output, bitMap);
+			times = encoder.getTimes();
+		}
+		double time = now() - start;
+
+		if (run == 0 || time < *encode)
+			*encode = time;
+		if (run == 0 || times.quantize < best->quantize)
+			best->quantize = times.quantize;
+		if (run == 0 || times.lzw < best->lzw)
+			best->lzw = times.lzw;
+		if (run == 0 || times.write < best->write)
+			best->write = times.write;
+	}
+
+	struct stat info;
+	if (stat(output.c_str(), &info) == 0)
+		*encodedSize = info.st_size / 1e6;
+	unlink(output.c_str());
+}
+
+/**
+ * Function run one corpus file through all measured phases and print result row
+ *
+ * @param spec Corpus file description
+ * @param filename Corpus file name
+ * @param encodeMaxPixels Largest image which is encoded
+ * @param threads Number of pool threads of parallel frame reader
+ * @return 0 on success, 1 on failure
+ */
+static int benchGif(const tBENCHSPEC *spec, const char *filename, u_int32_t encodeMaxPixels, int threads) {
+
+	std::vector<u_int8_t> data;
+	std::vector<Mat> planes(spec->frames);
+	tRGB colorTable[NUMBER_OF_COLORS];
+	tGIFSTREAM stream;
+	tGIFINDEX index;
+	tGIFREADER reader;
+	tGIFCONTEXT context;
+	tGIFDECODE_OPTIONS options;
+	tGIFIMAGE image;
+	Mat bitMap;
+	double parse = 0, lzw = 0, expand = 0, decode = 0, reused = 0, sequential = 0, parallel = 0, encode = 0;
+	double encodedSize = 0;
+	EncoderTimes encoderTimes = {0, 0, 0};
+	u_int64_t allocations = 0;
+	int check = EXIT_SUCCESS;
+
+	if (readFile(filename, data) || initGifReader(&reader))
+		return EXIT_FAILURE;
+	if (initGifContext(&context)) {
+		freeGifReader(&reader);
+		return EXIT_FAILURE;
+	}
+	initGifStream(&stream, &data[0], data.size());
+	initGifIndex(&index);
+	initDecodeOptions(&options);
+
+	double megaBytes = data.size() / 1e6;
+	double megaPixels = (double)spec->width * spec->height * spec->frames / 1e6;
+
+	// Each phase is run until minimal time elapses, best run is used
+	try {
+		double begin = now();
+		for (int run = 0; run < BENCH_MAX_RUNS && (run == 0 || now() - begin < BENCH_MIN_TIME); run++) {
+			double start = now();
+
+			// Parse - block structure of whole file
+			freeGifIndex(&index);
+			initGifIndex(&index);
+			if (buildGifIndex(&stream, &index)) {
+				check = EXIT_FAILURE;
+				break;
+			}
+			double time = now() - start;
+			if (run == 0 || time < parse)
+				parse = time;
+
+			// LZW - image data into index planes
+			double lzwStart = now();
+			if (index.frameCount != planes.size() || decodeFrames(&stream, &index, &reader, planes, colorTable)) {
+				check = EXIT_FAILURE;
+				break;
+			}
+			time = now() - lzwStart;
+			if (run == 0 || time < lzw)
+				lzw = time;
+
+			// Pixel expansion - index planes into BGR bit maps
+			double expandStart = now();
+			for (u_int32_t frame = 0; frame < index.frameCount; frame++)
+				expandIndexPlane(planes[frame], colorTable, bitMap);
+			time = now() - expandStart;
+			if (run == 0 || time < expand)
+				expand = time;
+
+			// Whole decoder through gif2bmp
+			double decodeStart = now();
+			bitMap = loadGif(&data[0], data.size());
+			time = now() - decodeStart;
+			if (run == 0 || time < decode)
+				decode = time;
+
+			// Whole decoder with reused context, same image needs no allocation after first run
+			double reusedStart = now();
+			stream.position = 0;
+			decodeGif(&context, &stream, &options, &image);
+			time = now() - reusedStart;
+			if (run == 0 || time < reused)
+				reused = time;
+			if (run == 0)
+				allocations = getGifContextAllocations(&context);
+		}
+	}
+	catch (const char *e) {
+		fprintf(stderr, "%s: %s\n", spec->name, e);
+		check = EXIT_FAILURE;
+	}
+
+	// Block structure or image data can not be decoded, there is nothing to measure
+	if (check) {
+		printf("%-20s %6s\n", spec->name, "FAIL");
+		freeGifIndex(&index);
+		freeGifReader(&reader);
+		freeGifContext(&context);
+		return check;
+	}
+
+	allocations = getGifContextAllocations(&context) - allocations;
+	check = checkFrames(spec, planes) || allocations != 0;
+
+	// Planes are decoded again through saved and loaded index
+	check = check || checkIndexFile(filename, &stream, &index, &reader, planes, colorTable) || checkFrames(spec, planes);
+
+	// Animation is composited by frame reader
+	if (spec->frames > 1) {
+		check = check || checkFrameReader(spec, data);
+		check = benchFrameReader(spec, data, threads, &sequential, &parallel) || check;
+	}
+
+	// Encoder input is loadGif bit map, frames of animation are drawn over each other
+	if ((u_int32_t)(spec->width * spec->height) <= encodeMaxPixels)
+		benchEncoder(filename, bitMap, &encoderTimes, &encode, &encodedSize);
+
+	double encodePixels = (double)spec->width * spec->height / 1e6;
+	printf("%-20s %6s %9.0f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9llu",
+		   spec->name, check ? "FAIL" : "ok", data.size() / 1024.0,
+		   megaBytes / parse, megaBytes / lzw, megaPixels / lzw, megaPixels / expand,
+		   megaBytes / decode, megaPixels / decode, megaBytes / reused, (unsigned long long)allocations);
+	if (sequential > 0 && parallel > 0)
+		printf(" %9.1f %9.1f", megaPixels / sequential, megaPixels / parallel);
+	else
+		printf(" %9s %9s", "-", "-");
+	if (encode > 0)
+		printf(" %9.1f %9.1f %9.1f %9.2f %9.2f\n", encodePixels / encoderTimes.quantize, encodePixels / encoderTimes.lzw,
+			   encodedSize / encoderTimes.write, encodedSize / encode, encodePixels / encode);
+	else
+		printf(" %9s %9s %9s %9s %9s\n", "-", "-", "-", "-", "-");
+
+	freeGifIndex(&index);
+	freeGifReader(&reader);
+	freeGifContext(&context);
+	return check;
+}
+
+/**
+ * Function print usage
+ *
+ * @param program Program name
+ */
+static void printUsage(const char *program) {
+	fprintf(stderr, "Usage: %s [-q] [-g] [-d corpus_dir] [-e max_encoded_pixels] [-t threads]\n"
+			"  -q  quick run, images up to 1024x1024 only\n"
+			"  -g  generate corpus only\n"
+			"  -t  pool threads of parallel frame reader\n", program);
+}
+
+int main(int argc, char *argv[]) {
+
+	const char *directory = BENCH_CORPUS_DIR;
+	u_int32_t encodeMaxPixels = BENCH_ENCODE_MAX_PIXELS;
+	int threads = BENCH_FRAME_THREADS;
+	int quick = 0;
+	int generateOnly = 0;
+	int result = EXIT_SUCCESS;
+	int option;
+
+	while ((option = getopt(argc, argv, "qgd:e:t:")) != -1) {
+		switch (option) {
+			case 'q':
+				quick = 1;
+				break;
+			case 'g':
+				generateOnly = 1;
+				break;
+			case 'd':
+				directory = optarg;
+				break;
+			case 'e':
+				encodeMaxPixels = (u_int32_t)strtoul(optarg, NULL, 10);
+				break;
+			case 't':
+				threads = atoi(optarg);
+				break;
+			default:
+				printUsage(argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+
+	mkdir(directory, 0755);
+
+	if (!generateOnly)
+		printf("%-20s %6s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s\n", "file", "check", "KB",
+			   "parse", "lzw", "lzw", "expand", "decode", "decode", "reused", "allocs", "frame-seq", "frame-thr",
+			   "enc-quant", "enc-lzw", "enc-write", "encode", "encode");
+	if (!generateOnly)
+		printf("%-20s %6s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s\n", "", "", "",
+			   "MB/s", "MB/s", "MP/s", "MP/s", "MB/s", "MP/s", "MB/s", "", "MP/s", "MP/s",
+			   "MP/s", "MP/s", "MB/s", "MB/s", "MP/s");
+
+	for (size_t i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+		const tBENCHSPEC *spec = &corpus[i];
+		std::string filename = std::string(directory) + "/" + spec->name + ".gif";
+		struct stat info;
+
+		if (quick && spec->width * spec->height > BENCH_QUICK_MAX_PIXELS)
+			continue;
+
+		// Corpus is deterministic, existing files are reused
+		if (stat(filename.c_str(), &info) != 0 && generateGif(spec, filename.c_str())) {
+			fprintf(stderr, "Can not generate %s.\n", filename.c_str());
+			return EXIT_FAILURE;
+		}
+
+		if (generateOnly)
+			continue;
+
+		try {
+			if (benchGif(spec, filename.c_str(), encodeMaxPixels, threads))
+				result = EXIT_FAILURE;
+		}
+		catch (const char *e) {
+			fprintf(stderr, "%s: %s\n", spec->name, e);
+			result = EXIT_FAILURE;
+		}
+	}
+
+	return result;
+}
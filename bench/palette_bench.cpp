@@ -0,0 +1,129 @@
+/*
+ *  File name: palette_bench.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Microbenchmark of color index to BGR expansion kernels, checks that
+ *               every kernel supported by CPU gives same output as scalar code and
+ *               reports pixels per second
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../palette.h"
+#include "../constant.h"
+
+#define BENCH_ROW_WIDTH 					4099
+#define BENCH_ROWS 							1024
+#define BENCH_REPEAT 						8
+
+/**
+ * Function return monotonic time in seconds
+ *
+ * @return time in seconds
+ */
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Function compare kernel output with scalar output for every row length
+ * up to 64 pixels and for whole benchmark rows
+ *
+ * @param kernel Kernel identifier
+ * @param paletteTable Expansion table
+ * @param indices Color indexes
+ * @return 0 on success, 1 on failure
+ */
+static int checkKernel(int kernel, const u_int32_t paletteTable [], const u_int8_t *indices) {
+
+	static u_int8_t expected[BENCH_ROW_WIDTH * 3 + 1];
+	static u_int8_t actual[BENCH_ROW_WIDTH * 3 + 1];
+
+	for (u_int32_t count = 0; count <= BENCH_ROW_WIDTH; count = (count < 64) ? count + 1 : count + 1009) {
+		for (u_int32_t offset = 0; offset < 3 && offset + count <= BENCH_ROW_WIDTH; offset++) {
+
+			// Guard byte behind row must stay untouched
+			memset(expected, 0xA5, sizeof(expected));
+			memset(actual, 0xA5, sizeof(actual));
+
+			expandPaletteRowKernel(PALETTE_KERNEL_SCALAR, paletteTable, indices + offset, expected, count);
+			expandPaletteRowKernel(kernel, paletteTable, indices + offset, actual, count);
+
+			if (memcmp(expected, actual, sizeof(expected))) {
+				fprintf(stderr, "Kernel %s differs from scalar code (%u pixels).\n", paletteKernelName(kernel), count);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int main() {
+
+	tRGB colorTable[NUMBER_OF_COLORS];
+	u_int32_t paletteTable[NUMBER_OF_COLORS];
+	int result = EXIT_SUCCESS;
+
+	u_int8_t *indices = (u_int8_t *)malloc(BENCH_ROW_WIDTH * BENCH_ROWS);
+	u_int8_t *bitMap = (u_int8_t *)malloc(BENCH_ROW_WIDTH * BENCH_ROWS * 3);
+	if (indices == NULL || bitMap == NULL) {
+		fprintf(stderr, "%s", "Can not allocate benchmark data.\n");
+		return EXIT_FAILURE;
+	}
+
+	// Deterministic xorshift palette and indexes
+	u_int32_t state = 2463534242u;
+	for (int i = 0; i < NUMBER_OF_COLORS; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		colorTable[i].red = (u_int8_t)state;
+		colorTable[i].green = (u_int8_t)(state >> 8);
+		colorTable[i].blue = (u_int8_t)(state >> 16);
+	}
+	for (u_int32_t i = 0; i < BENCH_ROW_WIDTH * BENCH_ROWS; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		indices[i] = (u_int8_t)state;
+	}
+	initPaletteTable(paletteTable, colorTable);
+
+	printf("%-10s %8s %14s\n", "kernel", "check", "Mpixels/s");
+
+	for (int kernel = PALETTE_KERNEL_SCALAR; kernel < PALETTE_KERNEL_COUNT; kernel++) {
+
+		if (!paletteKernelSupported(kernel)) {
+			printf("%-10s %8s\n", paletteKernelName(kernel), "n/a");
+			continue;
+		}
+
+		int check = checkKernel(kernel, paletteTable, indices);
+		if (check)
+			result = EXIT_FAILURE;
+
+		// Best of several runs over whole image
+		double best = 0;
+		for (int run = 0; run < BENCH_REPEAT; run++) {
+			double start = now();
+			for (int row = 0; row < BENCH_ROWS; row++)
+				expandPaletteRowKernel(kernel, paletteTable, indices + row * BENCH_ROW_WIDTH, bitMap + row * BENCH_ROW_WIDTH * 3, BENCH_ROW_WIDTH);
+			double elapsed = now() - start;
+
+			if (best == 0 || elapsed < best)
+				best = elapsed;
+		}
+
+		printf("%-10s %8s %14.1f%s\n", paletteKernelName(kernel), check ? "FAIL" : "ok",
+			   (double)BENCH_ROW_WIDTH * BENCH_ROWS / best / 1e6, kernel == getPaletteKernel() ? "   (selected)" : "");
+	}
+
+	free(indices);
+	free(bitMap);
+	return result;
+}
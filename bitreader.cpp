@@ -0,0 +1,139 @@
+/*
+ *  File name: bitreader.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Include functions for LZW code bit reader
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include "bitreader.h"
+#include "gifstream.h"
+#include "constant.h"
+
+/**
+ * Code mask for every code size, it is also max code value of the size
+ */
+const u_int32_t bitReaderCodeMask[GIF_MAX_CODE_WORD_LENGTH_IN_BITS + 1] = {
+	0, 1,
+	_2_BITS_MAX_CODE, _3_BITS_MAX_CODE, _4_BITS_MAX_CODE, _5_BITS_MAX_CODE,
+	_6_BITS_MAX_CODE, _7_BITS_MAX_CODE, _8_BITS_MAX_CODE, _9_BITS_MAX_CODE,
+	_10_BITS_MAX_CODE, _11_BITS_MAX_CODE, _12_BITS_MAX_CODE
+};
+
+/**
+ * Function init bit reader struct, buffer is allocated on first use
+ *
+ * @param bitReader Pointer to bit reader
+ */
+void initBitReader(tBITREADER *bitReader) {
+
+	bitReader->buffer = NULL;
+	bitReader->bufferSize = 0;
+	bitReader->bufferCapacity = 0;
+	bitReader->allocations = 0;
+	rewindBitReader(bitReader);
+}
+
+/**
+ * Function dealocate bit reader buffer
+ *
+ * @param bitReader Pointer to bit reader
+ */
+void freeBitReader(tBITREADER *bitReader) {
+
+	free(bitReader->buffer);
+	initBitReader(bitReader);
+}
+
+/**
+ * Function set reader to the beginning of joined data
+ *
+ * @param bitReader Pointer to bit reader
+ */
+void rewindBitReader(tBITREADER *bitReader) {
+
+	bitReader->position = 0;
+	bitReader->reservoir = 0;
+	bitReader->reservoirBits = 0;
+	bitReader->bitsConsumed = 0;
+}
+
+/**
+ * Function make sure buffer can hold requested size plus padding
+ *
+ * @param bitReader Pointer to bit reader
+ * @param size Requested data size in bytes
+ * @return 0 on success, 1 on failure
+ */
+static int reserveBitReader(tBITREADER *bitReader, u_int32_t size) {
+
+	if (size + BITREADER_PADDING <= bitReader->bufferCapacity)
+		return EXIT_SUCCESS;
+
+	u_int32_t capacity = bitReader->bufferCapacity ? bitReader->bufferCapacity : BITREADER_INIT_CAPACITY;
+	while (capacity < size + BITREADER_PADDING)
+		capacity *= 2;
+
+	u_int8_t *buffer = (u_int8_t *)realloc(bitReader->buffer, capacity);
+	if (buffer == NULL) {
+		fprintf(stderr, "%s", "Can not allocate data buffer.");
+		return EXIT_FAILURE;
+	}
+
+	bitReader->buffer = buffer;
+	bitReader->bufferCapacity = capacity;
+	bitReader->allocations++;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function read data sub block chain up to block terminator and join it into bit reader buffer
+ *
+ * @param stream Pointer to input stream
+ * @param bitReader Pointer to bit reader
+ * @return 0 on success, 1 on failure
+ */
+int joinSubBlocks(tGIFSTREAM *stream, tBITREADER *bitReader) {
+
+	u_int8_t Byte = 0;
+	const u_int8_t *subBlock;
+
+	bitReader->bufferSize = 0;
+
+	while (1) {
+
+		// Get sub block size
+		if (readByteFromStream(stream, &Byte) != READ_WRITE_OK) {
+			fprintf(stderr, "%s", "Incorrect gif file.");
+			return EXIT_FAILURE;
+		}
+
+		// Zero sub block size - end of data block
+		if (Byte == BLOCK_TERMINATOR)
+			break;
+
+		subBlock = takeFromStream(stream, Byte);
+		if (subBlock == NULL) {
+			fprintf(stderr, "%s", "Incorrect gif file.");
+			return EXIT_FAILURE;
+		}
+
+		if (reserveBitReader(bitReader, bitReader->bufferSize + Byte))
+			return EXIT_FAILURE;
+
+		// Append sub block data
+		memcpy(bitReader->buffer + bitReader->bufferSize, subBlock, Byte);
+		bitReader->bufferSize += Byte;
+	}
+
+	// Padding for word loads
+	if (reserveBitReader(bitReader, bitReader->bufferSize))
+		return EXIT_FAILURE;
+	memset(bitReader->buffer + bitReader->bufferSize, 0, BITREADER_PADDING);
+
+	rewindBitReader(bitReader);
+	return EXIT_SUCCESS;
+}
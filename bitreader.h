@@ -0,0 +1,76 @@
+/*
+ *  File name: bitreader.h
+ *  Created on: 17. 10. 2026
+ *  Type: Header file
+ *  Description: Include functions declarations for LZW code bit reader
+ */
+
+#ifndef BITREADER_H_
+#define BITREADER_H_
+
+#include <string.h>
+#include "constant.h"
+
+// Zero bytes behind joined data, reservoir refill may load them
+#define BITREADER_PADDING 					8
+#define BITREADER_INIT_CAPACITY 			4096
+
+extern const u_int32_t bitReaderCodeMask[GIF_MAX_CODE_WORD_LENGTH_IN_BITS + 1];
+
+void initBitReader(tBITREADER *bitReader);
+void freeBitReader(tBITREADER *bitReader);
+void rewindBitReader(tBITREADER *bitReader);
+int joinSubBlocks(tGIFSTREAM *stream, tBITREADER *bitReader);
+
+/**
+ * Function load next bytes of joined data into reservoir (LSB first)
+ *
+ * @param bitReader Pointer to bit reader
+ */
+static inline void refillBitReader(tBITREADER *bitReader) {
+
+	// Load whole word, data are padded so the load never leaves the buffer
+	if (bitReader->position < bitReader->bufferSize) {
+		u_int64_t word;
+		memcpy(&word, bitReader->buffer + bitReader->position, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		word = __builtin_bswap64(word);
+#endif
+		bitReader->reservoir |= word << bitReader->reservoirBits;
+		bitReader->position += (63 - bitReader->reservoirBits) >> 3;
+	}
+	bitReader->reservoirBits |= 56;
+}
+
+/**
+ * Function read one LZW code from reservoir
+ *
+ * @param bitReader Pointer to bit reader
+ * @param codeSize Current LZW code size in bits
+ * @return readed code
+ */
+static inline u_int32_t readCode(tBITREADER *bitReader, int codeSize) {
+
+	if (bitReader->reservoirBits < codeSize)
+		refillBitReader(bitReader);
+
+	u_int32_t code = (u_int32_t)bitReader->reservoir & bitReaderCodeMask[codeSize];
+	bitReader->reservoir >>= codeSize;
+	bitReader->reservoirBits -= codeSize;
+	bitReader->bitsConsumed += codeSize;
+
+	return code;
+}
+
+/**
+ * Function check if there is whole code left in joined data
+ *
+ * @param bitReader Pointer to bit reader
+ * @param codeSize Current LZW code size in bits
+ * @return 1 when data are exhausted, 0 otherwise
+ */
+static inline int bitReaderEmpty(tBITREADER *bitReader, int codeSize) {
+	return (bitReader->bitsConsumed + codeSize) > ((u_int64_t)bitReader->bufferSize * 8);
+}
+
+#endif /* BITREADER_H_ */
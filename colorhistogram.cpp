@@ -0,0 +1,211 @@
+#include "colorhistogram.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief Row stripe scanned by one pool task
+ */
+struct HistogramStripe
+{
+    const Mat *data;
+    int first_row;
+    int last_row;
+    ColorHistogram *histogram;
+    volatile int *stop;
+};
+
+/**
+ * @brief Returns slot of color key in hash table
+ * @param key Color + 1
+ * @return Slot index
+ */
+static inline unsigned int colorSlot(unsigned int key)
+{
+    return (unsigned int)(((unsigned long long)key * 0x9E3779B97F4A7C15ULL) >> (64 - COLOR_HISTOGRAM_HASH_BITS));
+}
+
+/**
+ * @brief Returns color code of pixel
+ * @param pixel Pointer to BGR pixel
+ * @return Color code (blue << 16 | green << 8 | red)
+ */
+static inline unsigned int pixelColor(const u_int8_t *pixel)
+{
+    return pixel[0] << 16 | pixel[1] << 8 | pixel[2];
+}
+
+/**
+ * @brief ColorHistogram constructor
+ */
+ColorHistogram::ColorHistogram()
+{
+    memset(this->keys, 0, sizeof(this->keys));
+    this->count = 0;
+}
+
+/**
+ * @brief Inserts color if it is not present yet
+ * @param color Color code
+ * @return False if histogram reached limit
+ */
+bool ColorHistogram::insert(unsigned int color)
+{
+    unsigned int slot = colorSlot(color + 1);
+
+    while (this->keys[slot] != 0)
+    {
+        if (this->keys[slot] == color + 1)
+            return true;
+        slot = (slot + 1) & (COLOR_HISTOGRAM_HASH_SIZE - 1);
+    }
+
+    this->keys[slot] = color + 1;
+    this->colors[this->count++] = color;
+
+    return this->count < COLOR_HISTOGRAM_LIMIT;
+}
+
+/**
+ * @brief Adds colors of image rows, scanning stops at limit
+ * @param data CV_8UC3 image
+ * @param first_row First row
+ * @param last_row Row after last one
+ * @param stop Flag set by other stripe that reached limit, NULL if not used
+ * @return False if histogram reached limit
+ */
+bool ColorHistogram::add(const Mat &data, int first_row, int last_row, const volatile int *stop)
+{
+    if (this->isFull())
+        return false;
+
+    for (int y = first_row; y < last_row; y++)
+    {
+        if (stop != NULL && *stop)
+            return false;
+
+        const u_int8_t *pixel = data.ptr<u_int8_t>(y);
+        const u_int8_t *end = pixel + 3 * data.cols;
+        unsigned int last_color = ~0u;
+
+        // Run of same color is inserted once
+        for (; pixel != end; pixel += 3)
+        {
+            unsigned int color = pixelColor(pixel);
+            if (color == last_color)
+                continue;
+
+            last_color = color;
+            if (!this->insert(color))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Adds colors of other histogram
+ * @param other Histogram of other rows
+ * @return False if histogram reached limit
+ */
+bool ColorHistogram::merge(const ColorHistogram &other)
+{
+    for (unsigned int i = 0; i < other.count; i++)
+    {
+        if (!this->insert(other.colors[i]))
+            return false;
+    }
+
+    return !this->isFull();
+}
+
+/**
+ * @brief Checks if histogram reached limit
+ * @return True if more than 256 colors were seen
+ */
+bool ColorHistogram::isFull() const
+{
+    return this->count >= COLOR_HISTOGRAM_LIMIT;
+}
+
+/**
+ * @brief Returns colors in ascending order
+ * @param sorted Output colors
+ */
+void ColorHistogram::getColors(vector<unsigned int> &sorted) const
+{
+    sorted.assign(this->colors, this->colors + this->count);
+    sort(sorted.begin(), sorted.end());
+}
+
+/**
+ * @brief Pool task, adds stripe colors to its histogram and stops other stripes at limit
+ * @param argument Pointer to HistogramStripe
+ */
+static void histogramStripeTask(void *argument)
+{
+    HistogramStripe *stripe = (HistogramStripe *)argument;
+
+    if (!stripe->histogram->add(*stripe->data, stripe->first_row, stripe->last_row, stripe->stop))
+        *stripe->stop = 1;
+}
+
+/**
+ * @brief Splits image into row stripes for pool tasks
+ * @param data CV_8UC3 image
+ * @param pool Thread pool, NULL or small image for one stripe
+ * @param stripes Output stripes
+ */
+static void splitStripes(const Mat &data, tTHREADPOOL *pool, vector<HistogramStripe> &stripes)
+{
+    int count = 1;
+
+    if (pool != NULL && (long long)data.rows * data.cols >= COLOR_HISTOGRAM_PARALLEL_PIXELS)
+        count = min(pool->threadCount * COLOR_HISTOGRAM_STRIPES_PER_THREAD,
+                    max(1, data.rows / COLOR_HISTOGRAM_MIN_STRIPE_ROWS));
+
+    stripes.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        stripes[i].data = &data;
+        stripes[i].first_row = (int)((long long)data.rows * i / count);
+        stripes[i].last_row = (int)((long long)data.rows * (i + 1) / count);
+        stripes[i].histogram = NULL;
+        stripes[i].stop = NULL;
+    }
+}
+
+/**
+ * @brief Collects distinct colors of image if there are at most 256 of them
+ * @param data CV_8UC3 image
+ * @param sorted Output colors in ascending order, empty if limit was reached
+ * @param pool Thread pool for row stripes, NULL to scan on calling thread
+ * @return False if image has more than 256 colors
+ */
+bool ColorHistogram::build(const Mat &data, vector<unsigned int> &sorted, tTHREADPOOL *pool)
+{
+    vector<HistogramStripe> stripes;
+    splitStripes(data, pool, stripes);
+
+    vector<ColorHistogram> histograms(stripes.size());
+    volatile int stop = 0;
+
+    for (size_t i = 0; i < stripes.size(); i++)
+    {
+        stripes[i].histogram = &histograms[i];
+        stripes[i].stop = &stop;
+    }
+
+    runTasks(pool, histogramStripeTask, &stripes[0], sizeof(HistogramStripe), stripes.size());
+
+    // Merges stripes into first one
+    bool fits = !stop;
+    for (size_t i = 1; fits && i < histograms.size(); i++)
+        fits = histograms[0].merge(histograms[i]);
+
+    sorted.clear();
+    if (fits)
+        histograms[0].getColors(sorted);
+
+    return fits;
+}
@@ -0,0 +1,48 @@
+#ifndef COLORHISTOGRAM_H
+#define COLORHISTOGRAM_H
+
+#include <cv.h>
+#include <vector>
+#include "threadpool.h"
+
+// Number of distinct colors after which histogram stops, palette needs quantisation
+#define COLOR_HISTOGRAM_LIMIT 257
+
+// Open addressing table of colors, four times the limit
+#define COLOR_HISTOGRAM_HASH_BITS 11
+#define COLOR_HISTOGRAM_HASH_SIZE (1 << COLOR_HISTOGRAM_HASH_BITS)
+
+// Smaller images are not split into stripes
+#define COLOR_HISTOGRAM_PARALLEL_PIXELS (1 << 18)
+#define COLOR_HISTOGRAM_STRIPES_PER_THREAD 4
+#define COLOR_HISTOGRAM_MIN_STRIPE_ROWS 16
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Set of distinct colors (blue << 16 | green << 8 | red) that stops at limit,
+ * used to build GIF encoder palette. Big image is scanned in row stripes in parallel
+ * and stripes are merged.
+ */
+class ColorHistogram
+{
+private:
+    /// Colors + 1, zero marks empty slot
+    unsigned int keys[COLOR_HISTOGRAM_HASH_SIZE];
+    unsigned int colors[COLOR_HISTOGRAM_LIMIT];
+    unsigned int count;
+
+    bool insert(unsigned int color);
+
+public:
+    ColorHistogram();
+    bool add(const Mat &data, int first_row, int last_row, const volatile int *stop = NULL);
+    bool merge(const ColorHistogram &other);
+    bool isFull() const;
+    void getColors(vector<unsigned int> &sorted) const;
+
+    static bool build(const Mat &data, vector<unsigned int> &sorted, tTHREADPOOL *pool = NULL);
+};
+
+#endif // COLORHISTOGRAM_H
@@ -12,6 +12,7 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <stddef.h>
 
 #define READ_WRITE_OK  						0
 #define READ_WRITE_ERR 						1
@@ -39,22 +40,6 @@
 #define BLOCK_TERMINATOR 					0x00
 #define GIF_END_OF_FILE 					0x3B
 
-#define _2_BIT_MASK  						0xC0000000
-#define _3_BIT_MASK  						0xE0000000
-#define _4_BIT_MASK  						0xF0000000
-#define _5_BIT_MASK  						0xF8000000
-#define _6_BIT_MASK  						0xFC000000
-#define _7_BIT_MASK  						0xFE000000
-#define _8_BIT_MASK  						0xFF000000
-#define _9_BIT_MASK  						0xFF800000
-#define _10_BIT_MASK 						0xFFC00000
-#define _11_BIT_MASK 						0xFFE00000
-#define _12_BIT_MASK 						0xFFF00000
-#define _13_BIT_MASK 						0xFFF80000
-#define NEW_SUBBLOCK 						0
-#define UNFINISHED_SUBBLOCK 				1
-#define FINISHING_SUBBLOCK 				    2
-
 #define _2_BITS_MAX_CODE 					3
 #define _3_BITS_MAX_CODE 					7
 #define _4_BITS_MAX_CODE 					15
@@ -69,6 +54,7 @@
 #define DICTIONARY_MAX_SIZE 				4097
 #define DICTIONARY_FULL		 				-1
 #define NUMBER_OF_COLORS		 			256
+#define GIF_MAX_IMAGE_WIDTH 				65536
 
 #define GIFMASK_LOCAL_COLOR_PALETTE    		0x80
 #define GIFMASK_LOCAL_COLOR_PALETTE_SIZE    0x07
@@ -79,10 +65,29 @@
 #define GIFMASK_COLOR_BITS_PER_PIXEL    	0x70
 #define GIFMASK_COLOR_PALETTE_SORT      	0x08
 #define GIFMASK_GLOBAL_COLOR_PALETTE_SIZE   0x07
+
+#define GIFMASK_DISPOSAL_METHOD    			0x1C
+#define GIFMASK_USER_INPUT    				0x02
+#define GIFMASK_TRANSPARENT_COLOR    		0x01
+
+#define DISPOSAL_NONE 						0
+#define DISPOSAL_KEEP 						1
+#define DISPOSAL_BACKGROUND 				2
+#define DISPOSAL_PREVIOUS 					3
+#define NO_TRANSPARENT_COLOR 				-1
 #define GIF_MAX_CODE_WORD_LENGTH_IN_BITS    12
+#define GIF_MIN_LZW_SIZE 					2
+#define GIF_MAX_LZW_SIZE 					8
 
 #define M_EXIT_FAILURE 						-1
 
+#define GIF_OUTPUT_BGR 						0
+#define GIF_OUTPUT_INDEX 					1
+#define GIF_OUTPUT_BGRA 					2
+#define GIF_OUTPUT_MODES 					3
+#define GIF_INTERLACE_PASSES 				4
+#define GIF_STREAM_READ_CHUNK 				65536
+
 /**
  * @brief GIF pixel structure
  */
@@ -103,52 +108,113 @@ typedef struct {
 } tBGR;
 
 /**
- * @brief Dictionary list item
- */
-typedef struct colorListItem {
-	int colorTableIndex;
-	struct colorListItem *nextColor;
-} tLIST_ITEM;
-
-/**
- * @brief Dictionary item
- */
-typedef struct colorsList {
-	tLIST_ITEM *first;
-	tLIST_ITEM *last;
-} tDIC_ITEM;
-
-/**
- * @brief Dictionary
+ * @brief Dictionary - flat code table, every code is stored as back reference (offset
+ * and length) into decoded output followed by suffix color index, prefix code is kept
+ * for decoding without whole decoded output
  */
 typedef struct {
-	tDIC_ITEM colors[DICTIONARY_MAX_SIZE];
+	u_int32_t offset[DICTIONARY_MAX_SIZE];
+	u_int16_t prefix[DICTIONARY_MAX_SIZE];
+	u_int8_t suffix[DICTIONARY_MAX_SIZE];
+	u_int8_t firstColor[DICTIONARY_MAX_SIZE];
+	u_int16_t length[DICTIONARY_MAX_SIZE];
 	int clearCode;
 	int endOfInformationCode;
 	u_int32_t previousCode;
+	u_int32_t previousOffset;
 	int firstEmptyCode;
 	int curMaxCode;
 } tDICTIONARY;
 
+/**
+ * @brief GIF input stream struct - memory mapped file, buffered pipe or caller provided byte span
+ */
+typedef struct{
+	const u_int8_t *data;
+	size_t size;
+	size_t position;
+	void *mapping;
+	size_t mappingSize;
+	u_int8_t *buffer;
+} tGIFSTREAM;
+
+/**
+ * @brief LZW code bit reader struct - joined data sub blocks and 64 bit reservoir
+ */
+typedef struct{
+	u_int8_t *buffer;
+	u_int32_t bufferSize;
+	u_int32_t bufferCapacity;
+	u_int32_t position;
+	u_int64_t reservoir;
+	int reservoirBits;
+	u_int64_t bitsConsumed;
+	u_int32_t allocations;
+} tBITREADER;
+
 /**
  * @brief GIF reader struct
  */
 typedef struct{
-	u_int8_t Byte1;
-	u_int8_t Byte2;
-	u_int8_t Byte3;
-	u_int8_t Byte1ValidFlag;
-	u_int8_t Byte2ValidFlag;
-	u_int8_t Byte3ValidFlag;
+	tBITREADER bitReader;
 	u_int32_t dataBlockSize;
-	int usedBitsFromByte1LastTime;
 	int lzwSize;
 	int initLzwSize;
-	u_int8_t BytesToReadInSubBlock;
 	int activeColorTableSize;
 	tRGB *activeColorTable;
+	u_int8_t *rowBuffer;
+	u_int8_t *indexBuffer;
+	u_int32_t indexBufferSize;
+	u_int32_t allocations;
 } tGIFREADER;
 
+/**
+ * @brief Scratch memory arena - blocks are taken by moving offset and released all at once,
+ * memory is kept for next image
+ */
+typedef struct{
+	u_int8_t *block;
+	size_t blockSize;
+	size_t used;
+	size_t taken;
+	u_int32_t allocations;
+} tGIFARENA;
+
+/**
+ * @brief Nearest neighbour mapping of logical screen area into smaller or cropped bit map
+ */
+typedef struct{
+	u_int32_t width;
+	u_int32_t height;
+	u_int32_t *columnMap;
+	u_int32_t *columnStart;
+	u_int32_t *rowStart;
+	u_int8_t *rowBuffer;
+	tGIFARENA *arena;
+} tBITMAPSCALE;
+
+/**
+ * @brief Caller provided receiver of decoded rows, rows are passed once in top to bottom order
+ */
+typedef struct{
+	void *context;
+	int outputMode;
+	int (*begin)(void *context, u_int32_t width, u_int32_t height, const tRGB *palette, int paletteSize);
+	int (*row)(void *context, u_int32_t y, const u_int8_t *pixels);
+	int (*end)(void *context);
+} tROWSINK;
+
+/**
+ * @brief Row output of bit map writer - single row bit map is passed to sink after each finished row
+ */
+typedef struct{
+	const tROWSINK *sink;
+	u_int32_t height;
+	u_int32_t nextRow;
+	const u_int8_t *background;
+	int status;
+} tROWOUTPUT;
+
 /**
  * @brief BMP writer struct
  */
@@ -159,6 +225,16 @@ typedef struct{
 	u_int16_t actualWidth;
 	u_int32_t actualX;
 	u_int32_t actualY;
+	int outputMode;
+	u_int8_t *rowBuffer;
+	u_int32_t paletteTable[NUMBER_OF_COLORS];
+	int transparentIndex;
+	u_int32_t writtenPixels;
+	int interlaced;
+	int interlacePass;
+	int passLimit;
+	const tBITMAPSCALE *scale;
+	tROWOUTPUT *rowOutput;
 } tBITMAPWRITER;
 
 /**
@@ -205,5 +281,73 @@ typedef struct{
 	u_int32_t sizeInPixels;
 } tIMAGE_DESCRIPTOR;
 
+/**
+ * @brief Graphic control extension struct
+ */
+typedef struct{
+	u_int8_t disposalMethod;
+	u_int8_t userInputFlag;
+	u_int8_t transparentColorFlag;
+	u_int16_t delayTime;
+	u_int8_t transparentColorIndex;
+} tGRAPHIC_CONTROL;
+
+/**
+ * @brief Image block record of GIF index
+ */
+typedef struct{
+	u_int64_t descriptorOffset;
+	u_int64_t colorTableOffset;
+	u_int64_t dataOffset;
+	u_int64_t dataLength;
+	u_int16_t left;
+	u_int16_t top;
+	u_int16_t width;
+	u_int16_t height;
+	u_int16_t colorTableSize;
+	u_int8_t localColorTable;
+	u_int8_t interlaced;
+	u_int8_t lzwSize;
+	tGRAPHIC_CONTROL control;
+} tGIFINDEXFRAME;
+
+/**
+ * @brief GIF index - block structure of GIF without image data
+ */
+typedef struct{
+	u_int64_t sourceSize;
+	u_int8_t screenDescriptor[LOGICAL_SCREEN_DESCRIPTOR_SIZE];
+	u_int16_t width;
+	u_int16_t height;
+	u_int8_t globalColorTable;
+	u_int16_t globalColorTableSize;
+	u_int64_t globalColorTableOffset;
+	u_int8_t backgroundColor;
+	u_int8_t pixelAspectRatio;
+	int loopCount;
+	int complete;
+	u_int32_t frameCount;
+	u_int32_t frameCapacity;
+	u_int32_t allocations;
+	tGIFINDEXFRAME *frames;
+} tGIFINDEX;
+
+/**
+ * @brief GIF decoder options struct
+ */
+typedef struct{
+	int outputMode;
+	int threads;
+	const tGIFINDEX *index;
+	int targetWidth;
+	int targetHeight;
+	double scaleX;
+	double scaleY;
+	int cropX;
+	int cropY;
+	int cropWidth;
+	int cropHeight;
+} tGIFDECODE_OPTIONS;
+
 
 #endif /* CONSTANT_H_ */
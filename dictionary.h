@@ -10,14 +10,123 @@
 #ifndef RGB_H_
 #define RGB_H_
 
+#include <stdio.h>
+#include <string.h>
 #include "constant.h"
 
-void freeDictionary (tDICTIONARY *dictionary);
 int reInitDictionary (tDICTIONARY *dictionary, tGIFREADER *reader);
 int initDictionary (tDICTIONARY *dictionary, tGIFREADER *reader);
-int codeInDictionary(tDICTIONARY *dictionary, u_int32_t *code);
-int copyLists(tDIC_ITEM *sourcelist, tDIC_ITEM *destlist);
-int listLength(tDIC_ITEM *list);
-tLIST_ITEM *newDicItem(int colorIndex);
+
+/**
+ * Look for code in dictionary
+ *
+ * @param dictionary Pointer to dictionary
+ * @param code Code to look for
+ * @return 0 on success, 1 on failure
+ */
+static inline int codeInDictionary(tDICTIONARY *dictionary, u_int32_t *code) {
+
+	// Check code range
+	if (*code >= DICTIONARY_MAX_SIZE) {
+		fprintf(stderr, "%s", "Can not create dictionary.");
+		return EXIT_FAILURE;
+	}
+
+	// Code in dictionary?
+	if (dictionary->length[*code] == 0)
+		return EXIT_FAILURE;
+	else
+		return EXIT_SUCCESS;
+}
+
+/**
+ * Add new dictionary record created from previous code string and color index, record
+ * refers to the previous code string in decoded output (dictionary->previousOffset)
+ * and to the previous code
+ *
+ * @param dictionary Pointer to dictionary
+ * @param prefixCode Code of the string prefix (CODE-1)
+ * @param colorIndex Color table index appended to prefix string (K)
+ */
+static inline void addDicItem(tDICTIONARY *dictionary, u_int32_t prefixCode, int colorIndex) {
+
+	// Dictionary is full - record is dropped until next CC
+	if (dictionary->firstEmptyCode == DICTIONARY_FULL)
+		return;
+
+	int code = dictionary->firstEmptyCode;
+
+	dictionary->offset[code] = dictionary->previousOffset;
+	dictionary->prefix[code] = (u_int16_t)prefixCode;
+	dictionary->suffix[code] = (u_int8_t)colorIndex;
+	dictionary->length[code] = dictionary->length[prefixCode] + 1;
+
+	// Empty prefix - record is single color
+	if (dictionary->length[prefixCode] == 0)
+		dictionary->firstColor[code] = (u_int8_t)colorIndex;
+	else
+		dictionary->firstColor[code] = dictionary->firstColor[prefixCode];
+
+	// Move to next empty record
+	dictionary->firstEmptyCode++;
+}
+
+/**
+ * Copy dictionary record string into decoded output. Prefix of the record was already
+ * decoded earlier in the same output, it is copied by one memcpy and suffix is appended.
+ *
+ * @param dictionary Pointer to dictionary
+ * @param code Code of the record
+ * @param output Decoded color indexes, has room for record string on position
+ * @param position Position of record string in output
+ * @return Number of colors in record (string length)
+ */
+static inline int copyDicItemString(tDICTIONARY *dictionary, u_int32_t code, u_int8_t *output, u_int32_t position) {
+
+	int length = dictionary->length[code];
+
+	// Code outside of dictionary (broken data) has empty string
+	if (length == 0)
+		return 0;
+
+	const u_int8_t *prefix = output + dictionary->offset[code];
+	u_int8_t *string = output + position;
+
+	// Short prefix is copied as one word - prefix ends before position and output
+	// has room behind position, so bytes behind the string are overwritten later
+	if (length <= 9) {
+		u_int64_t word;
+		memcpy(&word, prefix, sizeof(word));
+		memcpy(string, &word, sizeof(word));
+	}
+	else
+		memcpy(string, prefix, length - 1);
+
+	string[length - 1] = dictionary->suffix[code];
+
+	return length;
+}
+
+/**
+ * Unwind dictionary record string through prefix codes into output. Only output of
+ * the longest record is needed, earlier decoded output is not used.
+ *
+ * @param dictionary Pointer to dictionary
+ * @param code Code of the record
+ * @param output Output with room for record string
+ * @return Number of colors in record (string length)
+ */
+static inline int unwindDicItemString(tDICTIONARY *dictionary, u_int32_t code, u_int8_t *output) {
+
+	int length = dictionary->length[code];
+
+	// Roots end the chain, their length is 1
+	for (int i = length - 1; i >= 0; i--) {
+		output[i] = dictionary->suffix[code];
+		code = dictionary->prefix[code];
+	}
+
+	return length;
+}
 
 #endif /* RGB_H_ */
@@ -0,0 +1,388 @@
+#include "ditherer.h"
+#include <sched.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief State shared by dithering tasks
+ */
+struct DitherJob
+{
+    const ColorQuantizer *quantizer;
+    const Mat *image;
+    Mat *output;
+
+    /// Errors diffused to next row, ring of rows in flight, 16 times bigger
+    int *errors;
+    unsigned int rings;
+    unsigned int stride;
+
+    /// Number of finished pixels of every row
+    volatile int *progress;
+    volatile int next_row;
+
+    /// Ordered dithering offsets of matrix cells
+    const int *offsets;
+    unsigned int matrix_bits;
+};
+
+/**
+ * @brief Rows processed by one pool task, Floyd-Steinberg tasks take rows from job
+ */
+struct DitherStripe
+{
+    DitherJob *job;
+    unsigned int first;
+    unsigned int last;
+};
+
+/**
+ * @brief Blue noise threshold matrix built by void-and-cluster method
+ */
+struct BlueNoise
+{
+    unsigned int rank[DITHER_NOISE_SIZE * DITHER_NOISE_SIZE];
+
+    BlueNoise();
+};
+
+/**
+ * @brief Clamps value to color component range
+ * @param value Value
+ * @return Value in range 0 - 255
+ */
+static inline int clampComponent(int value)
+{
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+/**
+ * @brief Copies quantizer palette into component table
+ * @param quantizer Quantizer
+ * @param palette Output palette, blue, green and red of every color
+ */
+static void copyPalette(const ColorQuantizer *quantizer, u_int8_t palette[][3])
+{
+    for (unsigned int i = 0; i < quantizer->getColors(); i++)
+    {
+        unsigned int color = quantizer->getColor(i);
+        palette[i][0] = color >> 16;
+        palette[i][1] = color >> 8;
+        palette[i][2] = color;
+    }
+}
+
+/**
+ * @brief Adds or removes point of binary pattern and updates energy of all
+ * pixels by toroidal Gaussian filter
+ * @param energy Energy of pixels
+ * @param filter Filter value of every offset
+ * @param point Changed pixel
+ * @param sign 1 for added point, -1 for removed one
+ */
+static void updateEnergy(vector<double> &energy, const vector<double> &filter, unsigned int point, int sign)
+{
+    const unsigned int mask = DITHER_NOISE_SIZE - 1;
+    unsigned int px = point & mask;
+    unsigned int py = point >> DITHER_NOISE_BITS;
+
+    for (unsigned int i = 0; i < energy.size(); i++)
+    {
+        unsigned int dx = ((i & mask) - px) & mask;
+        unsigned int dy = ((i >> DITHER_NOISE_BITS) - py) & mask;
+        energy[i] += sign * filter[dy << DITHER_NOISE_BITS | dx];
+    }
+}
+
+/**
+ * @brief Finds point of pattern with highest energy (tightest cluster) or
+ * empty pixel with lowest energy (largest void), first one wins on equality
+ * @param pattern Binary pattern
+ * @param energy Energy of pixels
+ * @param cluster True for tightest cluster, false for largest void
+ * @return Pixel index
+ */
+static unsigned int findExtreme(const vector<bool> &pattern, const vector<double> &energy, bool cluster)
+{
+    unsigned int best = 0;
+    bool found = false;
+
+    for (unsigned int i = 0; i < energy.size(); i++)
+    {
+        if (pattern[i] != cluster)
+            continue;
+
+        if (!found || (cluster ? energy[i] > energy[best] : energy[i] < energy[best]))
+        {
+            best = i;
+            found = true;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief BlueNoise constructor, ranks pixels of matrix by void-and-cluster method
+ */
+BlueNoise::BlueNoise()
+{
+    const unsigned int size = DITHER_NOISE_SIZE * DITHER_NOISE_SIZE;
+    vector<double> filter(size);
+    vector<double> energy(size, 0);
+    vector<bool> pattern(size, false);
+
+    for (unsigned int i = 0; i < size; i++)
+    {
+        int dx = i & (DITHER_NOISE_SIZE - 1);
+        int dy = i >> DITHER_NOISE_BITS;
+        dx = min(dx, DITHER_NOISE_SIZE - dx);
+        dy = min(dy, DITHER_NOISE_SIZE - dy);
+        filter[i] = exp(-(dx * dx + dy * dy) / (2 * DITHER_NOISE_SIGMA * DITHER_NOISE_SIGMA));
+    }
+
+    // Initial pattern from fixed pseudo random sequence
+    unsigned int ones = 0;
+    unsigned int seed = 1;
+    while (ones < size * DITHER_NOISE_INITIAL_PERCENT / 100)
+    {
+        seed = seed * 1103515245 + 12345;
+        unsigned int point = (seed >> 8) % size;
+        if (pattern[point])
+            continue;
+
+        pattern[point] = true;
+        updateEnergy(energy, filter, point, 1);
+        ones++;
+    }
+
+    // Points are moved from tightest clusters to largest voids until pattern is uniform
+    for (unsigned int i = 0; i < size; i++)
+    {
+        unsigned int cluster = findExtreme(pattern, energy, true);
+        pattern[cluster] = false;
+        updateEnergy(energy, filter, cluster, -1);
+
+        unsigned int hole = findExtreme(pattern, energy, false);
+        pattern[hole] = true;
+        updateEnergy(energy, filter, hole, 1);
+
+        if (hole == cluster)
+            break;
+    }
+
+    // Points of pattern are ranked by removing tightest clusters
+    vector<bool> removed(pattern);
+    vector<double> removed_energy(energy);
+    for (unsigned int rank = ones; rank > 0; rank--)
+    {
+        unsigned int cluster = findExtreme(removed, removed_energy, true);
+        removed[cluster] = false;
+        updateEnergy(removed_energy, filter, cluster, -1);
+        this->rank[cluster] = rank - 1;
+    }
+
+    // Remaining pixels are ranked by filling largest voids
+    for (unsigned int rank = ones; rank < size; rank++)
+    {
+        unsigned int hole = findExtreme(pattern, energy, false);
+        pattern[hole] = true;
+        updateEnergy(energy, filter, hole, 1);
+        this->rank[hole] = rank;
+    }
+}
+
+/**
+ * @brief Returns blue noise matrix, it is built on first use
+ * @return Blue noise matrix
+ */
+static const BlueNoise & getBlueNoise()
+{
+    // Initialization of local static is thread safe
+    static const BlueNoise noise;
+
+    return noise;
+}
+
+/**
+ * @brief Returns rank of Bayer matrix cell, bits of x ^ y and y are interleaved
+ * and reversed
+ * @param x Column
+ * @param y Row
+ * @return Rank of cell
+ */
+static unsigned int bayerRank(unsigned int x, unsigned int y)
+{
+    unsigned int rank = 0;
+
+    for (unsigned int bit = 0; bit < DITHER_BAYER_BITS; bit++)
+        rank = rank << 2 | (((x ^ y) >> bit) & 1) << 1 | ((y >> bit) & 1);
+
+    return rank;
+}
+
+/**
+ * @brief Pool task, diffuses errors of rows taken from job, every chunk of row
+ * waits until previous row finished pixels it diffuses errors to
+ * @param argument Pointer to DitherStripe
+ */
+void ColorDitherer::floydSteinbergTask(void *argument)
+{
+    DitherJob *job = ((DitherStripe *)argument)->job;
+    const ColorQuantizer *quantizer = job->quantizer;
+    int rows = job->image->rows;
+    int cols = job->image->cols;
+
+    u_int8_t palette[QUANTIZE_COLORS][3];
+    copyPalette(quantizer, palette);
+
+    while (true)
+    {
+        int y = __sync_fetch_and_add(&job->next_row, 1);
+        if (y >= rows)
+            break;
+
+        // Row of errors is reused after row that read it finished
+        const int *in = job->errors + (y % job->rings) * job->stride;
+        int *out = job->errors + ((y + 1) % job->rings) * job->stride;
+        memset(out, 0, job->stride * sizeof(int));
+
+        const u_int8_t *pixel = job->image->ptr<u_int8_t>(y);
+        u_int8_t *result = job->output->ptr<u_int8_t>(y);
+        int carry[3] = {0, 0, 0};
+
+        for (int first = 0; first < cols; first += DITHER_WAVEFRONT_CHUNK)
+        {
+            int last = min(first + DITHER_WAVEFRONT_CHUNK, cols);
+
+            // Errors of pixel x are complete when previous row finished pixel x + 1
+            if (y > 0)
+            {
+                int needed = min(last + 1, cols);
+                while (job->progress[y - 1] < needed)
+                    sched_yield();
+                __sync_synchronize();
+            }
+
+            for (int x = first; x < last; x++)
+            {
+                int value[3];
+                for (int c = 0; c < 3; c++)
+                    value[c] = clampComponent(pixel[3 * x + c] + ((in[3 * (x + 1) + c] + carry[c] + 8) >> 4));
+
+                const u_int8_t *color = palette[quantizer->lookup(value[0], value[1], value[2])];
+
+                for (int c = 0; c < 3; c++)
+                {
+                    int error = value[c] - color[c];
+                    result[3 * x + c] = color[c];
+
+                    // Right 7/16, bottom left 3/16, bottom 5/16, bottom right 1/16
+                    carry[c] = 7 * error;
+                    out[3 * x + c] += 3 * error;
+                    out[3 * (x + 1) + c] += 5 * error;
+                    out[3 * (x + 2) + c] += error;
+                }
+            }
+
+            __sync_synchronize();
+            job->progress[y] = last;
+        }
+    }
+}
+
+/**
+ * @brief Pool task, adds matrix offsets to stripe pixels and maps them to palette
+ * @param argument Pointer to DitherStripe
+ */
+void ColorDitherer::orderedTask(void *argument)
+{
+    DitherStripe *stripe = (DitherStripe *)argument;
+    const DitherJob *job = stripe->job;
+    const ColorQuantizer *quantizer = job->quantizer;
+    unsigned int mask = (1u << job->matrix_bits) - 1;
+
+    u_int8_t palette[QUANTIZE_COLORS][3];
+    copyPalette(quantizer, palette);
+
+    for (unsigned int y = stripe->first; y < stripe->last; y++)
+    {
+        const u_int8_t *pixel = job->image->ptr<u_int8_t>(y);
+        u_int8_t *result = job->output->ptr<u_int8_t>(y);
+        const int *offsets = job->offsets + ((y & mask) << job->matrix_bits);
+
+        for (int x = 0; x < job->image->cols; x++, pixel += 3, result += 3)
+        {
+            int offset = offsets[x & mask];
+            const u_int8_t *color = palette[quantizer->lookup(clampComponent(pixel[0] + offset),
+                                                              clampComponent(pixel[1] + offset),
+                                                              clampComponent(pixel[2] + offset))];
+            result[0] = color[0];
+            result[1] = color[1];
+            result[2] = color[2];
+        }
+    }
+}
+
+/**
+ * @brief Maps image to palette of quantizer with dithering
+ * @param quantizer Quantizer with built palette
+ * @param image CV_8UC3 image
+ * @param output Output CV_8UC3 image of image size, can be same as image
+ * @param mode Dithering mode
+ * @param pool Thread pool, NULL to run on calling thread
+ */
+void ColorDitherer::dither(const ColorQuantizer &quantizer, const Mat &image, Mat &output,
+                           enum dither_mode mode, tTHREADPOOL *pool)
+{
+    DitherJob job;
+    job.quantizer = &quantizer;
+    job.image = &image;
+    job.output = &output;
+    job.next_row = 0;
+
+    unsigned int task_count = pool != NULL ? pool->threadCount + 1 : 1;
+    task_count = max(1u, min(task_count, (unsigned int)image.rows));
+    vector<DitherStripe> stripes(task_count);
+
+    if (mode == DITHER_FLOYD_STEINBERG)
+    {
+        // Every running task has one row in flight, their rows are all after last finished row
+        vector<int> errors((task_count + 1) * 3 * (image.cols + 2), 0);
+        vector<int> progress(image.rows, 0);
+
+        job.rings = task_count + 1;
+        job.stride = 3 * (image.cols + 2);
+        job.errors = &errors[0];
+        job.progress = &progress[0];
+
+        for (unsigned int i = 0; i < task_count; i++)
+            stripes[i].job = &job;
+
+        runTasks(pool, floydSteinbergTask, &stripes[0], sizeof(DitherStripe), task_count);
+        return;
+    }
+
+    // Offsets are centered around zero, rank + 0.5 of n cells spans (0, 1)
+    job.matrix_bits = mode == DITHER_BLUE_NOISE ? DITHER_NOISE_BITS : DITHER_BAYER_BITS;
+    unsigned int cells = 1u << (2 * job.matrix_bits);
+    vector<int> offsets(cells);
+
+    for (unsigned int i = 0; i < cells; i++)
+    {
+        unsigned int rank = mode == DITHER_BLUE_NOISE ? getBlueNoise().rank[i] :
+                            bayerRank(i & (DITHER_BAYER_SIZE - 1), i >> DITHER_BAYER_BITS);
+        offsets[i] = (int)floor(((rank + 0.5) / cells - 0.5) * DITHER_ORDERED_SPREAD + 0.5);
+    }
+    job.offsets = &offsets[0];
+
+    for (unsigned int i = 0; i < task_count; i++)
+    {
+        stripes[i].job = &job;
+        stripes[i].first = (unsigned int)((unsigned long long)image.rows * i / task_count);
+        stripes[i].last = (unsigned int)((unsigned long long)image.rows * (i + 1) / task_count);
+    }
+
+    runTasks(pool, orderedTask, &stripes[0], sizeof(DitherStripe), task_count);
+}
@@ -0,0 +1,41 @@
+#ifndef DITHERER_H
+#define DITHERER_H
+
+#include <cv.h>
+#include "quantizer.h"
+#include "threadpool.h"
+
+// Row publishes its progress after every chunk, next row lags behind by one chunk
+#define DITHER_WAVEFRONT_CHUNK 64
+
+// Ordered dithering threshold matrices
+#define DITHER_BAYER_BITS 3
+#define DITHER_BAYER_SIZE (1 << DITHER_BAYER_BITS)
+#define DITHER_NOISE_BITS 6
+#define DITHER_NOISE_SIZE (1 << DITHER_NOISE_BITS)
+
+// Blue noise matrix is built by void-and-cluster with this filter deviation
+#define DITHER_NOISE_SIGMA 1.5
+#define DITHER_NOISE_INITIAL_PERCENT 10
+
+// Amplitude of ordered dithering offsets in color levels
+#define DITHER_ORDERED_SPREAD 32
+
+/**
+ * @brief Maps image to palette of quantizer with dithering, output is same
+ * for any number of threads. Floyd-Steinberg rows run as diagonal wavefront on
+ * pool threads, ordered dithering by Bayer or blue noise matrix runs in
+ * independent row stripes.
+ */
+class ColorDitherer
+{
+private:
+    static void floydSteinbergTask(void *argument);
+    static void orderedTask(void *argument);
+
+public:
+    static void dither(const ColorQuantizer &quantizer, const Mat &image, Mat &output,
+                       enum dither_mode mode, tTHREADPOOL *pool = NULL);
+};
+
+#endif // DITHERER_H
@@ -9,6 +9,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <getopt.h>
 #include <unistd.h>
 #include <math.h>
@@ -17,1030 +19,1120 @@
 #include "gif.h"
 #include "bmp.h"
 #include "dictionary.h"
+#include "bitreader.h"
+#include "gifstream.h"
+#include "gifarena.h"
+#include "palette.h"
 #include "constant.h"
 
+// First row and row step of interlace passes
+static const u_int32_t interlaceStart[GIF_INTERLACE_PASSES] = {0, 4, 2, 1};
+static const u_int32_t interlaceStep[GIF_INTERLACE_PASSES] = {8, 8, 4, 2};
+
 /**
- * Function increment output buffer pointer
+ * Function save part of color indexes into bit map row, colors are expanded by
+ * palette table into BGR or opaque BGRA pixels (or copied in index plane mode).
+ * Output layout is compile time parameter, so row writing functions are
+ * instantiated once per layout.
  *
- * @param bitMapWriter bit map writer structure - include logical screen size, position and offset
+ * @param row Pointer to bit map row at first written column
+ * @param bitMapWriter Pointer to bit map writer structure - include logical screen size, position and offset
+ * @param source Color indexes of row
+ * @param start Index of first pixel in source
+ * @param count Number of pixels
  */
-void incBitMapBufferPointer(tBITMAPWRITER *bitMapWriter) {
-
-    bitMapWriter->actualColumn++;
-    if (bitMapWriter->actualColumn == (bitMapWriter->actualX + bitMapWriter->actualWidth)) {
+template <int outputMode>
+static inline void flushBitMapSpan(u_int8_t *row, tBITMAPWRITER *bitMapWriter, const u_int8_t *source, u_int32_t start, u_int32_t count) {
+
+    // Index plane - colors are expanded later
+    if (outputMode == GIF_OUTPUT_INDEX)
+        memcpy(row + start, source + start, count);
+    else if (outputMode == GIF_OUTPUT_BGRA)
+        expandPaletteRowAlpha(bitMapWriter->paletteTable, source + start, row + start * 4, count);
+    else
+        expandPaletteRow(bitMapWriter->paletteTable, source + start, row + start * 3, count);
+}
 
-        bitMapWriter->actualColumn = bitMapWriter->actualX;
-        bitMapWriter->actualRow++;
-        if (bitMapWriter->actualRow == (bitMapWriter->actualY + bitMapWriter->actualHeight)) {
-            bitMapWriter->actualRow = bitMapWriter->actualY;
-        }
+/**
+ * Function find end of run of transparent (or opaque) pixels in row, pixels
+ * are compared 8 at a time
+ *
+ * @param source Color indexes of row
+ * @param i Index of first pixel of run
+ * @param count Number of pixels in row
+ * @param transparent Transparent color index
+ * @return Index of first pixel behind the run
+ */
+template <int opaque>
+static inline u_int32_t findTransparentRunEnd(const u_int8_t *source, u_int32_t i, u_int32_t count, u_int8_t transparent) {
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const u_int64_t ones = 0x0101010101010101ULL;
+    const u_int64_t pattern = ones * transparent;
+
+    for (; i + 8 <= count; i += 8) {
+        u_int64_t word;
+        memcpy(&word, source + i, sizeof(word));
+
+        // Transparent pixels are zero bytes, lowest flagged byte ends the run
+        word ^= pattern;
+        u_int64_t end = opaque ? (word - ones) & ~word & (ones << 7) : word;
+        if (end)
+            return i + (__builtin_ctzll(end) >> 3);
     }
+#endif
+
+    while (i < count && (source[i] != transparent) == opaque)
+        i++;
+
+    return i;
 }
 
 /**
- * Function save color structure to BMP output buffer on writer position
+ * Function pass finished row of single row bit map to row sink. Only next row in top to
+ * bottom order is passed (pixels wrapped to the first row are dropped), bit map row is
+ * cleared to background for following row.
  *
- * @param color Index of color to color table
- * @param bitMap Bit map matrix
- * @param colorTable Pointer to color table
- * @param bitMapWriter Pointer to bit map writer structure - include logical screen size, position and offset
+ * @param bitMap Single row bit map matrix
+ * @param output Pointer to row output of writer
+ * @param y Row of output image
  */
-void processColor(int color, Mat &bitMap, tRGB *colorTable, tBITMAPWRITER *bitMapWriter) {
+static void emitBitMapRow(Mat &bitMap, tROWOUTPUT *output, u_int32_t y) {
 
-    //printf("	process color[RGB]: [%d, %d, %d]\n", colorTable[color].red, colorTable[color].green, colorTable[color].blue);
+    u_int8_t *row = bitMap.ptr<u_int8_t>(0);
 
-    // Tady se to posere
-    bitMap.at<cv::Vec3b>(bitMapWriter->actualRow,bitMapWriter->actualColumn).val[0] = colorTable[color].blue;
-    bitMap.at<cv::Vec3b>(bitMapWriter->actualRow,bitMapWriter->actualColumn).val[1] = colorTable[color].green;
-    bitMap.at<cv::Vec3b>(bitMapWriter->actualRow,bitMapWriter->actualColumn).val[2] = colorTable[color].red;
+    if (y == output->nextRow && output->status == EXIT_SUCCESS) {
+        if (output->sink->row(output->sink->context, y, row))
+            output->status = EXIT_FAILURE;
+        output->nextRow++;
+    }
 
-    // Increment BMP output buffer pointer
-    incBitMapBufferPointer(bitMapWriter);
+    memcpy(row, output->background, bitMap.cols * bitMap.elemSize());
 }
 
 /**
- * Function save dictionary item/color list into BMP output buffer
+ * Function save finished row of color indexes into bit map. Row is clipped to bit map,
+ * transparent pixels keep previous bit map content. Row of interlaced image decoded
+ * only from first passes covers also nearest rows which are not decoded. Scaled
+ * bit map gets only sampled rows and columns. Writer with row output has single row
+ * bit map which is passed to sink after each row.
  *
- * @param list List of colors - one item of dictionary
- * @param bmpOutputBuffer Pointer to bmp output buffer
- * @param colorTable Pointer to color table
- * @param bmpWriter Pointer to BMP writer structure - include logical screen size, position and offset
+ * @param bitMap Bit map matrix
+ * @param bitMapWriter Pointer to bit map writer structure - include logical screen size, position and offset
+ * @param count Number of pixels in row buffer
  */
-void processColorList(tDIC_ITEM *list, Mat &bitMap, tRGB *colorTable, tBITMAPWRITER *bitMapWriter) {
+template <int outputMode>
+static void flushBitMapRow(Mat &bitMap, tBITMAPWRITER *bitMapWriter, u_int32_t count) {
+
+    const tBITMAPSCALE *scale = bitMapWriter->scale;
+    tROWOUTPUT *output = bitMapWriter->rowOutput;
+    const u_int8_t *source = bitMapWriter->rowBuffer;
+    u_int32_t rows = output != NULL ? output->height : (u_int32_t)bitMap.rows;
+    u_int32_t firstRow = bitMapWriter->actualRow;
+    u_int32_t rowEnd = firstRow + 1;
+    u_int32_t column = bitMapWriter->actualX;
+
+    // Rows skipped by early exit are filled by nearest decoded row (rows of decoded
+    // passes form grid with step 8 or 4), it is approximation used for thumbnails only
+    if (bitMapWriter->passLimit < GIF_INTERLACE_PASSES) {
+        u_int32_t half = (interlaceStep[0] >> (bitMapWriter->passLimit - 1)) / 2;
+        u_int32_t frameEnd = bitMapWriter->actualY + bitMapWriter->actualHeight;
+
+        // Last decoded row covers also rows below it up to bottom of frame
+        rowEnd = firstRow + 2 * half < frameEnd ? firstRow + half : frameEnd;
+        firstRow = firstRow - bitMapWriter->actualY >= half ? firstRow - half : bitMapWriter->actualY;
+    }
 
-    // Get first color of the list
-    tLIST_ITEM *item = list->first;
+    // Screen coordinates are mapped into scaled bit map
+    if (scale != NULL) {
+        if (firstRow >= scale->height || column >= scale->width)
+            return;
+        if (rowEnd > scale->height)
+            rowEnd = scale->height;
+        if (count > scale->width - column)
+            count = scale->width - column;
+
+        firstRow = scale->rowStart[firstRow];
+        rowEnd = scale->rowStart[rowEnd];
+        if (firstRow == rowEnd)
+            return;
+
+        u_int32_t columnEnd = scale->columnStart[column + count];
+        column = scale->columnStart[column];
+        for (u_int32_t x = column; x < columnEnd; x++)
+            scale->rowBuffer[x - column] = source[scale->columnMap[x] - bitMapWriter->actualX];
+
+        source = scale->rowBuffer;
+        count = columnEnd - column;
+    }
 
-    // Process whole color list
-    while (item != NULL) {
+    if (firstRow >= rows || column >= (u_int32_t)bitMap.cols)
+        return;
+
+    if (rowEnd > rows)
+        rowEnd = rows;
+    if (count > bitMap.cols - column)
+        count = bitMap.cols - column;
+
+    for (u_int32_t y = firstRow; y < rowEnd; y++) {
+        u_int8_t *row = bitMap.ptr<u_int8_t>(output != NULL ? 0 : y) + column * bitMap.elemSize();
+
+        if (bitMapWriter->transparentIndex == NO_TRANSPARENT_COLOR)
+            flushBitMapSpan<outputMode>(row, bitMapWriter, source, 0, count);
+        else {
+            // Save only runs of opaque pixels, transparent pixels are not stored at all
+            u_int8_t transparent = (u_int8_t)bitMapWriter->transparentIndex;
+            u_int32_t i = 0;
+            while (i < count) {
+                i = findTransparentRunEnd<0>(source, i, count, transparent);
+
+                u_int32_t start = i;
+                i = findTransparentRunEnd<1>(source, i, count, transparent);
 
-        // Process item color
-        processColor(item->colorTableIndex, bitMap, colorTable, bitMapWriter);
+                if (i > start)
+                    flushBitMapSpan<outputMode>(row, bitMapWriter, source, start, i - start);
+            }
+        }
 
-        // Get next color
-        item = item->nextColor;
+        if (output != NULL)
+            emitBitMapRow(bitMap, output, y);
     }
 }
 
 /**
- * Function process image data block and save color for each pixel into buffer
+ * Function move writer to next image row, interlaced image rows are stored in four
+ * passes (every 8th row from 0, every 8th row from 4, every 4th row from 2 and
+ * every 2nd row from 1). Pixels behind the image wrap to the first row.
  *
- * @param inputFile Pointer to input GIF file
- * @param outputFile Pointer to output BMP file
- * @param reader Pointer to GIF reader structure
- * @param bmpOutputBuffer Pointer to BMP output buffer
  * @param bitMapWriter Pointer to bit map writer structure - include logical screen size, position and offset
- * @return 0 on success, 1 on failure
  */
-int getImageData(FILE *inputFile, tGIFREADER *reader, Mat &bitMap, tBITMAPWRITER *bitMapWriter) {
-
-    u_int8_t Byte = 0;
-    int readRetVal = 0;
-    u_int32_t readedBits;
-    u_int32_t processedPixels = 0;
-    tDICTIONARY dictionary;
-    int K = 0;				 // First color index to color table of color list
-    int firstCodeAfterCC = 0;// Control values
-    int subBlockStatus = UNFINISHED_SUBBLOCK;
-    reader->usedBitsFromByte1LastTime = -1;
+static void nextBitMapRow(tBITMAPWRITER *bitMapWriter) {
 
-    // Get LZW size
-    readRetVal = readByteFromFile(inputFile, &Byte);
-    if (readRetVal == READ_WRITE_ERR) {
-        fprintf(stderr, "%s", "Can not read input file.");
-        return EXIT_FAILURE;
-    }
-    else if (readRetVal == END_OF_FILE) {
-        fprintf(stderr, "%s", "Incorrect gif file.");
-        return EXIT_FAILURE;
-    }
-    else {
-        reader->lzwSize = (int)Byte;
-        reader->initLzwSize = reader->lzwSize;
-    }
-
-    // Get block size
-    readRetVal = readByteFromFile(inputFile, &Byte);
-    if (readRetVal == READ_WRITE_ERR) {
-        fprintf(stderr, "%s", "Can not read input file.");
-        return EXIT_FAILURE;
-    }
-    else if (readRetVal == END_OF_FILE) {
-        fprintf(stderr, "%s", "Incorrect gif file.");
-        return EXIT_FAILURE;
+    if (!bitMapWriter->interlaced) {
+        bitMapWriter->actualRow++;
+        if (bitMapWriter->actualRow == (bitMapWriter->actualY + bitMapWriter->actualHeight)) {
+            bitMapWriter->actualRow = bitMapWriter->actualY;
+        }
+        return;
     }
-    else
-        reader->BytesToReadInSubBlock = Byte;
 
-    // Init dictionary
-    if(initDictionary (&dictionary, reader)) {
-        freeDictionary(&dictionary);
-        return EXIT_FAILURE;
-    }
+    u_int32_t row = bitMapWriter->actualRow - bitMapWriter->actualY + interlaceStep[bitMapWriter->interlacePass];
 
-    // Read first code - should be CC
-    if (readBitsStreamFromFile (inputFile, reader, &readedBits, subBlockStatus)) {
-        freeDictionary(&dictionary);
-        return EXIT_FAILURE;
+    // Passes without rows are skipped
+    while (row >= bitMapWriter->actualHeight) {
+        bitMapWriter->interlacePass++;
+        if (bitMapWriter->interlacePass == GIF_INTERLACE_PASSES) {
+            bitMapWriter->interlacePass = 0;
+            row = 0;
+            break;
+        }
+        row = interlaceStart[bitMapWriter->interlacePass];
     }
 
-    // CC code
-    if (readedBits == (u_int32_t)dictionary.clearCode) {}
-    // Wrong code
-    else {
-        fprintf(stderr, "%s", "Incorrect gif file.");
-        freeDictionary(&dictionary);
-        return EXIT_FAILURE;
-    }
+    bitMapWriter->actualRow = bitMapWriter->actualY + row;
+}
 
-    if (readBitsStreamFromFile (inputFile, reader, &readedBits, subBlockStatus)) {
-        freeDictionary(&dictionary);
-        return EXIT_FAILURE;
-    }
+/**
+ * Function return image row of n-th stored row of interlaced image
+ *
+ * @param index Order of row in image data
+ * @param height Image height
+ * @return Image row
+ */
+static u_int32_t getInterlacedRow(u_int32_t index, u_int32_t height) {
 
+    for (int pass = 0; pass < GIF_INTERLACE_PASSES; pass++) {
+        u_int32_t rows = height > interlaceStart[pass] ? (height - interlaceStart[pass] + interlaceStep[pass] - 1) / interlaceStep[pass] : 0;
 
-    // Check the existence of the code in the dictionary
-    if (codeInDictionary(&dictionary, &readedBits)) {
-        fprintf(stderr, "%s", "Incorrect gif file.");
-        freeDictionary(&dictionary);
-        return EXIT_FAILURE;
+        if (index < rows)
+            return interlaceStart[pass] + index * interlaceStep[pass];
+        index -= rows;
     }
-    else {
-        // Process pixel
-        processColor(readedBits, bitMap, reader->activeColorTable, bitMapWriter);
 
-        // Pixel processed
-        processedPixels++;
+    return index;
+}
 
-        // Set CODE-1
-        dictionary.previousCode = readedBits;
-    }
+/**
+ * Function save color indexes into row buffer on writer position, finished rows
+ * are saved to bit map
+ *
+ * @param colors Color indexes
+ * @param length Number of color indexes
+ * @param bitMap Bit map matrix
+ * @param bitMapWriter Pointer to bit map writer structure - include logical screen size, position and offset
+ */
+template <int outputMode>
+static void processColors(const u_int8_t *colors, int length, Mat &bitMap, tBITMAPWRITER *bitMapWriter) {
 
-    // Read whole data block
-    while (processedPixels <= reader->dataBlockSize) {
+    u_int32_t rowEnd = bitMapWriter->actualX + bitMapWriter->actualWidth;
 
-        // Get block size
-        if (reader->BytesToReadInSubBlock == 0) {
-            readRetVal = readByteFromFile(inputFile, &Byte);
-            if (readRetVal == READ_WRITE_ERR) {
-                fprintf(stderr, "%s", "Can not read input file.");
-                freeDictionary(&dictionary);
-                return EXIT_FAILURE;
-            }
-            else if (readRetVal == END_OF_FILE) {
-                fprintf(stderr, "%s", "Incorrect gif file.");
-                freeDictionary(&dictionary);
-                return EXIT_FAILURE;
-            }
-            else
-                reader->BytesToReadInSubBlock = Byte;
+    // Image without pixels
+    if (bitMapWriter->actualWidth == 0 || bitMapWriter->actualHeight == 0)
+        return;
 
-            // Start new subblock
-            subBlockStatus = NEW_SUBBLOCK;
-        }
-//printf("*%d\n",reader->BytesToReadInSubBlock);
-
-        // Zero sub block size - end of data block
-        if (reader->BytesToReadInSubBlock == 0) {
-//printf("ZERO SUB BLOCK\n");
-            // Get missing pixels from bytes buffer in reader
-            while (processedPixels <= reader->dataBlockSize) {
-
-                // Dont read next byte from stream, just process buffered bytes
-                reader->BytesToReadInSubBlock = 0;
-//printf("%d %d %d\n", reader->Byte1, reader->Byte2, reader->Byte3);
-                // Read code form block
-                if (readBitsStreamFromFile (inputFile, reader, &readedBits, subBlockStatus)) {
-                    freeDictionary(&dictionary);
-                    return EXIT_FAILURE;
-                }
-
-                // Last code must be end of information
-                if (processedPixels == reader->dataBlockSize) {
-
-                    if (readedBits == (u_int32_t)dictionary.endOfInformationCode) {
-                        freeDictionary(&dictionary);
-//printf("CC\n");
-                        return EXIT_SUCCESS;
-                    }
-                    else {
-//printf("NO, IT ISNT, FUCK!\n");
-                        fprintf(stderr, "%s", "Incorrect gif file.");
-                        freeDictionary(&dictionary);
-                        return EXIT_FAILURE;
-                    }
-                }
-
-
-                // Clear code
-                if (readedBits == (u_int32_t)dictionary.clearCode) {
-                    // Init dictionary
-                    if(reInitDictionary (&dictionary, reader)) {
-                        freeDictionary(&dictionary);
-                        return EXIT_FAILURE;
-                    }
-                }
-                else if (readedBits == (u_int32_t)dictionary.endOfInformationCode) {
-                    fprintf(stderr, "%s", "Incorrect gif file.");
-                    freeDictionary(&dictionary);
-                    return EXIT_FAILURE;
-                }
-                // Look into dictionary
-                else {
-                    // Check the existence of the code in the dictionary
-                    if (codeInDictionary(&dictionary, &readedBits)) { // Code is not in dictionary
-
-                        // Get first index of CODE-1
-                        K = dictionary.colors[dictionary.previousCode].first->colorTableIndex;
-
-                        // Process CODE-1 record
-                        processColorList(&(dictionary.colors[dictionary.previousCode]), bitMap, reader->activeColorTable, bitMapWriter);
-
-                        // List length pixels processed
-                        processedPixels += listLength(&(dictionary.colors[dictionary.previousCode]));
-
-                        // Process K
-                        processColor(K, bitMap, reader->activeColorTable, bitMapWriter);
-
-                        // Pixel processed
-                        processedPixels++;
-
-                    }
-                    else {// Code is already in dictionary
-
-                        // Process CODE record
-                        processColorList(&(dictionary.colors[readedBits]), bitMap, reader->activeColorTable, bitMapWriter);
-
-                        // List length pixels processed
-                        processedPixels += listLength(&(dictionary.colors[readedBits]));
-
-                        // Get first index of code
-                        K = dictionary.colors[readedBits].first->colorTableIndex;
-                    }
-
-                    // Create new dictionary record from CODE-1 and K
-                    if (copyLists(&(dictionary.colors[dictionary.previousCode]), &(dictionary.colors[dictionary.firstEmptyCode]))) {
-                        freeDictionary(&dictionary);
-                        return EXIT_FAILURE;
-                    }
-
-                    // Empty list
-                    if (dictionary.colors[dictionary.firstEmptyCode].last == NULL) {
-                        dictionary.colors[dictionary.firstEmptyCode].last = newDicItem(K);
-                        dictionary.colors[dictionary.firstEmptyCode].first = dictionary.colors[dictionary.firstEmptyCode].last;
-                    }
-                    else {
-                        dictionary.colors[dictionary.firstEmptyCode].last->nextColor = newDicItem(K);
-                        if (dictionary.colors[dictionary.firstEmptyCode].last->nextColor == NULL) {
-                            freeDictionary(&dictionary);
-                            return EXIT_FAILURE;
-                        }
-                        dictionary.colors[dictionary.firstEmptyCode].last = dictionary.colors[dictionary.firstEmptyCode].last->nextColor;
-                    }
-
-                    // Check dictionary capacity
-                    dictionary.firstEmptyCode++;
-
-                    // Increase LZW size
-                    if (dictionary.firstEmptyCode > dictionary.curMaxCode) {
-                        if (reader->lzwSize < 12) {
-                            reader->lzwSize++;
-                            switch(reader->lzwSize) {
-                                case(2):
-                                        dictionary.curMaxCode = _2_BITS_MAX_CODE;
-                                        break;
-                                case(3):
-                                        dictionary.curMaxCode = _3_BITS_MAX_CODE;
-                                        break;
-                                case(4):
-                                        dictionary.curMaxCode = _4_BITS_MAX_CODE;
-                                        break;
-                                case(5):
-                                        dictionary.curMaxCode = _5_BITS_MAX_CODE;
-                                        break;
-                                case(6):
-                                        dictionary.curMaxCode = _6_BITS_MAX_CODE;
-                                        break;
-                                case(7):
-                                        dictionary.curMaxCode = _7_BITS_MAX_CODE;
-                                        break;
-                                case(8):
-                                        dictionary.curMaxCode = _8_BITS_MAX_CODE;
-                                        break;
-                                case(9):
-                                        dictionary.curMaxCode = _9_BITS_MAX_CODE;
-                                        break;
-                                case(10):
-                                        dictionary.curMaxCode = _10_BITS_MAX_CODE;
-                                        break;
-                                case(11):
-                                        dictionary.curMaxCode = _11_BITS_MAX_CODE;
-                                        break;
-                                case(12):
-                                        dictionary.curMaxCode = _12_BITS_MAX_CODE;
-                                        break;
-                                default:
-                                        fprintf(stderr, "%s", "Unsupported LZW size.");
-                                        cerr << reader->lzwSize << endl;
-                                        freeDictionary(&dictionary);
-                                        return EXIT_FAILURE;
-                            }
-                        }
-                        // Dictionary is full - next code must be CC
-                        else
-                            dictionary.firstEmptyCode = DICTIONARY_FULL;
-                    }
-                }
-                // Set CODE-1
-                dictionary.previousCode = readedBits;
-            }
-            break;
-        }
+    bitMapWriter->writtenPixels += length;
 
-        // Get data sub block
-        while (reader->BytesToReadInSubBlock != 0) {
+    // Writing stops after last requested interlace pass
+    while (length > 0 && bitMapWriter->interlacePass < bitMapWriter->passLimit) {
 
-            // Normal mode
-            if (firstCodeAfterCC == 0) {
+        // Copy part of the list which fits into row
+        u_int32_t count = rowEnd - bitMapWriter->actualColumn;
+        if (count > (u_int32_t)length)
+            count = length;
 
-                // Read code form block
-                if (readBitsStreamFromFile (inputFile, reader, &readedBits, subBlockStatus)) {
-                    freeDictionary(&dictionary);
-                    return EXIT_FAILURE;
-                }
-                // Change block status
-                subBlockStatus = UNFINISHED_SUBBLOCK;
-//                printf("+++%d %d\n",readedBits, reader->lzwSize);fflush(stdout);
-                // Full dictionary?
-                //if (dictionary.firstEmptyCode == DICTIONARY_FULL) {
-
-                    // Expecting clean code
-                    if (readedBits == (u_int32_t)dictionary.clearCode) {
-//printf("REINIT TO:\n");printf("%d \n",reader->lzwSize);
-                        // Restart process
-                        reader->lzwSize = reader->initLzwSize;
-                        firstCodeAfterCC = 1;
-//printf("%d \n",reader->lzwSize);
-fflush(stdout);
-                        // Init dictionary
-                        if(reInitDictionary(&dictionary, reader)) {
-                            freeDictionary(&dictionary);
-                            return EXIT_FAILURE;
-                        }
-                        continue;
-                    }
-                    // Wrong gif format
-                    //else {
-                    //	fprintf(stderr, "%s", "Incorrect gif file.");
-                    //	freeDictionary(&dictionary);
-                    //	return EXIT_FAILURE;
-                    //}
-                //}
-
-                // Last code in data sub block
-                if (readedBits == (u_int32_t)dictionary.endOfInformationCode) {
-                    freeDictionary(&dictionary);
-                    return EXIT_SUCCESS;
-                }
-
-                // Clear code
-                else if (readedBits == (u_int32_t)dictionary.clearCode) {
-                    // Init dictionary
-                    if(reInitDictionary (&dictionary, reader)) {
-                        freeDictionary(&dictionary);
-                        return EXIT_FAILURE;
-                    }
-
-                }
-                // Look into dictionary
-                else {
-                    // Check the existence of the code in the dictionary
-                    if (codeInDictionary(&dictionary, &readedBits)) { // Code is not in dictionary
-//printf("***+**\n");fflush(stdout);printf("%d %d\n", dictionary.previousCode, dictionary.firstEmptyCode);fflush(stdout);
-                        // Get first index of CODE-1
-                        K = dictionary.colors[dictionary.previousCode].first->colorTableIndex;
-//printf("%d\n", dictionary.previousCode);fflush(stdout);
-                        // Process CODE-1 record
-                        processColorList(&(dictionary.colors[dictionary.previousCode]), bitMap, reader->activeColorTable, bitMapWriter);
-//printf("**++++***\n");fflush(stdout);
-                        // List length pixels processed
-                        processedPixels += listLength(&(dictionary.colors[dictionary.previousCode]));
-
-                        // Process K
-                        processColor(K, bitMap, reader->activeColorTable, bitMapWriter);
-
-                        // Pixel processed
-                        processedPixels++;
-
-                    }
-                    else {// Code is already in dictionary
-
-                        // Process CODE record
-                        processColorList(&(dictionary.colors[readedBits]), bitMap, reader->activeColorTable, bitMapWriter);
-
-                        // List length pixels processed
-                        processedPixels += listLength(&(dictionary.colors[readedBits]));
-
-                        // Get first index of code
-                        K = dictionary.colors[readedBits].first->colorTableIndex;
-                    }
-
-                    // Create new dictionary record from CODE-1 and K
-                    if (copyLists(&(dictionary.colors[dictionary.previousCode]), &(dictionary.colors[dictionary.firstEmptyCode]))) {
-                        freeDictionary(&dictionary);
-                        return EXIT_FAILURE;
-                    }
-
-                    // Empty list
-                    if (dictionary.colors[dictionary.firstEmptyCode].last == NULL) {
-                        dictionary.colors[dictionary.firstEmptyCode].last = newDicItem(K);
-                        dictionary.colors[dictionary.firstEmptyCode].first = dictionary.colors[dictionary.firstEmptyCode].last;
-                    }
-                    else {
-                        dictionary.colors[dictionary.firstEmptyCode].last->nextColor = newDicItem(K);
-                        if (dictionary.colors[dictionary.firstEmptyCode].last->nextColor == NULL) {
-                            freeDictionary(&dictionary);
-                            return EXIT_FAILURE;
-                        }
-                        dictionary.colors[dictionary.firstEmptyCode].last = dictionary.colors[dictionary.firstEmptyCode].last->nextColor;
-                    }
-
-                    // Check dictionary capacity
-                    dictionary.firstEmptyCode++;
-
-                    // Increase LZW size
-                    if (dictionary.firstEmptyCode > dictionary.curMaxCode) {
-                        if (reader->lzwSize < 12) {
-                            reader->lzwSize++;
-                            switch(reader->lzwSize) {
-                                case(2):
-                                        dictionary.curMaxCode = _2_BITS_MAX_CODE;
-                                        break;
-                                case(3):
-                                        dictionary.curMaxCode = _3_BITS_MAX_CODE;
-                                        break;
-                                case(4):
-                                        dictionary.curMaxCode = _4_BITS_MAX_CODE;
-                                        break;
-                                case(5):
-                                        dictionary.curMaxCode = _5_BITS_MAX_CODE;
-                                        break;
-                                case(6):
-                                        dictionary.curMaxCode = _6_BITS_MAX_CODE;
-                                        break;
-                                case(7):
-                                        dictionary.curMaxCode = _7_BITS_MAX_CODE;
-                                        break;
-                                case(8):
-                                        dictionary.curMaxCode = _8_BITS_MAX_CODE;
-                                        break;
-                                case(9):
-                                        dictionary.curMaxCode = _9_BITS_MAX_CODE;
-                                        break;
-                                case(10):
-                                        dictionary.curMaxCode = _10_BITS_MAX_CODE;
-                                        break;
-                                case(11):
-                                        dictionary.curMaxCode = _11_BITS_MAX_CODE;
-                                        break;
-                                case(12):
-                                        dictionary.curMaxCode = _12_BITS_MAX_CODE;
-                                        break;
-                                default:
-                                        fprintf(stderr, "%s", "Unsupported LZW size.");
-                                        cerr << reader->lzwSize << endl;
-                                        freeDictionary(&dictionary);
-                                        return EXIT_FAILURE;
-                            }
-                        }
-                        // Dictionary is full - next code must be CC
-                        else
-                            dictionary.firstEmptyCode = DICTIONARY_FULL;
-                    }
-                }
-
-                // Set CODE-1
-                dictionary.previousCode = readedBits;
-            }
-            else { // Fill reader
+        memcpy(bitMapWriter->rowBuffer + (bitMapWriter->actualColumn - bitMapWriter->actualX), colors, count);
+        bitMapWriter->actualColumn += count;
+        colors += count;
+        length -= count;
 
-                // Normal mode for reader
-                firstCodeAfterCC = 0;
+        // Row is finished
+        if (bitMapWriter->actualColumn == rowEnd) {
+            flushBitMapRow<outputMode>(bitMap, bitMapWriter, bitMapWriter->actualWidth);
 
-                // Read code form block
-                if (readBitsStreamFromFile (inputFile, reader, &readedBits, subBlockStatus)) {
-                    freeDictionary(&dictionary);
-                    return EXIT_FAILURE;
-                }
-
-                // Last code in data sub block
-                if (readedBits == (u_int32_t)dictionary.endOfInformationCode) {
-                    freeDictionary(&dictionary);
-                    return EXIT_SUCCESS;
-                }
-
-                // Clear code
-                else if (readedBits == (u_int32_t)dictionary.clearCode) {
-                    // Init dictionary
-                    if(reInitDictionary (&dictionary, reader)) {
-                        freeDictionary(&dictionary);
-                        return EXIT_FAILURE;
-                    }
-                }
-                // Should be in dictionary
-                else {
-                    // Check the existence of the code in the dictionary
-                    if (codeInDictionary(&dictionary, &readedBits)) {
-                        fprintf(stderr, "%s", "Incorrect gif file.");
-                        freeDictionary(&dictionary);
-                        return EXIT_FAILURE;
-                    }
-                    else {
-                        processColor(readedBits, bitMap, reader->activeColorTable, bitMapWriter);
-
-                        // Pixel processed
-                        processedPixels++;
-
-                        // Set CODE-1
-                        dictionary.previousCode = readedBits;
-                    }
-                }
-            }
+            bitMapWriter->actualColumn = bitMapWriter->actualX;
+            nextBitMapRow(bitMapWriter);
         }
+    }
+}
 
+/**
+ * Function save unfinished row from row buffer into bit map
+ *
+ * @param bitMap Bit map matrix
+ * @param bitMapWriter Pointer to bit map writer structure - include logical screen size, position and offset
+ */
+template <int outputMode>
+static void finishBitMap(Mat &bitMap, tBITMAPWRITER *bitMapWriter) {
+
+    if (bitMapWriter->actualColumn != bitMapWriter->actualX)
+        flushBitMapRow<outputMode>(bitMap, bitMapWriter, bitMapWriter->actualColumn - bitMapWriter->actualX);
+}
+
+/**
+ * Function save color index plane of whole image into bit map on writer position
+ *
+ * @param indices Color index plane of image
+ * @param pixels Number of decoded pixels in index plane
+ * @param bitMap Bit map matrix
+ * @param bitMapWriter Pointer to bit map writer structure - include logical screen size, position and offset
+ */
+void drawIndexPlane(const Mat &indices, u_int32_t pixels, Mat &bitMap, tBITMAPWRITER *bitMapWriter) {
+
+    static void (*const flushRows[GIF_OUTPUT_MODES])(Mat &, tBITMAPWRITER *, u_int32_t) = {
+        flushBitMapRow<GIF_OUTPUT_BGR>, flushBitMapRow<GIF_OUTPUT_INDEX>, flushBitMapRow<GIF_OUTPUT_BGRA>
+    };
+    u_int8_t *rowBuffer = bitMapWriter->rowBuffer;
+    void (*flushRow)(Mat &, tBITMAPWRITER *, u_int32_t) = flushRows[bitMapWriter->outputMode];
+
+    // Rows of index plane are used as row buffer, rows are drawn in order of image data
+    for (int i = 0; i < indices.rows && pixels > 0; i++) {
+        u_int32_t count = pixels < (u_int32_t)indices.cols ? pixels : (u_int32_t)indices.cols;
+        int row = bitMapWriter->interlaced ? (int)getInterlacedRow(i, indices.rows) : i;
+
+        bitMapWriter->rowBuffer = (u_int8_t *)indices.ptr<u_int8_t>(row);
+        bitMapWriter->actualRow = bitMapWriter->actualY + row;
+        flushRow(bitMap, bitMapWriter, count);
+        pixels -= count;
     }
 
-    freeDictionary(&dictionary);
+    bitMapWriter->rowBuffer = rowBuffer;
+}
+
+/**
+ * Function copy dictionary item string into decoded output, by back reference into
+ * earlier output or by prefix chain into output of single string
+ *
+ * @param dictionary Pointer to dictionary
+ * @param code Code of dictionary item
+ * @param output Decoded color indexes
+ * @param position Position of string in decoded output
+ * @return Number of colors in string
+ */
+template <int backReference>
+static inline int copyDicItem(tDICTIONARY *dictionary, u_int32_t code, u_int8_t *output, u_int32_t position) {
 
-    return EXIT_SUCCESS;
+    if (backReference)
+        return copyDicItemString(dictionary, code, output, position);
+
+    return unwindDicItemString(dictionary, code, output + position);
 }
 
 /**
- * Function read color table from GIF file and save it into field
+ * Function save dictionary item/color list into decoded output and BMP output buffer
  *
- * @param gifFile Input GIF file
- * @param colorTable Color table field
- * @param colorTableSize Size of color table
+ * @param dictionary Pointer to dictionary
+ * @param code Code of dictionary item
+ * @param output Decoded color indexes of image
+ * @param position Position of color list in decoded output
+ * @param bitMap Bit map matrix
+ * @param bitMapWriter Pointer to bit map writer structure - include logical screen size, position and offset
+ * @return Number of processed colors
+ */
+template <int outputMode, int backReference>
+static inline int processColorList(tDICTIONARY *dictionary, u_int32_t code, u_int8_t *output, u_int32_t position, Mat &bitMap, tBITMAPWRITER *bitMapWriter) {
+
+    // Copy dictionary item from earlier output or dictionary
+    int length = copyDicItem<backReference>(dictionary, code, output, position);
+
+    // Process whole color list
+    processColors<outputMode>(output + position, length, bitMap, bitMapWriter);
+
+    return length;
+}
+
+/**
+ * Function enlarge decoded output buffer of reader, buffer grows at least twice
+ *
+ * @param reader Pointer to GIF reader structure
+ * @param size Requested size in bytes
  * @return 0 on success, 1 on failure
  */
-int getColorTable(FILE *gifFile, tRGB colorTable [], int colorTableSize) {
+static int reserveIndexBuffer(tGIFREADER *reader, u_int32_t size) {
 
-//cout<<endl<<"Reading color table:"<<endl;
-    u_int8_t Byte = 0;
-    int readRetVal = 0;
+    if (size <= reader->indexBufferSize)
+        return EXIT_SUCCESS;
 
-    for (int i = 0; i < colorTableSize; i++) {
-        for (int j = 0; j < 3; j++) {
-            readRetVal = readByteFromFile(gifFile, &Byte);
-            if (readRetVal == READ_WRITE_ERR) {
-                fprintf(stderr, "%s", "Can not read input file.");
-                return EXIT_FAILURE;
-            }
-            else if (readRetVal == END_OF_FILE) {
-                fprintf(stderr, "%s", "Incorrect gif file.");
-                return EXIT_FAILURE;
-            }
-            // Save colors
-            else {
-                if (j == 0)
-                    colorTable[i].red = Byte;
-                else if (j == 1)
-                    colorTable[i].green = Byte;
-                else
-                    colorTable[i].blue = Byte;
-            }
+    if (reader->indexBufferSize <= UINT32_MAX / 2 && size < reader->indexBufferSize * 2)
+        size = reader->indexBufferSize * 2;
 
+    u_int8_t *buffer = (u_int8_t *)realloc(reader->indexBuffer, size);
+    if (buffer == NULL)
+        return EXIT_FAILURE;
 
+    reader->indexBuffer = buffer;
+    reader->indexBufferSize = size;
+    reader->allocations++;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Function increase LZW size when last added code reached current max code
+ *
+ * @param dictionary Pointer to dictionary
+ * @param reader Pointer to GIF reader structure
+ */
+static inline void updateLzwSize(tDICTIONARY *dictionary, tGIFREADER *reader) {
+
+    if (dictionary->firstEmptyCode > dictionary->curMaxCode) {
+        if (reader->lzwSize < GIF_MAX_CODE_WORD_LENGTH_IN_BITS) {
+            reader->lzwSize++;
+            dictionary->curMaxCode = bitReaderCodeMask[reader->lzwSize];
         }
-//printf("	id[RGB]: %d  [%d, %d, %d]\n", i, colorTable[i].red, colorTable[i].green, colorTable[i].blue);
-fflush(stdout);
+        // Dictionary is full - next code must be CC
+        else
+            dictionary->firstEmptyCode = DICTIONARY_FULL;
     }
-    return EXIT_SUCCESS;
 }
 
 /**
- * Function read application extension, only skip values
+ * Function decode LZW codes of image data into bit map. Kernel is instantiated for
+ * each minimum code size (clear and end codes are constants), output layout and
+ * string expansion. Back references need whole decoded image block in reader index
+ * buffer, prefix chains need only room for the longest string.
  *
- * @param inputFile Input GIF file
+ * @param reader Pointer to GIF reader structure, bit reader is behind first clear code
+ * @param dictionary Pointer to initialized dictionary
+ * @param bitMap Bit map matrix
+ * @param bitMapWriter Pointer to bit map writer structure - include logical screen size, position and offset
  * @return 0 on success, 1 on failure
  */
-int getApplicationExt(FILE *inputFile) {
+template <int minCodeSize, int outputMode, int backReference>
+static int decodeImageData(tGIFREADER *reader, tDICTIONARY *dictionary, Mat &bitMap, tBITMAPWRITER *bitMapWriter) {
 
-    fprintf(stderr, "%s", "Input file include application extension, whitch is not supported.\n");
-    return EXIT_FAILURE;
+    const u_int32_t clearCode = 1 << minCodeSize;
+    const u_int32_t endOfInformationCode = clearCode + 1;
+    u_int32_t readedBits;
+    u_int32_t processedPixels = 0;
+    u_int32_t position;
+    int length;
+    u_int8_t *output;
+    int K = 0;				 // First color index to color table of color list
+    int firstCodeAfterCC = 1;// Control values
+    tBITREADER *bitReader = &reader->bitReader;
 
-    u_int8_t Byte = 0;
-    int readRetVal;
+    // Read whole data block
+    while (processedPixels <= reader->dataBlockSize) {
 
-    readRetVal = readByteFromFile(inputFile, &Byte);
-    if (readRetVal == READ_WRITE_ERR) {
-        fprintf(stderr, "%s", "Can not read input file.");
-        return EXIT_FAILURE;
-    }
-    else if (readRetVal == END_OF_FILE) {
-        fprintf(stderr, "%s", "Incorrect gif file.");
-        return EXIT_FAILURE;
-    }
-    else {
-        // get extension size
-        int appliExtSize = (int)Byte;
+        // Requested interlace passes are decoded, other rows are already filled
+        if (bitMapWriter->interlacePass >= bitMapWriter->passLimit)
+            return EXIT_SUCCESS;
+
+        // Row sink refused row
+        if (bitMapWriter->rowOutput != NULL && bitMapWriter->rowOutput->status != EXIT_SUCCESS)
+            return EXIT_FAILURE;
+
+        // Data are exhausted without EOI
+        if (bitReaderEmpty(bitReader, reader->lzwSize)) {
+            if (processedPixels == reader->dataBlockSize) {
+                finishBitMap<outputMode>(bitMap, bitMapWriter);
+                return EXIT_SUCCESS;
+            }
 
-        // fixed value
-        if (appliExtSize != 11) {
             fprintf(stderr, "%s", "Incorrect gif file.");
             return EXIT_FAILURE;
         }
 
-        // read application identifier and authentication code and block size (last readed byte)
-        for (int i = 0; i < appliExtSize + 1; i++) {
-            readRetVal = readByteFromFile(inputFile, &Byte);
-            if (readRetVal == READ_WRITE_ERR) {
-                fprintf(stderr, "%s", "Can not read input file.");
+        // Decoded output has room for the longest dictionary item, without back
+        // references only the last string is kept
+        position = backReference ? processedPixels : 0;
+        if (position + DICTIONARY_MAX_SIZE > reader->indexBufferSize &&
+            reserveIndexBuffer(reader, position + DICTIONARY_MAX_SIZE)) {
+            fprintf(stderr, "%s", "Not enough memory.");
+            return EXIT_FAILURE;
+        }
+        output = reader->indexBuffer;
+
+        // Read code form block
+        readedBits = readCode(bitReader, reader->lzwSize);
+
+        // Last code in data block
+        if (readedBits == endOfInformationCode) {
+            finishBitMap<outputMode>(bitMap, bitMapWriter);
+            return EXIT_SUCCESS;
+        }
+
+        // Clear code - restart process
+        else if (readedBits == clearCode) {
+            reader->lzwSize = minCodeSize;
+            firstCodeAfterCC = 1;
+
+            // Init dictionary
+            if(reInitDictionary(dictionary, reader)) {
                 return EXIT_FAILURE;
             }
-            else if (readRetVal == END_OF_FILE) {
+        }
+
+        // First code after CC - should be in dictionary
+        else if (firstCodeAfterCC) {
+
+            // Normal mode for reader
+            firstCodeAfterCC = 0;
+
+            // Check the existence of the code in the dictionary
+            if (codeInDictionary(dictionary, &readedBits)) {
                 fprintf(stderr, "%s", "Incorrect gif file.");
                 return EXIT_FAILURE;
             }
-            else {
-                // SKIP VALUES
-            }
+
+            output[position] = (u_int8_t)readedBits;
+            processColors<outputMode>(output + position, 1, bitMap, bitMapWriter);
+
+            // Pixel processed
+            processedPixels++;
+
+            // Set CODE-1
+            dictionary->previousCode = readedBits;
+            dictionary->previousOffset = position;
         }
-        // get data block size
-        appliExtSize = (int)Byte;
 
+        // Look into dictionary
+        else {
+            // Check the existence of the code in the dictionary
+            if (codeInDictionary(dictionary, &readedBits)) { // Code is not in dictionary
 
-        // read data block, last byte must be empty sub block
-        for (int i = 0; i < appliExtSize + 1; i++) {
-            readRetVal = readByteFromFile(inputFile, &Byte);
-            if (readRetVal == READ_WRITE_ERR) {
-                fprintf(stderr, "%s", "Can not read input file.");
-                return EXIT_FAILURE;
-            }
-            else if (readRetVal == END_OF_FILE) {
-                fprintf(stderr, "%s", "Incorrect gif file.");
-                return EXIT_FAILURE;
+                // Get first index of CODE-1
+                K = dictionary->firstColor[dictionary->previousCode];
+
+                // Process CODE-1 record followed by K, list length pixels processed
+                length = copyDicItem<backReference>(dictionary, dictionary->previousCode, output, position);
+                output[position + length] = (u_int8_t)K;
+                processColors<outputMode>(output + position, length + 1, bitMap, bitMapWriter);
+                processedPixels += length + 1;
             }
-            else {
-                // SKIP VALUES
+            else {// Code is already in dictionary
+
+                // Process CODE record, list length pixels processed
+                processedPixels += processColorList<outputMode, backReference>(dictionary, readedBits, output, position, bitMap, bitMapWriter);
+
+                // Get first index of code
+                K = dictionary->firstColor[readedBits];
             }
-        }
 
-        // check last byte value
-        if (Byte != BLOCK_TERMINATOR) {
-            fprintf(stderr, "%s", "Incorrect gif file.");
-            return EXIT_FAILURE;
-        }
+            // Create new dictionary record from CODE-1 and K
+            addDicItem(dictionary, dictionary->previousCode, K);
+
+            // Increase LZW size
+            updateLzwSize(dictionary, reader);
 
-        // Skip data in LZW
+            // Set CODE-1
+            dictionary->previousCode = readedBits;
+            dictionary->previousOffset = position;
+        }
     }
 
+    finishBitMap<outputMode>(bitMap, bitMapWriter);
     return EXIT_SUCCESS;
 }
 
+// Decoding kernels for minimum code size, output layout and string expansion
+typedef int (*tIMAGEDATAKERNEL)(tGIFREADER *, tDICTIONARY *, Mat &, tBITMAPWRITER *);
+
+static const tIMAGEDATAKERNEL imageDataKernels[GIF_MAX_LZW_SIZE - GIF_MIN_LZW_SIZE + 1][GIF_OUTPUT_MODES][2] = {
+    {{decodeImageData<2, GIF_OUTPUT_BGR, 0>, decodeImageData<2, GIF_OUTPUT_BGR, 1>},
+     {decodeImageData<2, GIF_OUTPUT_INDEX, 0>, decodeImageData<2, GIF_OUTPUT_INDEX, 1>},
+     {decodeImageData<2, GIF_OUTPUT_BGRA, 0>, decodeImageData<2, GIF_OUTPUT_BGRA, 1>}},
+    {{decodeImageData<3, GIF_OUTPUT_BGR, 0>, decodeImageData<3, GIF_OUTPUT_BGR, 1>},
+     {decodeImageData<3, GIF_OUTPUT_INDEX, 0>, decodeImageData<3, GIF_OUTPUT_INDEX, 1>},
+     {decodeImageData<3, GIF_OUTPUT_BGRA, 0>, decodeImageData<3, GIF_OUTPUT_BGRA, 1>}},
+    {{decodeImageData<4, GIF_OUTPUT_BGR, 0>, decodeImageData<4, GIF_OUTPUT_BGR, 1>},
+     {decodeImageData<4, GIF_OUTPUT_INDEX, 0>, decodeImageData<4, GIF_OUTPUT_INDEX, 1>},
+     {decodeImageData<4, GIF_OUTPUT_BGRA, 0>, decodeImageData<4, GIF_OUTPUT_BGRA, 1>}},
+    {{decodeImageData<5, GIF_OUTPUT_BGR, 0>, decodeImageData<5, GIF_OUTPUT_BGR, 1>},
+     {decodeImageData<5, GIF_OUTPUT_INDEX, 0>, decodeImageData<5, GIF_OUTPUT_INDEX, 1>},
+     {decodeImageData<5, GIF_OUTPUT_BGRA, 0>, decodeImageData<5, GIF_OUTPUT_BGRA, 1>}},
+    {{decodeImageData<6, GIF_OUTPUT_BGR, 0>, decodeImageData<6, GIF_OUTPUT_BGR, 1>},
+     {decodeImageData<6, GIF_OUTPUT_INDEX, 0>, decodeImageData<6, GIF_OUTPUT_INDEX, 1>},
+     {decodeImageData<6, GIF_OUTPUT_BGRA, 0>, decodeImageData<6, GIF_OUTPUT_BGRA, 1>}},
+    {{decodeImageData<7, GIF_OUTPUT_BGR, 0>, decodeImageData<7, GIF_OUTPUT_BGR, 1>},
+     {decodeImageData<7, GIF_OUTPUT_INDEX, 0>, decodeImageData<7, GIF_OUTPUT_INDEX, 1>},
+     {decodeImageData<7, GIF_OUTPUT_BGRA, 0>, decodeImageData<7, GIF_OUTPUT_BGRA, 1>}},
+    {{decodeImageData<8, GIF_OUTPUT_BGR, 0>, decodeImageData<8, GIF_OUTPUT_BGR, 1>},
+     {decodeImageData<8, GIF_OUTPUT_INDEX, 0>, decodeImageData<8, GIF_OUTPUT_INDEX, 1>},
+     {decodeImageData<8, GIF_OUTPUT_BGRA, 0>, decodeImageData<8, GIF_OUTPUT_BGRA, 1>}}
+};
+
 /**
- * Function read comment extension, only skip values
+ * Function process image data block and save color for each pixel into buffer,
+ * decoding kernel is selected by minimum code size and writer output layout. Back
+ * references are used only for full resolution output, which is as large as decoded
+ * image block anyway. Scaled, cropped and row sink output keeps only one string, so
+ * memory does not grow with image size.
  *
- * @param inputFile Input GIF file
+ * @param stream Pointer to input GIF stream
+ * @param reader Pointer to GIF reader structure
+ * @param bitMap Bit map matrix
+ * @param bitMapWriter Pointer to bit map writer structure - include logical screen size, position and offset
  * @return 0 on success, 1 on failure
  */
-int getCommentExt(FILE *inputFile) {
-
-//cout<<endl<<"Comment extension: skipped"<<endl;
+int getImageData(tGIFSTREAM *stream, tGIFREADER *reader, Mat &bitMap, tBITMAPWRITER *bitMapWriter) {
 
     u_int8_t Byte = 0;
-    int readRetVal;
+    tDICTIONARY dictionary;
+    tBITREADER *bitReader = &reader->bitReader;
+
+    // Get LZW size
+    if (readByteFromStream(stream, &Byte) != READ_WRITE_OK) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
+        return EXIT_FAILURE;
+    }
+    reader->lzwSize = (int)Byte;
+    reader->initLzwSize = reader->lzwSize;
+
+    // Read whole data sub block chain
+    if (joinSubBlocks(stream, bitReader))
+        return EXIT_FAILURE;
+
+    // Init dictionary, minimum code size is checked
+    if(initDictionary (&dictionary, reader)) {
+        return EXIT_FAILURE;
+    }
 
-    readRetVal = readByteFromFile(inputFile, &Byte);
-    if (readRetVal == READ_WRITE_ERR) {
-        fprintf(stderr, "%s", "Can not read input file.");
+    // Read first code - should be CC
+    if (bitReaderEmpty(bitReader, reader->lzwSize) || readCode(bitReader, reader->lzwSize) != (u_int32_t)dictionary.clearCode) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
         return EXIT_FAILURE;
     }
-    else if (readRetVal == END_OF_FILE) {
+
+    int backReference = bitMapWriter->scale == NULL && bitMapWriter->rowOutput == NULL;
+    return imageDataKernels[reader->initLzwSize - GIF_MIN_LZW_SIZE][bitMapWriter->outputMode][backReference](reader, &dictionary, bitMap, bitMapWriter);
+}
+
+/**
+ * Function read color table from GIF stream and save it into field
+ *
+ * @param stream Input GIF stream
+ * @param colorTable Color table field
+ * @param colorTableSize Size of color table
+ * @return 0 on success, 1 on failure
+ */
+int getColorTable(tGIFSTREAM *stream, tRGB colorTable [], int colorTableSize) {
+
+    const u_int8_t *colors = takeFromStream(stream, colorTableSize * 3);
+    if (colors == NULL) {
         fprintf(stderr, "%s", "Incorrect gif file.");
         return EXIT_FAILURE;
     }
-    else {
-        // get extension size
-        int extSize = (int)Byte;
-
-        // read application identifier and authentication code and block size (last readed byte)
-        for (int i = 0; i < extSize + 1; i++) {
-            readRetVal = readByteFromFile(inputFile, &Byte);
-            if (readRetVal == READ_WRITE_ERR) {
-                fprintf(stderr, "%s", "Can not read input file.");
-                return EXIT_FAILURE;
-            }
-            else if (readRetVal == END_OF_FILE) {
-                fprintf(stderr, "%s", "Incorrect gif file.");
-                return EXIT_FAILURE;
-            }
-            else {
-                // SKIP VALUES
-            }
-        }
 
-        // check last byte value
-        if (Byte != BLOCK_TERMINATOR) {
-            fprintf(stderr, "%s", "Incorrect gif file.");
-            return EXIT_FAILURE;
-        }
+    // Save colors
+    for (int i = 0; i < colorTableSize; i++) {
+        colorTable[i].red = colors[3*i];
+        colorTable[i].green = colors[3*i + 1];
+        colorTable[i].blue = colors[3*i + 2];
     }
 
     return EXIT_SUCCESS;
 }
 
 /**
- * Function read plain text extension, only skip values
+ * Function read application extension, only loop count of animation is saved
  *
- * @param inputFile Input GIF file
+ * @param stream Input GIF stream
+ * @param loopCount Pointer to loop count (0 = infinite), NULL to skip
  * @return 0 on success, 1 on failure
  */
-int getPlainTextExt(FILE *inputFile) {
+int getApplicationExt(tGIFSTREAM *stream, int *loopCount) {
+
+    u_int8_t Byte = 0;
+
+    // get extension size
+    if (readByteFromStream(stream, &Byte) != READ_WRITE_OK) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
+        return EXIT_FAILURE;
+    }
 
-//cout<<endl<<"Plain text extension: skipped"<<endl;
+    // fixed value
+    if (Byte != 11) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
+        return EXIT_FAILURE;
+    }
+
+    // application identifier and authentication code
+    const u_int8_t *identifier = takeFromStream(stream, Byte);
+    if (identifier == NULL) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
+        return EXIT_FAILURE;
+    }
 
-    fprintf(stderr, "%s", "Plain text extension is not supported.");
-    return EXIT_FAILURE;
+    // looping sub block - size 3, id 1, loop count
+    if (loopCount != NULL && Byte == 11 && (memcmp(identifier, "NETSCAPE2.0", 11) == 0 || memcmp(identifier, "ANIMEXTS1.0", 11) == 0)) {
+        if (stream->position + 4 <= stream->size && stream->data[stream->position] == 3 && (stream->data[stream->position + 1] & 0x07) == 1)
+            *loopCount = stream->data[stream->position + 2] + stream->data[stream->position + 3]*256;
+    }
+
+    // skip application data sub blocks
+    return skipSubBlocks(stream);
 }
 
 /**
- * Function read graphic control extension, only skip values
+ * Function read comment extension, only skip values
  *
- * @param inputFile Input GIF file
+ * @param stream Input GIF stream
  * @return 0 on success, 1 on failure
  */
-int getGraphicControlExt(FILE *inputFile) {
+int getCommentExt(tGIFSTREAM *stream) {
 
-    //fprintf(stderr, "%s", "Input file include graphic  extension, whitch is not supported.\n");
-    //return EXIT_FAILURE;
+    // comment is stored in data sub blocks
+    return skipSubBlocks(stream);
+}
 
+/**
+ * Function read plain text extension, only skip values
+ *
+ * @param stream Input GIF stream
+ * @return 0 on success, 1 on failure
+ */
+int getPlainTextExt(tGIFSTREAM *stream) {
 
     u_int8_t Byte = 0;
-    int readRetVal;
 
-    readRetVal = readByteFromFile(inputFile, &Byte);
-    if (readRetVal == READ_WRITE_ERR) {
-        fprintf(stderr, "%s", "Can not read input file.");
+    // get extension size
+    if (readByteFromStream(stream, &Byte) != READ_WRITE_OK) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
         return EXIT_FAILURE;
     }
-    else if (readRetVal == END_OF_FILE) {
+
+    // skip text grid and colors
+    if (takeFromStream(stream, Byte) == NULL) {
         fprintf(stderr, "%s", "Incorrect gif file.");
         return EXIT_FAILURE;
     }
-    else {
-        // get extension size
-        int extSize = (int)Byte;
 
-        // check extension size - fixed value
-        if (Byte != GRAPHICS_CONTROL_EXTENSION_SIZE) {
-            fprintf(stderr, "%s", "Incorrect gif file.");
-            return EXIT_FAILURE;
-        }
+    // text is not rendered, skip text data sub blocks
+    return skipSubBlocks(stream);
+}
 
-        // read application identifier and authentication code and block size (last readed byte)
-        for (int i = 0; i < extSize + 1; i++) {
-            readRetVal = readByteFromFile(inputFile, &Byte);
-            if (readRetVal == READ_WRITE_ERR) {
-                fprintf(stderr, "%s", "Can not read input file.");
-                return EXIT_FAILURE;
-            }
-            else if (readRetVal == END_OF_FILE) {
-                fprintf(stderr, "%s", "Incorrect gif file.");
-                return EXIT_FAILURE;
-            }
-            else {
-                // SKIP VALUES
-            }
-        }
+/**
+ * Function read graphic control extension - disposal method, delay and transparent color
+ *
+ * @param stream Input GIF stream
+ * @param control Pointer to graphic control struct
+ * @return 0 on success, 1 on failure
+ */
+int getGraphicControlExt(tGIFSTREAM *stream, tGRAPHIC_CONTROL *control) {
 
-        // check last byte value
-        if (Byte != BLOCK_TERMINATOR) {
-            fprintf(stderr, "%s", "Incorrect gif file.");
-            return EXIT_FAILURE;
-        }
+    // extension size, packed field, delay, transparent index and block terminator
+    const u_int8_t *extension = takeFromStream(stream, GRAPHICS_CONTROL_EXTENSION_SIZE + 2);
+    if (extension == NULL) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
+        return EXIT_FAILURE;
+    }
+
+    // check extension size - fixed value
+    if (extension[0] != GRAPHICS_CONTROL_EXTENSION_SIZE) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
+        return EXIT_FAILURE;
+    }
+
+    // check last byte value
+    if (extension[GRAPHICS_CONTROL_EXTENSION_SIZE + 1] != BLOCK_TERMINATOR) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
+        return EXIT_FAILURE;
     }
+
+    // Save control values for next image
+    control->disposalMethod = (u_int8_t)((extension[1] & GIFMASK_DISPOSAL_METHOD) >> 2);
+    control->userInputFlag = (u_int8_t)((extension[1] & GIFMASK_USER_INPUT) >> 1);
+    control->transparentColorFlag = (u_int8_t)(extension[1] & GIFMASK_TRANSPARENT_COLOR);
+    control->delayTime = (u_int16_t)(extension[2] + extension[3]*256);
+    control->transparentColorIndex = extension[4];
+
     return EXIT_SUCCESS;
 }
 
+/**
+ * Function set graphic control values used when image has no graphic control extension
+ *
+ * @param control Pointer to graphic control struct
+ */
+void initGraphicControl(tGRAPHIC_CONTROL *control) {
+
+    control->disposalMethod = DISPOSAL_NONE;
+    control->userInputFlag = 0;
+    control->transparentColorFlag = 0;
+    control->delayTime = 0;
+    control->transparentColorIndex = 0;
+}
+
 /**
  * Function read image description and save image property into struct
  *
- * @param inputFile Input GIF file
+ * @param stream Input GIF stream
  * @param imageDescriptor Struct for image property
  * @return 0 on success, 1 on failure
  */
-int getImageDescriptor(FILE *gifFile, tIMAGE_DESCRIPTOR *imageDescriptor) {
-    u_int8_t Byte = 0;
-    int readRetVal;
-    int tmp = 0;
+int getImageDescriptor(tGIFSTREAM *stream, tIMAGE_DESCRIPTOR *imageDescriptor) {
 
-//    cout<<endl<<"Image descriptor:"<<endl;
-
-    // Get image descriptor block
-    for (int i = 0; i < IMAGE_DESCRIPTOR_SIZE - 1; i++) {
-        readRetVal = readByteFromFile(gifFile, &Byte);
-        if (readRetVal == READ_WRITE_ERR) {
-            fprintf(stderr, "%s", "Can not read input file.");
-            return EXIT_FAILURE;
-        }
-        else if (readRetVal == END_OF_FILE) {
-            fprintf(stderr, "%s", "Incorrect gif file.");
-            return EXIT_FAILURE;
-        }
-        else {
-            // Save pic property
-            switch (i) {
-                case (0):
-                        imageDescriptor->leftPosLowByte = Byte;
-                        break;
-                case (1):
-                        imageDescriptor->leftPosHighByte = Byte;
-                        break;
-                case (2):
-                        imageDescriptor->topPosLowByte = Byte;
-                        break;
-                case (3):
-                                    imageDescriptor->topPosHighByte = Byte;
-                        break;
-                case (4):
-                        imageDescriptor->widthLowByte = Byte;
-                        break;
-                case (5):
-                        imageDescriptor->widthHighByte = Byte;
-                        break;
-                case (6):
-                        imageDescriptor->heightLowByte = Byte;
-                        break;
-                case (7):
-                        imageDescriptor->heightHighByte = Byte;
-                        break;
-                case (8):
-                        imageDescriptor->localColorTableFlag = (u_int8_t)((Byte & GIFMASK_LOCAL_COLOR_PALETTE) >> 7 );
-                        imageDescriptor->interlaceFlag = (u_int8_t)((Byte & GIFMASK_LOCAL_INTERLACE) >> 6);
-                        imageDescriptor->sortFlag = (u_int8_t)((Byte & GIFMASK_LOCAL_COLOR_PALETTE_SORT) >> 5);
-                        tmp = 2;
-                        for (int j = 0; j < (int)(Byte & GIFMASK_LOCAL_COLOR_PALETTE_SIZE); j++)
-                            tmp = tmp*2;
-                        imageDescriptor->localColorTableSize = tmp;
-                        break;
-                }
-        }
+    // Get image descriptor block (without introducer)
+    const u_int8_t *descriptor = takeFromStream(stream, IMAGE_DESCRIPTOR_SIZE - 1);
+    if (descriptor == NULL) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
+        return EXIT_FAILURE;
     }
 
+    // Save pic property
+    imageDescriptor->leftPosLowByte = descriptor[0];
+    imageDescriptor->leftPosHighByte = descriptor[1];
+    imageDescriptor->topPosLowByte = descriptor[2];
+    imageDescriptor->topPosHighByte = descriptor[3];
+    imageDescriptor->widthLowByte = descriptor[4];
+    imageDescriptor->widthHighByte = descriptor[5];
+    imageDescriptor->heightLowByte = descriptor[6];
+    imageDescriptor->heightHighByte = descriptor[7];
+    imageDescriptor->localColorTableFlag = (u_int8_t)((descriptor[8] & GIFMASK_LOCAL_COLOR_PALETTE) >> 7 );
+    imageDescriptor->interlaceFlag = (u_int8_t)((descriptor[8] & GIFMASK_LOCAL_INTERLACE) >> 6);
+    imageDescriptor->sortFlag = (u_int8_t)((descriptor[8] & GIFMASK_LOCAL_COLOR_PALETTE_SORT) >> 5);
+    imageDescriptor->localColorTableSize = 2 << (descriptor[8] & GIFMASK_LOCAL_COLOR_PALETTE_SIZE);
+
     // get data block size in pixels
     imageDescriptor->sizeInPixels = (imageDescriptor->widthHighByte*256 + imageDescriptor->widthLowByte) * (imageDescriptor->heightHighByte*256 + imageDescriptor->heightLowByte);
 
-//cout<<"	Left position: 		 "<<(imageDescriptor->leftPosHighByte*255 + imageDescriptor->leftPosLowByte)<<endl;
-//cout<<"	Top position:  		 "<<(imageDescriptor->topPosHighByte*255 + imageDescriptor->topPosLowByte)<<endl;
-//cout<<"	Width:         		 "<<(imageDescriptor->widthHighByte*255 + imageDescriptor->widthLowByte)<<endl;
-//cout<<"	Height:        		 "<<(imageDescriptor->heightHighByte*255 + imageDescriptor->heightLowByte)<<endl;
-//if (imageDescriptor->localColorTableFlag)
-//    cout<<"	Local color table:       yes"<<endl;
-//else
-//    cout<<"	Local color table:       no"<<endl;
-//cout<<"	Local color size :       "<<(imageDescriptor->localColorTableSize)<<endl;
-//cout<<"	Block size in pix :      "<<(imageDescriptor->sizeInPixels)<<endl<<endl;
     return EXIT_SUCCESS;
 }
 
 /**
  * Function check GIF file version, supported is 89a
  *
- * @param inputFile Input GIF file
+ * @param stream Input GIF stream
  * @return 0 on success (supported GIF version), 1 on failure
  */
-int checkGifVersion(FILE *gifFile) {
-//cout<<endl<<"Gif version: ";
-    u_int8_t Byte = 0;
-    int readRetVal;
+int checkGifVersion(tGIFSTREAM *stream) {
 
-    for (int i = 0; i < 6; i++) {
-        readRetVal = readByteFromFile(gifFile, &Byte);
-        if (readRetVal == READ_WRITE_ERR) {
-            fprintf(stderr, "%s", "Can not read input file.");
-            return EXIT_FAILURE;
-        }
-        else if (readRetVal == END_OF_FILE) {
-            fprintf(stderr, "%s", "Incorrect gif file.");
-            return EXIT_FAILURE;
-        }
-        else {
-            switch (i) {
-                case (0): // G
-                        if (Byte != 0x47) {
-                            fprintf(stderr, "%s", "Incorrect gif file.");
-                            return EXIT_FAILURE;
-                        }
-                        break;
-                case (1):// I
-                        if (Byte != 0x49) {
-                            fprintf(stderr, "%s", "Incorrect gif file.");
-                            return EXIT_FAILURE;
-                        }
-                        break;
-                case (2):// F
-                        if (Byte != 0x46) {
-                            fprintf(stderr, "%s", "Incorrect gif file.");
-                            return EXIT_FAILURE;
-                        }
-                        break;
-                case (3):// 8
-                        if (Byte != 0x38) {
-                            fprintf(stderr, "%s", "Incorrect gif file.");
-                            return EXIT_FAILURE;
-                        }
-                        break;
-                case (4):// 9
-                        if (Byte != 0x39) {
-                            fprintf(stderr, "%s", "Incorrect gif file.");
-                            return EXIT_FAILURE;
-                        }
-                        break;
-                case (5):// a
-                        if (Byte != 0x61) {
-                            fprintf(stderr, "%s", "Incorrect gif file.");
-                            return EXIT_FAILURE;
-                        }
-                        break;
-            }
-        }
+    const u_int8_t *signature = takeFromStream(stream, 6);
+
+    // GIF89a
+    if (signature == NULL || memcmp(signature, "GIF89a", 6) != 0) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
+        return EXIT_FAILURE;
     }
-//cout<<"GIF89a"<<endl;
+
     return EXIT_SUCCESS;
 }
 
 /**
  * Function read GIF header and save it into pic property struct
  *
- * @param gifFile Input GIF file
+ * @param stream Input GIF stream
  * @param pic Picture property struct
  * @return 0 on success (supported GIF version), 1 on failure
  */
-int parseGifHeader(FILE *gifFile, tPIC_PROPERTY *pic) {
-//cout<<endl<<"GIF header: "<<endl;
+int parseGifHeader(tGIFSTREAM *stream, tPIC_PROPERTY *pic) {
+
+    const u_int8_t *header = takeFromStream(stream, LOGICAL_SCREEN_DESCRIPTOR_SIZE);
+    if (header == NULL) {
+        fprintf(stderr, "%s", "Incorrect gif file.");
+        return EXIT_FAILURE;
+    }
+
+    pic->widthInPixLowByte = header[0];
+    pic->widthInPixHighByte = header[1];
+    pic->heightInPixLowByte = header[2];
+    pic->heightInPixHighByte = header[3];
+    pic->globalColorTable = (u_int8_t)((header[4] & GIFMASK_GLOBAL_COLOR_PALETTE) >> 7 );
+    pic->bitsPerPixel = ((u_int8_t)(((header[4] & GIFMASK_COLOR_BITS_PER_PIXEL) >> 4 )) + 1);
+    pic->colorTableSorted = (u_int8_t)((header[4] & GIFMASK_COLOR_PALETTE_SORT) >> 3);
+    pic->colorTableLong = 2 << (header[4] & GIFMASK_GLOBAL_COLOR_PALETTE_SIZE);
+    pic->backgroundColor = header[5];
+    pic->pixelAspectRatio = header[6];
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Function read GIF header, logical screen descriptor and global color table
+ *
+ * @param stream Input GIF stream
+ * @param reader Pointer to GIF reader structure
+ * @param pic Picture property struct
+ * @param globalColorTable Global color table
+ * @return 0 on success, 1 on failure
+ */
+int getGifHeader(tGIFSTREAM *stream, tGIFREADER *reader, tPIC_PROPERTY *pic, tRGB globalColorTable []) {
+
+    // Check gif version
+    if (checkGifVersion(stream))
+        return EXIT_FAILURE;
+
+    // Parse gif header
+    if (parseGifHeader(stream, pic))
+        return EXIT_FAILURE;
+
+    // Get global table
+    if (pic->globalColorTable) {
+        reader->activeColorTableSize = pic->colorTableLong;
+        if (getColorTable(stream, globalColorTable, pic->colorTableLong))
+            return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Function read extension blocks until next image descriptor or end of file,
+ * graphic control extension is saved for next image
+ *
+ * @param stream Input GIF stream
+ * @param control Pointer to graphic control struct
+ * @param loopCount Pointer to loop count from application extension, NULL to skip
+ * @param introducer Found block introducer (IMAGE_DESCRIPTOR_INTRODUCER or GIF_END_OF_FILE)
+ * @return 0 on success, 1 on failure
+ */
+int getNextBlock(tGIFSTREAM *stream, tGRAPHIC_CONTROL *control, int *loopCount, u_int8_t *introducer) {
+
     u_int8_t Byte = 0;
-    int readRetVal;
-    int tmp = 0;
 
-    for (int i = 0; i < 7; i++) {
-        readRetVal = readByteFromFile(gifFile, &Byte);
-        if (readRetVal == READ_WRITE_ERR) {
-            fprintf(stderr, "%s", "Can not read input file.");
+    while (1) {
+
+        // Get block introducer from gif
+        if (readByteFromStream(stream, &Byte) != READ_WRITE_OK)
             return EXIT_FAILURE;
+
+        // Image or end of file
+        if (Byte == GIF_END_OF_FILE || Byte == IMAGE_DESCRIPTOR_INTRODUCER) {
+            *introducer = Byte;
+            return EXIT_SUCCESS;
         }
-        else if (readRetVal == END_OF_FILE) {
+        else if (Byte != EXTENSION_INTRODUCER) {
             fprintf(stderr, "%s", "Incorrect gif file.");
             return EXIT_FAILURE;
         }
-        else {
-            switch (i) {
-                case (0):
-                        pic->widthInPixLowByte = Byte;
-                        break;
-                case (1):
-                        pic->widthInPixHighByte = Byte;
-                        break;
-                case (2):
-                        pic->heightInPixLowByte = Byte;
-                        break;
-                case (3):
-                        pic->heightInPixHighByte = Byte;
-                        break;
-                case (4):
-                        pic->globalColorTable = (u_int8_t)((Byte & GIFMASK_GLOBAL_COLOR_PALETTE) >> 7 );
-                        pic->bitsPerPixel = ((u_int8_t)(((Byte & GIFMASK_COLOR_BITS_PER_PIXEL) >> 4 )) + 1);
-
-                    /*	if (pic->bitsPerPixel != 8) {
-                            fprintf(stderr, "%s", "Unsupported color width.");
-                            return EXIT_FAILURE;
-                        }*/
-                        pic->colorTableSorted = (u_int8_t)((Byte & GIFMASK_COLOR_PALETTE_SORT) >> 3);
-                        tmp = 2;
-                        for (int j = 0; j < (int)(Byte & GIFMASK_GLOBAL_COLOR_PALETTE_SIZE); j++)
-                            tmp = tmp*2;
-                        pic->colorTableLong = tmp;
-                        break;
-                case (5):
-                        pic->backgroundColor = Byte;
-                        break;
-                case (6):
-                        pic->pixelAspectRatio = Byte;
-                        break;
-            }
+
+        // Get extension label
+        if (readByteFromStream(stream, &Byte) != READ_WRITE_OK)
+            return EXIT_FAILURE;
+
+        switch (Byte) {
+            case(APPLICATION_EXTENSION_LABEL):	// Application ext.
+                if (getApplicationExt(stream, loopCount))
+                    return EXIT_FAILURE;
+                break;
+            case(COMMENT_EXTENSION_LABEL):		// Comment ext.
+                if (getCommentExt(stream))
+                    return EXIT_FAILURE;
+                break;
+            case(PLAINTEXT_EXTENSION_LABEL):	// Plain text ext.
+                if (getPlainTextExt(stream))
+                    return EXIT_FAILURE;
+                break;
+            case(GRAPHICS_CONTROL_LABEL):		// Graphic control ext.
+                if (getGraphicControlExt(stream, control))
+                    return EXIT_FAILURE;
+                break;
+            default:
+                fprintf(stderr, "%s", "Incorrect gif file.");
+                return EXIT_FAILURE;
         }
     }
+}
 
+/**
+ * Function read image descriptor and color table, init bit map writer for image
+ * (BGR output, no transparent color - caller sets transparent color of graphic control)
+ *
+ * @param stream Input GIF stream
+ * @param reader Pointer to GIF reader structure
+ * @param pic Picture property struct
+ * @param globalColorTable Global color table
+ * @param localColorTable Local color table
+ * @param imageDescriptor Pointer to image descriptor
+ * @param bitMapWriter Pointer to bit map writer structure
+ * @return 0 on success, 1 on failure
+ */
+int getImageHeader(tGIFSTREAM *stream, tGIFREADER *reader, tPIC_PROPERTY *pic, tRGB globalColorTable [], tRGB localColorTable [], tIMAGE_DESCRIPTOR *imageDescriptor, tBITMAPWRITER *bitMapWriter) {
 
-//cout<<"	Width:         		 "<<(pic->widthInPixHighByte*255 + pic->widthInPixLowByte)<<endl;
-//cout<<"	Height:        		 "<<(pic->heightInPixHighByte*255 + pic->heightInPixLowByte)<<endl;
-//cout<<"	Bits per color channel:	 8"<<endl;
-//if (pic->globalColorTable)
-//    cout<<"	Global color table:      yes"<<endl;
-//else
-//    cout<<"	Global color table:      no"<<endl;
-//cout<<"	Global color size :      "<<pic->colorTableLong<<endl;
+    // Read image descriptor
+    if (getImageDescriptor(stream, imageDescriptor))
+        return EXIT_FAILURE;
+
+    // Init bmpWritter
+    bitMapWriter->actualColumn = imageDescriptor->leftPosHighByte*256 + imageDescriptor->leftPosLowByte;
+    bitMapWriter->actualRow = imageDescriptor->topPosHighByte*256 + imageDescriptor->topPosLowByte;
+    bitMapWriter->actualWidth = imageDescriptor->widthHighByte*256 + imageDescriptor->widthLowByte;
+    bitMapWriter->actualHeight = imageDescriptor->heightHighByte*256 + imageDescriptor->heightLowByte;
+    bitMapWriter->actualX = bitMapWriter->actualColumn;
+    bitMapWriter->actualY = bitMapWriter->actualRow;
+    bitMapWriter->outputMode = GIF_OUTPUT_BGR;
+    bitMapWriter->rowBuffer = reader->rowBuffer;
+    bitMapWriter->transparentIndex = NO_TRANSPARENT_COLOR;
+    bitMapWriter->writtenPixels = 0;
+    bitMapWriter->interlaced = imageDescriptor->interlaceFlag;
+    bitMapWriter->interlacePass = 0;
+    bitMapWriter->passLimit = GIF_INTERLACE_PASSES;
+    bitMapWriter->scale = NULL;
+    bitMapWriter->rowOutput = NULL;
+
+    // Set and read color table
+    if (imageDescriptor->localColorTableFlag) {
+        reader->activeColorTable = localColorTable;
+        reader->activeColorTableSize = imageDescriptor->localColorTableSize;
+        if (getColorTable(stream, localColorTable, imageDescriptor->localColorTableSize))
+            return EXIT_FAILURE;
+    }
+    else {
+        reader->activeColorTable = globalColorTable;
+        reader->activeColorTableSize = pic->colorTableLong;
+    }
+    initPaletteTable(bitMapWriter->paletteTable, reader->activeColorTable);
 
+    reader->dataBlockSize = imageDescriptor->sizeInPixels;
     return EXIT_SUCCESS;
 }
 
+/**
+ * Function build nearest neighbour mapping of logical screen area into bit map,
+ * every bit map pixel takes screen pixel under its center. Pixels outside of area
+ * are not mapped.
+ *
+ * @param scale Pointer to scale struct
+ * @param width Logical screen width
+ * @param height Logical screen height
+ * @param area Mapped area of logical screen
+ * @param scaledWidth Bit map width (at most area width)
+ * @param scaledHeight Bit map height (at most area height)
+ * @param arena Arena for mapping tables (released by arena reset), NULL for heap
+ * @return 0 on success, 1 on failure
+ */
+int initBitMapScale(tBITMAPSCALE *scale, u_int32_t width, u_int32_t height, Rect area, u_int32_t scaledWidth, u_int32_t scaledHeight, tGIFARENA *arena) {
+
+    scale->width = width;
+    scale->height = height;
+    scale->arena = arena;
+    if (arena != NULL) {
+        scale->columnMap = (u_int32_t *)takeGifArena(arena, scaledWidth * sizeof(u_int32_t));
+        scale->columnStart = (u_int32_t *)takeGifArena(arena, (width + 1) * sizeof(u_int32_t));
+        scale->rowStart = (u_int32_t *)takeGifArena(arena, (height + 1) * sizeof(u_int32_t));
+        scale->rowBuffer = (u_int8_t *)takeGifArena(arena, scaledWidth ? scaledWidth : 1);
+    }
+    else {
+        scale->columnMap = (u_int32_t *)malloc(scaledWidth * sizeof(u_int32_t));
+        scale->columnStart = (u_int32_t *)malloc((width + 1) * sizeof(u_int32_t));
+        scale->rowStart = (u_int32_t *)malloc((height + 1) * sizeof(u_int32_t));
+        scale->rowBuffer = (u_int8_t *)malloc(scaledWidth ? scaledWidth : 1);
+    }
+
+    if (scale->columnMap == NULL || scale->columnStart == NULL || scale->rowStart == NULL || scale->rowBuffer == NULL) {
+        freeBitMapScale(scale);
+        return EXIT_FAILURE;
+    }
+
+    // Sampled screen column of every bit map column
+    for (u_int32_t x = 0; x < scaledWidth; x++)
+        scale->columnMap[x] = area.x + (u_int32_t)(((u_int64_t)2 * x + 1) * area.width / (2 * (u_int64_t)scaledWidth));
+
+    // First bit map column (row) which samples given or further screen column (row)
+    u_int32_t x = 0;
+    for (u_int32_t column = 0; column <= width; column++) {
+        while (x < scaledWidth && scale->columnMap[x] < column)
+            x++;
+        scale->columnStart[column] = x;
+    }
+
+    u_int32_t y = 0;
+    for (u_int32_t row = 0; row <= height; row++) {
+        while (y < scaledHeight && area.y + (u_int32_t)(((u_int64_t)2 * y + 1) * area.height / (2 * (u_int64_t)scaledHeight)) < row)
+            y++;
+        scale->rowStart[row] = y;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Function free mapping of logical screen into smaller bit map, arena tables are left
+ * for arena reset
+ *
+ * @param scale Pointer to scale struct
+ */
+void freeBitMapScale(tBITMAPSCALE *scale) {
+
+    if (scale->arena == NULL) {
+        free(scale->columnMap);
+        free(scale->columnStart);
+        free(scale->rowStart);
+        free(scale->rowBuffer);
+    }
+    scale->columnMap = NULL;
+    scale->columnStart = NULL;
+    scale->rowStart = NULL;
+    scale->rowBuffer = NULL;
+}
+
+/**
+ * Function allocate reader buffers
+ *
+ * @param reader Pointer to GIF reader structure
+ * @return 0 on success, 1 on failure
+ */
+int initGifReader(tGIFREADER *reader) {
+
+    // Row buffer holds color indexes of one image row
+    reader->rowBuffer = (u_int8_t *)malloc(GIF_MAX_IMAGE_WIDTH);
+    if (reader->rowBuffer == NULL)
+        return EXIT_FAILURE;
+    reader->allocations = 1;
+
+    // Bit reader buffer and decoded output are shared by all image blocks
+    initBitReader(&reader->bitReader);
+    reader->indexBuffer = NULL;
+    reader->indexBufferSize = 0;
+
+    reader->lzwSize = 8;
+    reader->activeColorTable = NULL;
+    reader->activeColorTableSize = 0;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Function free reader buffers
+ *
+ * @param reader Pointer to GIF reader structure
+ */
+void freeGifReader(tGIFREADER *reader) {
+
+    freeBitReader(&reader->bitReader);
+    free(reader->rowBuffer);
+    free(reader->indexBuffer);
+    reader->rowBuffer = NULL;
+    reader->indexBuffer = NULL;
+    reader->indexBufferSize = 0;
+}
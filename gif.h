@@ -10,16 +10,23 @@
 #ifndef GIF_H_
 #define GIF_H_
 
-int checkGifVersion(FILE *gifFile);
-int parseGifHeader(FILE *gifFile, tPIC_PROPERTY *pic);
-int getColorTable(FILE *gifFile, tRGB globalColorTable [], int colorTableSize);
-int getGraphicControlExt(FILE *inputFile);
-int getPlainTextExt(FILE *inputFile);
-int getApplicationExt(FILE *inputFile);
-int getCommentExt(FILE *inputFile);
-int getImageDescriptor(FILE *inputFile, tIMAGE_DESCRIPTOR *imageDescriptor);
-void processColorList(tDIC_ITEM *list, Mat &bitMap, tRGB *colorTable, tBITMAPWRITER *bitMapWriter);
-void processColor(int color, Mat &bitMap, tRGB *colorTable, tBITMAPWRITER *bitMapWriter);
-int getImageData(FILE *inputFile, tGIFREADER *reader, Mat &bitMap, tBITMAPWRITER *bitMapWriter);
+int checkGifVersion(tGIFSTREAM *stream);
+int parseGifHeader(tGIFSTREAM *stream, tPIC_PROPERTY *pic);
+int getColorTable(tGIFSTREAM *stream, tRGB globalColorTable [], int colorTableSize);
+int getGraphicControlExt(tGIFSTREAM *stream, tGRAPHIC_CONTROL *control);
+void initGraphicControl(tGRAPHIC_CONTROL *control);
+int getPlainTextExt(tGIFSTREAM *stream);
+int getApplicationExt(tGIFSTREAM *stream, int *loopCount);
+int getCommentExt(tGIFSTREAM *stream);
+int getImageDescriptor(tGIFSTREAM *stream, tIMAGE_DESCRIPTOR *imageDescriptor);
+void drawIndexPlane(const Mat &indices, u_int32_t pixels, Mat &bitMap, tBITMAPWRITER *bitMapWriter);
+int getImageData(tGIFSTREAM *stream, tGIFREADER *reader, Mat &bitMap, tBITMAPWRITER *bitMapWriter);
+int getGifHeader(tGIFSTREAM *stream, tGIFREADER *reader, tPIC_PROPERTY *pic, tRGB globalColorTable []);
+int getNextBlock(tGIFSTREAM *stream, tGRAPHIC_CONTROL *control, int *loopCount, u_int8_t *introducer);
+int getImageHeader(tGIFSTREAM *stream, tGIFREADER *reader, tPIC_PROPERTY *pic, tRGB globalColorTable [], tRGB localColorTable [], tIMAGE_DESCRIPTOR *imageDescriptor, tBITMAPWRITER *bitMapWriter);
+int initBitMapScale(tBITMAPSCALE *scale, u_int32_t width, u_int32_t height, Rect area, u_int32_t scaledWidth, u_int32_t scaledHeight, tGIFARENA *arena);
+void freeBitMapScale(tBITMAPSCALE *scale);
+int initGifReader(tGIFREADER *reader);
+void freeGifReader(tGIFREADER *reader);
 
 #endif /* GIF_H_ */
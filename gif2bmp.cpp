@@ -17,343 +17,14 @@
 #include <errno.h>
 #include "gif2bmp.h"
 #include "gif.h"
+#include "gifindex.h"
 #include "bmp.h"
+#include "bitreader.h"
+#include "gifstream.h"
+#include "gifarena.h"
+#include "palette.h"
 #include "constant.h"
 
-/**
- * Function read byte from input file
- *
- * @param ptr_file Pointer to input file
- * @param Byte Pointer to byte buffer 
- * @return status code READ_WRITE_OK on success, READ_WRITE_ERR on failure and END_OF_FILE when EOF is readed
- */
-u_int8_t readByteFromFile(FILE *ptr_file, u_int8_t *Byte){
-
-	// Read byte from input file
-	if (fread (Byte, sizeof(u_int8_t), 1, ptr_file)) {
-		return READ_WRITE_OK;
-	}
-	else {
-		if (ferror(ptr_file))
-			return READ_WRITE_ERR;
-		else
-			return END_OF_FILE;
-	}
-}
-
-/**
- * Function reverse bits in byte
- *
- * @param byte Byte to reverse
- * @return reversed byte
- */
-
-u_int8_t reverseByte(u_int8_t byte)
-{
-    int i;
-    u_int8_t tmp = 0;
-
-    for ( i = 0 ; i < 8 ; i ++)
-    {
-    	tmp <<= 1;
-    	tmp |=  ( (byte & (1 << i)) >> i);
-    }
-    return tmp;
-}
-
-/**
- * Function reverse bits in double world
- *
- * @param dword Souble world to reverse
- * @return reversed double world
- */
-u_int32_t reverseDWord(u_int32_t dword)
-{
-    int i;
-    u_int32_t tmp = 0;
-
-    for ( i = 0 ; i < 32 ; i ++)
-    {
-    	tmp <<= 1;
-    	tmp |=  ( (dword & (1 << i)) >> i);
-    }
-    return tmp;
-}
-
-/**
- * Function read n (lzw size) bits from input file
- *
- * @param gifFile Pointer to input file
- * @param reader Reader struct
- * @param readedBits Pointer to readed value buffer
- * @param u_int8_t Current block status
- * @return status code EXIT_FAILURE on failure and EXIT_SUCCESS on success
- */
-u_int8_t readBitsStreamFromFile (FILE *gifFile, tGIFREADER *reader, u_int32_t *readedBits, u_int8_t subBlockState) {
-
-	u_int8_t readRetVal;
-
-	// Init return value
-	*readedBits = 0;
-
-	// Init reader - read bytes to internal buffer
-
-	if (reader->usedBitsFromByte1LastTime == -1) {
-		reader->usedBitsFromByte1LastTime = 0;
-
-		// Byte 1
-		if (reader->BytesToReadInSubBlock != 0) {
-			readRetVal = readByteFromFile(gifFile, &reader->Byte1);
-			reader->BytesToReadInSubBlock--;
-			reader->Byte1ValidFlag = 1;
-			if (readRetVal == READ_WRITE_ERR) {
-				fprintf(stderr, "%s", "Can not read input file.");
-				return EXIT_FAILURE;
-			}
-			else if (readRetVal == END_OF_FILE) {
-				fprintf(stderr, "%s", "Incorrect input file.");
-				return EXIT_FAILURE;
-			}
-		}
-		else
-			reader->Byte1ValidFlag = 0;
-
-		// Byte 2
-		if (reader->BytesToReadInSubBlock != 0) {
-			readRetVal = readByteFromFile(gifFile, &reader->Byte2);
-			reader->BytesToReadInSubBlock--;
-			reader->Byte2ValidFlag = 1;
-			if (readRetVal == READ_WRITE_ERR) {
-				fprintf(stderr, "%s", "Can not read input file.");
-				return EXIT_FAILURE;
-			}
-			else if (readRetVal == END_OF_FILE) {
-				fprintf(stderr, "%s", "Incorrect input file.");
-				return EXIT_FAILURE;
-			}
-		}
-		else
-			reader->Byte2ValidFlag = 0;
-
-		// Byte 3
-		if (reader->BytesToReadInSubBlock != 0) {
-			readRetVal = readByteFromFile(gifFile, &reader->Byte3);
-			reader->BytesToReadInSubBlock--;
-			reader->Byte3ValidFlag = 1;
-			if (readRetVal == READ_WRITE_ERR) {
-				fprintf(stderr, "%s", "Can not read input file.");
-				return EXIT_FAILURE;
-			}
-			else if (readRetVal == END_OF_FILE) {
-				fprintf(stderr, "%s", "Incorrect input file.");
-				return EXIT_FAILURE;
-			}
-		}
-		else
-			reader->Byte3ValidFlag = 0;
-	}
-
-	// Start new subblock, read missing bytes
-	if (subBlockState == NEW_SUBBLOCK) {
-		if (reader->Byte1ValidFlag != 1) {
-			if (reader->BytesToReadInSubBlock != 0) {
-				readRetVal = readByteFromFile(gifFile, &reader->Byte1);
-				reader->BytesToReadInSubBlock--;
-				reader->Byte1ValidFlag = 1;
-				if (readRetVal == READ_WRITE_ERR) {
-					fprintf(stderr, "%s", "Can not read input file.");
-					return EXIT_FAILURE;
-				}
-				else if (readRetVal == END_OF_FILE) {
-					fprintf(stderr, "%s", "Incorrect input file.");
-					return EXIT_FAILURE;
-				}
-			}
-		}
-		else
-			reader->Byte1ValidFlag = 0;
-		if (reader->Byte2ValidFlag != 1) {
-			if (reader->BytesToReadInSubBlock != 0) {
-				readRetVal = readByteFromFile(gifFile, &reader->Byte2);
-				reader->BytesToReadInSubBlock--;
-				reader->Byte2ValidFlag = 1;
-				if (readRetVal == READ_WRITE_ERR) {
-					fprintf(stderr, "%s", "Can not read input file.");
-					return EXIT_FAILURE;
-				}
-				else if (readRetVal == END_OF_FILE) {
-					fprintf(stderr, "%s", "Incorrect input file.");
-					return EXIT_FAILURE;
-				}
-			}
-		}
-		else
-			reader->Byte2ValidFlag = 0;
-
-		if (reader->Byte3ValidFlag != 1) {
-			if (reader->BytesToReadInSubBlock != 0) {
-				readRetVal = readByteFromFile(gifFile, &reader->Byte3);
-				reader->BytesToReadInSubBlock--;
-				reader->Byte3ValidFlag = 1;
-				if (readRetVal == READ_WRITE_ERR) {
-					fprintf(stderr, "%s", "Can not read input file.");
-					return EXIT_FAILURE;
-				}
-				else if (readRetVal == END_OF_FILE) {
-					fprintf(stderr, "%s", "Incorrect input file.");
-					return EXIT_FAILURE;
-				}
-			}
-		}
-		else
-			reader->Byte3ValidFlag = 0;
-	}
-
-	// Create value from bytes
-	(*readedBits) = (((u_int32_t)reverseByte(reader->Byte1)) << (24 + reader->usedBitsFromByte1LastTime));
-	(*readedBits) = (*readedBits) | (((u_int32_t)reverseByte(reader->Byte2)) << (16 + reader->usedBitsFromByte1LastTime));
-	(*readedBits) = (*readedBits) | (((u_int32_t)reverseByte(reader->Byte3)) << (8 + reader->usedBitsFromByte1LastTime));
-
-	// Update used bits from first and second internal buffered bytes and read new values to internal buffer
-
-	int bitsPerBytes2_3 = reader->lzwSize + reader->usedBitsFromByte1LastTime - 8;
-	if (bitsPerBytes2_3 >= 8) {
-
-		reader->usedBitsFromByte1LastTime = bitsPerBytes2_3 - 8;
-		reader->Byte1 = reader->Byte3;
-		reader->Byte1ValidFlag = reader->Byte3ValidFlag;
-
-		if (reader->BytesToReadInSubBlock != 0) {
-			readRetVal = readByteFromFile(gifFile, &reader->Byte2);
-			reader->BytesToReadInSubBlock--;
-			reader->Byte2ValidFlag = 1;
-			if (readRetVal == READ_WRITE_ERR) {
-				fprintf(stderr, "%s", "Can not read input file.");
-				return EXIT_FAILURE;
-			}
-			else if (readRetVal == END_OF_FILE) {
-				fprintf(stderr, "%s", "Incorrect input file.");
-				return EXIT_FAILURE;
-			}
-		}
-		else
-			reader->Byte2ValidFlag = 0;
-
-		if (reader->BytesToReadInSubBlock != 0) {
-			readRetVal = readByteFromFile(gifFile, &reader->Byte3);
-			reader->BytesToReadInSubBlock--;
-			reader->Byte3ValidFlag = 1;
-			if (readRetVal == READ_WRITE_ERR) {
-				fprintf(stderr, "%s", "Can not read input file.");
-				return EXIT_FAILURE;
-			}
-			else if (readRetVal == END_OF_FILE) {
-				fprintf(stderr, "%s", "Incorrect input file.");
-				return EXIT_FAILURE;
-			}
-		}
-		else
-			reader->Byte3ValidFlag = 0;
-	}
-	// Get only one new byte
-	else if(bitsPerBytes2_3 > 0) {
-		reader->usedBitsFromByte1LastTime = bitsPerBytes2_3;
-		reader->Byte1 = reader->Byte2;
-		reader->Byte1ValidFlag = reader->Byte2ValidFlag;
-		reader->Byte2 = reader->Byte3;
-		reader->Byte2ValidFlag = reader->Byte3ValidFlag;
-
-		if (reader->BytesToReadInSubBlock != 0) {
-			readRetVal = readByteFromFile(gifFile, &reader->Byte3);
-			reader->BytesToReadInSubBlock--;
-			reader->Byte3ValidFlag = 1;
-			if (readRetVal == READ_WRITE_ERR) {
-				fprintf(stderr, "%s", "Can not read input file.");
-				return EXIT_FAILURE;
-			}
-			else if (readRetVal == END_OF_FILE) {
-				fprintf(stderr, "%s", "Incorrect input file.");
-				return EXIT_FAILURE;
-			}
-		}
-		else
-			reader->Byte3ValidFlag = 0;
-	}
-	else {
-		if(reader->lzwSize == 8) {
-			reader->usedBitsFromByte1LastTime = bitsPerBytes2_3;
-			reader->Byte1 = reader->Byte2;
-			reader->Byte1ValidFlag = reader->Byte2ValidFlag;
-			reader->Byte2 = reader->Byte3;
-			reader->Byte2ValidFlag = reader->Byte3ValidFlag;
-
-			if (reader->BytesToReadInSubBlock != 0) {
-				readRetVal = readByteFromFile(gifFile, &reader->Byte3);
-				reader->BytesToReadInSubBlock--;
-				reader->Byte3ValidFlag = 1;
-				if (readRetVal == READ_WRITE_ERR) {
-					fprintf(stderr, "%s", "Can not read input file.");
-					return EXIT_FAILURE;
-				}
-				else if (readRetVal == END_OF_FILE) {
-					fprintf(stderr, "%s", "Incorrect input file.");
-					return EXIT_FAILURE;
-				}
-			}
-			else
-				reader->Byte3ValidFlag = 0;
-		}
-        else
-            reader->usedBitsFromByte1LastTime = 8 + bitsPerBytes2_3;
-	}
-
-	// Apply current mask, whitch is set by current lzw size to readed value 
-	switch (reader->lzwSize) {
-		case(2):
-				(*readedBits) = (reverseDWord(*readedBits & _2_BIT_MASK));
-				break;
-		case(3):
-				(*readedBits) = (reverseDWord(*readedBits & _3_BIT_MASK));
-				break;
-		case(4):
-				(*readedBits) = (reverseDWord(*readedBits & _4_BIT_MASK));
-				break;
-		case(5):
-				(*readedBits) = (reverseDWord(*readedBits & _5_BIT_MASK));
-				break;
-		case(6):
-				(*readedBits) = (reverseDWord(*readedBits & _6_BIT_MASK));
-				break;
-		case(7):
-				(*readedBits) = (reverseDWord(*readedBits & _7_BIT_MASK));
-				break;
-		case(8):
-				(*readedBits) = (reverseDWord(*readedBits & _8_BIT_MASK));
-				break;
-		case(9):
-				(*readedBits) = (reverseDWord(*readedBits & _9_BIT_MASK));
-				break;
-		case(10):
-				(*readedBits) = (reverseDWord(*readedBits & _10_BIT_MASK));
-				break;
-		case(11):
-				(*readedBits) = (reverseDWord(*readedBits & _11_BIT_MASK));
-				break;
-		case(12):
-				(*readedBits) = (reverseDWord(*readedBits & _12_BIT_MASK));
-				break;
-		case(13):
-				(*readedBits) = (reverseDWord(*readedBits & _13_BIT_MASK));
-				break;
-		default:
-				fprintf(stderr, "%s", "Decompression error.");
-				break;
-
-	}
-
-	return EXIT_SUCCESS;
-}
-
 /**
  * Function save byte to file
  *
@@ -421,12 +92,7 @@ void initStructures (tRGB globalColorTable [], tRGB localColorTable [], tGIFREAD
 	}
 
 	// Init reader struct
-	reader->Byte1 = 0;
-	reader->Byte2 = 0;
-	reader->Byte3 = 0;
 	reader->lzwSize = 8;
-	reader->usedBitsFromByte1LastTime = -1;
-	reader->BytesToReadInSubBlock = 0;
 	reader->activeColorTable = NULL;
 	reader->activeColorTableSize = 0;
 
@@ -434,213 +100,838 @@ void initStructures (tRGB globalColorTable [], tRGB localColorTable [], tGIFREAD
 
 
 /**
- * Function decode GIF89a
+ * Function init decoder options to default values (BGR bit map output, BGRA for GIF
+ * with transparent color, single thread)
  *
- * @param inputFile Pointer to input file
- * @return color matrix of pixels
+ * @param options Pointer to decoder options
+ */
+void initDecodeOptions(tGIFDECODE_OPTIONS *options) {
+	options->outputMode = GIF_OUTPUT_BGR;
+	options->threads = 1;
+	options->index = NULL;
+	options->targetWidth = 0;
+	options->targetHeight = 0;
+	options->scaleX = 0;
+	options->scaleY = 0;
+	options->cropX = 0;
+	options->cropY = 0;
+	options->cropWidth = 0;
+	options->cropHeight = 0;
+}
+
+/**
+ * Function expand color index plane into BGR bit map
+ *
+ * @param indices Color index plane (CV_8UC1)
+ * @param palette Color table
+ * @param bitMap Output BGR bit map (CV_8UC3)
+ */
+void expandIndexPlane(const Mat &indices, const tRGB *palette, Mat &bitMap) {
+
+	u_int32_t paletteTable[NUMBER_OF_COLORS];
+
+	initPaletteTable(paletteTable, palette);
+	bitMap.create(indices.rows, indices.cols, CV_8UC3);
+
+	for (int row = 0; row < indices.rows; row++)
+		expandPaletteRow(paletteTable, indices.ptr<u_int8_t>(row), bitMap.ptr<u_int8_t>(row), indices.cols);
+}
+
+/**
+ * Function convert color index plane into grayscale image, conversion is done
+ * only once per palette entry (same weights as CV_BGR2GRAY)
+ *
+ * @param indices Color index plane (CV_8UC1)
+ * @param palette Color table
+ * @param gray Output grayscale image (CV_8UC1)
+ */
+void grayIndexPlane(const Mat &indices, const tRGB *palette, Mat &gray) {
+
+	Mat lut(1, NUMBER_OF_COLORS, CV_8UC1);
+
+	for (int i = 0; i < NUMBER_OF_COLORS; i++)
+		lut.at<u_int8_t>(0, i) = (u_int8_t)((palette[i].blue * 1868 + palette[i].green * 9617 + palette[i].red * 4899 + (1 << 13)) >> 14);
+
+	LUT(indices, lut, gray);
+}
+
+/**
+ * Function expand indexed image into BGR bit map in place
+ *
+ * @param image Pointer to decoded image
  */
+void expandGifImage(tGIFIMAGE *image) {
 
-cv::Mat gif2bmp(FILE *inputFile){
+	if (!image->indexed)
+		return;
+
+	Mat bitMap;
+	expandIndexPlane(image->pixels, image->palette, bitMap);
+	image->pixels = bitMap;
+	image->indexed = 0;
+}
+
+/**
+ * Function init decoder context, buffers are allocated by first decoded images
+ *
+ * @param context Pointer to decoder context
+ * @return 0 on success, 1 on failure
+ */
+int initGifContext(tGIFCONTEXT *context) {
+
+	initGifArena(&context->arena);
+	initGifIndex(&context->index);
+	context->pixelAllocations = 0;
+
+	return initGifReader(&context->reader);
+}
+
+/**
+ * Function free decoder context buffers, pixels of decoded images are left to their owners
+ *
+ * @param context Pointer to decoder context
+ */
+void freeGifContext(tGIFCONTEXT *context) {
+
+	freeGifReader(&context->reader);
+	freeGifArena(&context->arena);
+	freeGifIndex(&context->index);
+
+	for (int i = 0; i < GIF_OUTPUT_MODES; i++) {
+		context->pixels[i].release();
+		context->rows[i].release();
+	}
+	context->background.release();
+}
+
+/**
+ * Function return number of heap allocations done by decoder context since init,
+ * buffer growth is counted as allocation
+ *
+ * @param context Pointer to decoder context
+ * @return Number of allocations
+ */
+u_int64_t getGifContextAllocations(const tGIFCONTEXT *context) {
+
+	return (u_int64_t)context->reader.allocations + context->reader.bitReader.allocations +
+		context->arena.allocations + context->index.allocations + context->pixelAllocations;
+}
+
+/**
+ * Function make sure context pixel buffer has given size and type, buffer is allocated
+ * only when they are changed
+ *
+ * @param context Pointer to decoder context
+ * @param buffer Context pixel buffer
+ * @param size Requested size
+ * @param type Requested matrix type
+ */
+static void reserveContextPixels(tGIFCONTEXT *context, Mat &buffer, Size size, int type) {
+
+	if (buffer.empty() || buffer.size() != size || buffer.type() != type)
+		context->pixelAllocations++;
+
+	buffer.create(size, type);
+}
+
+/**
+ * Function fill context pixel buffer and share it with output matrix
+ *
+ * @param context Pointer to decoder context
+ * @param buffer Context pixel buffer
+ * @param size Requested size
+ * @param type Requested matrix type
+ * @param value Fill value
+ * @param pixels Output matrix
+ */
+static void takeContextPixels(tGIFCONTEXT *context, Mat &buffer, Size size, int type, const Scalar &value, Mat &pixels) {
+
+	reserveContextPixels(context, buffer, size, type);
+	buffer.setTo(value);
+	pixels = buffer;
+}
+
+/**
+ * Function expand indexed image into BGR buffer of context
+ *
+ * @param context Pointer to decoder context
+ * @param image Pointer to decoded image
+ */
+static void expandContextImage(tGIFCONTEXT *context, tGIFIMAGE *image) {
+
+	if (!image->indexed)
+		return;
+
+	reserveContextPixels(context, context->pixels[GIF_OUTPUT_BGR], image->pixels.size(), CV_8UC3);
+	expandIndexPlane(image->pixels, image->palette, context->pixels[GIF_OUTPUT_BGR]);
+	image->pixels = context->pixels[GIF_OUTPUT_BGR];
+	image->indexed = 0;
+}
+
+/**
+ * Function check if color table can be stored into index plane of image
+ *
+ * @param image Pointer to decoded image
+ * @param colorTable Color table of next image block
+ * @param colorTableSize Number of colors in color table
+ * @return 1 if palettes are same, 0 otherwise
+ */
+static int paletteCompatible(tGIFIMAGE *image, tRGB colorTable [], int colorTableSize) {
+
+	// Last palette entry of index plane can be background color
+	if (colorTableSize > image->colorTableSize)
+		return 0;
+
+	return memcmp(image->palette, colorTable, colorTableSize * sizeof(tRGB)) == 0;
+}
+
+/**
+ * Function create output matrix for first image block. Index plane keeps palette
+ * of the block, white background is stored into first unused palette entry.
+ * Full palette without white color falls back to BGR output unless the opaque
+ * block covers whole screen.
+ *
+ * @param context Pointer to decoder context
+ * @param buffers Context pixel buffers of output modes
+ * @param image Pointer to decoded image
+ * @param pic Picture property struct
+ * @param size Size of output matrix
+ * @param bitMapWriter Writer initialized from image descriptor and graphic control
+ * @param colorTable Color table of image block
+ * @param colorTableSize Number of colors in color table
+ */
+static void createIndexPlane(tGIFCONTEXT *context, Mat buffers[], tGIFIMAGE *image, tPIC_PROPERTY *pic, Size size, tBITMAPWRITER *bitMapWriter, tRGB colorTable [], int colorTableSize) {
+
+	int height = pic->heightInPixHighByte*256 + pic->heightInPixLowByte;
+	int width = pic->widthInPixHighByte*256 + pic->widthInPixLowByte;
+	int background = -1;
+
+	memset(image->palette, 0, sizeof(image->palette));
+	memcpy(image->palette, colorTable, colorTableSize * sizeof(tRGB));
+	image->colorTableSize = colorTableSize;
+	image->paletteSize = colorTableSize;
+
+	// Look for white color in palette
+	for (int i = 0; i < colorTableSize; i++) {
+		if (colorTable[i].red == 255 && colorTable[i].green == 255 && colorTable[i].blue == 255) {
+			background = i;
+			break;
+		}
+	}
+
+	// Add white color as background
+	if (background < 0 && colorTableSize < NUMBER_OF_COLORS) {
+		background = colorTableSize;
+		image->palette[background].red = 255;
+		image->palette[background].green = 255;
+		image->palette[background].blue = 255;
+		image->paletteSize++;
+	}
+
+	// Background is never visible
+	if (background < 0 && bitMapWriter->transparentIndex == NO_TRANSPARENT_COLOR &&
+		bitMapWriter->actualColumn == 0 && bitMapWriter->actualRow == 0 &&
+		(int)bitMapWriter->actualWidth == width && (int)bitMapWriter->actualHeight == height)
+		background = 0;
+
+	if (background < 0) {
+		takeContextPixels(context, buffers[GIF_OUTPUT_BGR], size, CV_8UC3, Scalar(255,255,255), image->pixels);
+		image->indexed = 0;
+	}
+	else {
+		takeContextPixels(context, buffers[GIF_OUTPUT_INDEX], size, CV_8UC1, Scalar(background), image->pixels);
+		image->indexed = 1;
+	}
+}
+
+/**
+ * Function return number of interlace passes needed for output size chosen by
+ * decoder. Output with at most every 8th (4th) row of decoded area needs only first
+ * (two) passes, skipped rows are filled by nearest decoded row, so sampled row is
+ * at most half of output row away. Output which is not downscaled by decoder
+ * needs all passes.
+ *
+ * @param size Output size chosen by decoder
+ * @param area Decoded screen area
+ * @return Number of decoded interlace passes
+ */
+static int getInterlacePasses(Size size, Rect area) {
+
+	if (size.height >= area.height)
+		return GIF_INTERLACE_PASSES;
+
+	for (int passes = 1; passes <= 2; passes++)
+		if (size.height * (8 >> (passes - 1)) <= area.height)
+			return passes;
+
+	return GIF_INTERLACE_PASSES;
+}
+
+/**
+ * Function read image descriptor, color table and image data into bit map,
+ * transparent pixels keep bit map content
+ *
+ * @param stream Pointer to input stream
+ * @param context Pointer to decoder context
+ * @param pic Picture property struct
+ * @param globalColorTable Global color table
+ * @param localColorTable Local color table
+ * @param control Graphic control of image block
+ * @param interlacePasses Number of decoded passes of interlaced image
+ * @param size Size of output matrix
+ * @param scale Mapping of screen into scaled or cropped output, NULL for full size output
+ * @param image Pointer to decoded image
+ * @return 0 on success, 1 on failure
+ */
+static int getImage(tGIFSTREAM *stream, tGIFCONTEXT *context, tPIC_PROPERTY *pic, tRGB globalColorTable [], tRGB localColorTable [], const tGRAPHIC_CONTROL *control, int interlacePasses, Size size, const tBITMAPSCALE *scale, tGIFIMAGE *image) {
+
+	tIMAGE_DESCRIPTOR imageDescriptor;
+	tBITMAPWRITER bitMapWriter;
+	tGIFREADER *reader = &context->reader;
+
+	// Read image descriptor and color table
+	if (getImageHeader(stream, reader, pic, globalColorTable, localColorTable, &imageDescriptor, &bitMapWriter))
+		return EXIT_FAILURE;
+	bitMapWriter.transparentIndex = control->transparentColorFlag ? control->transparentColorIndex : NO_TRANSPARENT_COLOR;
+
+	// Index plane holds single palette - expand it when palette is changed
+	if (image->pixels.empty())
+		createIndexPlane(context, context->pixels, image, pic, size, &bitMapWriter, reader->activeColorTable, reader->activeColorTableSize);
+	else if (image->indexed && !paletteCompatible(image, reader->activeColorTable, reader->activeColorTableSize))
+		expandContextImage(context, image);
+
+	if (image->indexed)
+		bitMapWriter.outputMode = GIF_OUTPUT_INDEX;
+	else
+		bitMapWriter.outputMode = image->pixels.channels() == 4 ? GIF_OUTPUT_BGRA : GIF_OUTPUT_BGR;
+
+	// Thumbnail of interlaced image is decoded from first passes
+	if (bitMapWriter.interlaced)
+		bitMapWriter.passLimit = interlacePasses;
+	bitMapWriter.scale = scale;
+
+	// Get image data
+	return getImageData(stream, reader, image->pixels, &bitMapWriter);
+}
+
+/**
+ * Function return size of output matrix. Requested output size smaller than logical
+ * screen is used directly (pixels are sampled while decoding), larger one is left
+ * for resize of decoded image.
+ *
+ * @param options Pointer to decoder options
+ * @param width Width of decoded screen area
+ * @param height Height of decoded screen area
+ * @return Size of output matrix
+ */
+static Size getOutputSize(const tGIFDECODE_OPTIONS *options, int width, int height) {
+
+	Size size(width, height);
+
+	if (options->targetWidth > 0 && options->targetHeight > 0)
+		size = Size(options->targetWidth, options->targetHeight);
+	else if (options->scaleX > 0 && options->scaleY > 0)
+		size = Size((int)(width * options->scaleX + 0.5), (int)(height * options->scaleY + 0.5));
+
+	// Only downscaling is done by decoder
+	if (size.width < 1 || size.height < 1 || size.width > width || size.height > height)
+		return Size(width, height);
+
+	return size;
+}
+
+/**
+ * Function return decoded area of logical screen - crop rectangle from options
+ * clipped to screen, whole screen when crop is not set
+ *
+ * @param options Pointer to decoder options
+ * @param width Logical screen width
+ * @param height Logical screen height
+ * @return Decoded area, empty when crop rectangle is outside of screen
+ */
+static Rect getDecodedArea(const tGIFDECODE_OPTIONS *options, int width, int height) {
+
+	if (options->cropWidth <= 0 || options->cropHeight <= 0)
+		return Rect(0, 0, width, height);
+
+	int left = max(options->cropX, 0);
+	int top = max(options->cropY, 0);
+	int right = min(options->cropX + options->cropWidth, width);
+	int bottom = min(options->cropY + options->cropHeight, height);
+
+	if (left >= right || top >= bottom)
+		return Rect(0, 0, 0, 0);
+
+	return Rect(left, top, right - left, bottom - top);
+}
+
+/**
+ * Function read all image blocks into output matrix. BGRA output starts transparent,
+ * only opaque pixels of image blocks are stored.
+ *
+ * @param stream Pointer to input stream behind global color table
+ * @param context Pointer to decoder context
+ * @param pic Picture property struct
+ * @param globalColorTable Global color table
+ * @param outputMode Output layout (GIF_OUTPUT_*)
+ * @param interlacePasses Number of decoded passes of interlaced images
+ * @param size Size of output matrix
+ * @param scale Mapping of screen into scaled or cropped output, NULL for full size output
+ * @param image Pointer to decoded image
+ */
+static void readGifImages(tGIFSTREAM *stream, tGIFCONTEXT *context, tPIC_PROPERTY *pic, tRGB globalColorTable [], int outputMode, int interlacePasses, Size size, const tBITMAPSCALE *scale, tGIFIMAGE *image){
+
+	tRGB localColorTable [256];
+	tGRAPHIC_CONTROL control;
+	u_int8_t Byte = 0;
+
+	// Init output matrix, index plane is created with first image block
+	if (outputMode == GIF_OUTPUT_BGR)
+		takeContextPixels(context, context->pixels[GIF_OUTPUT_BGR], size, CV_8UC3, Scalar(255,255,255), image->pixels);
+	else if (outputMode == GIF_OUTPUT_BGRA)
+		takeContextPixels(context, context->pixels[GIF_OUTPUT_BGRA], size, CV_8UC4, Scalar(255,255,255,0), image->pixels);
+
+	// Get gif body, only transparent color of graphic control is used for single bit map
+	while (1) {
+
+		// Control values are valid only for next image
+		initGraphicControl(&control);
+		if (getNextBlock(stream, &control, NULL, &Byte))
+			throw "Incorrect gif file.";
+
+		// End of file
+		if (Byte == GIF_END_OF_FILE)
+			break;
+
+		if (getImage(stream, context, pic, globalColorTable, localColorTable, &control, interlacePasses, size, scale, image))
+			throw "Incorrect gif file.";
+	}
+
+	// Gif without image blocks
+	if (image->pixels.empty())
+		takeContextPixels(context, context->pixels[GIF_OUTPUT_BGR], size, CV_8UC3, Scalar(255,255,255), image->pixels);
+}
+
+/**
+ * Function decode GIF89a with prepared context
+ *
+ * @param stream Pointer to input stream
+ * @param context Pointer to decoder context
+ * @param options Pointer to decoder options
+ * @param image Pointer to decoded image
+ */
+static void readGif(tGIFSTREAM *stream, tGIFCONTEXT *context, const tGIFDECODE_OPTIONS *options, tGIFIMAGE *image){
+
+	tPIC_PROPERTY pic;
+	tRGB globalColorTable [256];
+	tRGB localColorTable [256];
+	tBITMAPSCALE scale;
+	tGIFREADER *reader = &context->reader;
+	const tGIFINDEX *index = options->index;
+
+	// Init used structures
+	initStructures (globalColorTable, localColorTable, reader);
+
+	// Read header and global color table
+	if (getGifHeader(stream, reader, &pic, globalColorTable))
+		throw "Incorrect gif file.";
+
+	int width = pic.widthInPixHighByte*256 + pic.widthInPixLowByte;
+	int height = pic.heightInPixHighByte*256 + pic.heightInPixLowByte;
+	Rect area = getDecodedArea(options, width, height);
+	if (area.width == 0 || area.height == 0)
+		throw "Crop rectangle is outside of image.";
+
+	Size size = getOutputSize(options, area.width, area.height);
+	int interlacePasses = getInterlacePasses(size, area);
+
+	// Transparent pixels are kept in alpha channel, index of broken file keeps blocks before error
+	int outputMode = options->outputMode;
+	if (outputMode != GIF_OUTPUT_BGRA && index == NULL) {
+		buildGifIndex(stream, &context->index);
+		index = &context->index;
+	}
+	if (outputMode != GIF_OUTPUT_BGRA && hasTransparentFrames(stream, index))
+		outputMode = GIF_OUTPUT_BGRA;
+
+	image->indexed = 0;
+	image->scaled = size.width != area.width || size.height != area.height;
+	image->cropped = area.width != width || area.height != height;
+	image->paletteSize = 0;
+	image->colorTableSize = 0;
+	image->pixels.release();
+
+	if (!image->scaled && !image->cropped) {
+		readGifImages(stream, context, &pic, globalColorTable, outputMode, interlacePasses, size, NULL, image);
+		return;
+	}
+
+	// Only pixels of crop rectangle are stored, sampled into output of requested size
+	if (initBitMapScale(&scale, width, height, area, size.width, size.height, &context->arena))
+		throw "Not enough memory.";
+
+	readGifImages(stream, context, &pic, globalColorTable, outputMode, interlacePasses, size, &scale, image);
+}
+
+/**
+ * Function decode GIF89a into BGR bit map or color index plane, GIF with transparent
+ * color is decoded into BGRA bit map (transparent pixels have zero alpha). Context
+ * buffers are reused, output pixels are valid until next decode with same context.
+ *
+ * @param context Pointer to decoder context
+ * @param stream Pointer to input stream
+ * @param options Pointer to decoder options
+ * @param image Pointer to decoded image
+ */
+void decodeGif(tGIFCONTEXT *context, tGIFSTREAM *stream, const tGIFDECODE_OPTIONS *options, tGIFIMAGE *image){
+
+	// Scratch memory of previous image is released
+	resetGifArena(&context->arena);
+	readGif(stream, context, options, image);
+}
+
+/**
+ * Function decode GIF89a into BGR bit map or color index plane with own context
+ *
+ * @param stream Pointer to input stream
+ * @param options Pointer to decoder options
+ * @param image Pointer to decoded image
+ */
+void decodeGif(tGIFSTREAM *stream, const tGIFDECODE_OPTIONS *options, tGIFIMAGE *image){
+
+	tGIFCONTEXT context;
+
+	// Reader buffers are shared by all image blocks
+	if (initGifContext(&context))
+		throw "Not enough memory.";
+
+	try {
+		decodeGif(&context, stream, options, image);
+		freeGifContext(&context);
+	}
+	catch (...) {
+		freeGifContext(&context);
+		throw;
+	}
+}
+
+/**
+ * Function check if rows of GIF are final as soon as they are decoded - single
+ * non interlaced image block covering whole logical screen
+ *
+ * @param index Pointer to GIF index
+ * @return 1 if rows can be passed to sink while decoding, 0 otherwise
+ */
+static int rowsStreamable(const tGIFINDEX *index) {
+
+	if (!index->complete || index->frameCount != 1)
+		return 0;
+
+	const tGIFINDEXFRAME *frame = &index->frames[0];
+	return !frame->interlaced && frame->left == 0 && frame->top == 0 &&
+		frame->width == index->width && frame->height == index->height;
+}
+
+/**
+ * Function decode single image block GIF row by row, each finished row is passed
+ * to sink and only one output row is kept in memory
+ *
+ * @param stream Pointer to input stream
+ * @param context Pointer to decoder context
+ * @param options Pointer to decoder options
+ * @param sink Pointer to row sink
+ */
+static void streamGifRows(tGIFSTREAM *stream, tGIFCONTEXT *context, const tGIFDECODE_OPTIONS *options, const tROWSINK *sink){
 
 	tPIC_PROPERTY pic;
 	tRGB globalColorTable [256];
 	tRGB localColorTable [256];
 	tIMAGE_DESCRIPTOR imageDescriptor;
-	tGIFREADER reader;
-	u_int8_t readRetVal = 0;
+	tGRAPHIC_CONTROL control;
+	tBITMAPWRITER bitMapWriter;
+	tBITMAPSCALE scale;
+	tROWOUTPUT output;
+	tGIFIMAGE image;
+	tGIFREADER *reader = &context->reader;
 	u_int8_t Byte = 0;
-    tBITMAPWRITER bitMapWriter;
 
 	// Init used structures
-	initStructures (globalColorTable, localColorTable, &reader);
+	initStructures (globalColorTable, localColorTable, reader);
+
+	// Read header and global color table
+	if (getGifHeader(stream, reader, &pic, globalColorTable))
+		throw "Incorrect gif file.";
+
+	int width = pic.widthInPixHighByte*256 + pic.widthInPixLowByte;
+	int height = pic.heightInPixHighByte*256 + pic.heightInPixLowByte;
+	Rect area = getDecodedArea(options, width, height);
+	if (area.width == 0 || area.height == 0)
+		throw "Crop rectangle is outside of image.";
+
+	Size size = getOutputSize(options, area.width, area.height);
+	int mapped = size.width != width || size.height != height;
+
+	// Skip extensions in front of image block
+	initGraphicControl(&control);
+	if (getNextBlock(stream, &control, NULL, &Byte) || Byte == GIF_END_OF_FILE)
+		throw "Incorrect gif file.";
+
+	if (getImageHeader(stream, reader, &pic, globalColorTable, localColorTable, &imageDescriptor, &bitMapWriter))
+		throw "Incorrect gif file.";
+	bitMapWriter.transparentIndex = control.transparentColorFlag ? control.transparentColorIndex : NO_TRANSPARENT_COLOR;
+
+	// Output matrix has single row, it is cleared to background after each row
+	if (options->outputMode == GIF_OUTPUT_INDEX)
+		createIndexPlane(context, context->rows, &image, &pic, Size(size.width, 1), &bitMapWriter, reader->activeColorTable, reader->activeColorTableSize);
+	else if (options->outputMode == GIF_OUTPUT_BGRA) {
+		takeContextPixels(context, context->rows[GIF_OUTPUT_BGRA], Size(size.width, 1), CV_8UC4, Scalar(255,255,255,0), image.pixels);
+		image.indexed = 0;
+	}
+	else {
+		takeContextPixels(context, context->rows[GIF_OUTPUT_BGR], Size(size.width, 1), CV_8UC3, Scalar(255,255,255), image.pixels);
+		image.indexed = 0;
+	}
+	reserveContextPixels(context, context->background, image.pixels.size(), image.pixels.type());
+	image.pixels.copyTo(context->background);
+
+	output.sink = sink;
+	output.height = size.height;
+	output.nextRow = 0;
+	output.background = context->background.ptr<u_int8_t>(0);
+	output.status = EXIT_SUCCESS;
+	if (image.indexed)
+		bitMapWriter.outputMode = GIF_OUTPUT_INDEX;
+	else
+		bitMapWriter.outputMode = image.pixels.channels() == 4 ? GIF_OUTPUT_BGRA : GIF_OUTPUT_BGR;
+	bitMapWriter.rowOutput = &output;
 
-	// Check gif version
-	if (checkGifVersion(inputFile))
-        throw;
+	if (sink->begin != NULL && sink->begin(sink->context, size.width, size.height, image.indexed ? image.palette : NULL, image.indexed ? image.paletteSize : 0))
+		throw "Row sink failed.";
 
-	// Parse gif header
-	if (parseGifHeader(inputFile, &pic))
-        throw;
+	if (mapped && initBitMapScale(&scale, width, height, area, size.width, size.height, &context->arena))
+		throw "Not enough memory.";
+	bitMapWriter.scale = mapped ? &scale : NULL;
 
-	// Get global table
-	if (pic.globalColorTable) {
-		reader.activeColorTableSize = (u_int8_t)pic.colorTableLong;
-		if (getColorTable(inputFile, globalColorTable, pic.colorTableLong))
-            throw;
-	}
+	int status = getImageData(stream, reader, image.pixels, &bitMapWriter);
 
-    // Init output matrix
-    Mat bitMap(pic.heightInPixHighByte*256 + pic.heightInPixLowByte, pic.widthInPixHighByte*256 + pic.widthInPixLowByte, CV_8UC3, Scalar(255,255,255));
+	if (output.status != EXIT_SUCCESS)
+		throw "Row sink failed.";
+	if (status != EXIT_SUCCESS)
+		throw "Incorrect gif file.";
 
-	// Get background color
-	if (pic.backgroundColor != -1) {
-        //bitMap = Scalar(globalColorTable[pic.backgroundColor].red, globalColorTable[pic.backgroundColor].green, globalColorTable[pic.backgroundColor].blue);
+	// Rows without image data keep background
+	for (u_int32_t y = output.nextRow; y < output.height; y++)
+		if (sink->row(sink->context, y, output.background))
+			throw "Row sink failed.";
+}
+
+/**
+ * Function pass rows of decoded image to sink, index plane is expanded row by row
+ * when sink requests BGR rows, alpha channel is dropped when sink does not request
+ * BGRA rows (transparent pixels have white color)
+ *
+ * @param context Pointer to decoder context, row buffer is taken from it
+ * @param image Pointer to decoded image
+ * @param sink Pointer to row sink
+ */
+static void emitGifImage(tGIFCONTEXT *context, tGIFIMAGE *image, const tROWSINK *sink){
+
+	int expand = image->indexed && sink->outputMode != GIF_OUTPUT_INDEX;
+	int dropAlpha = image->pixels.channels() == 4 && sink->outputMode != GIF_OUTPUT_BGRA;
+	int indexed = image->indexed && !expand;
+	u_int32_t paletteTable[NUMBER_OF_COLORS];
+	Mat &row = context->rows[expand ? sink->outputMode : GIF_OUTPUT_BGR];
+
+	if (expand) {
+		initPaletteTable(paletteTable, image->palette);
+		reserveContextPixels(context, row, Size(image->pixels.cols, 1), sink->outputMode == GIF_OUTPUT_BGRA ? CV_8UC4 : CV_8UC3);
 	}
+	else if (dropAlpha)
+		reserveContextPixels(context, row, Size(image->pixels.cols, 1), CV_8UC3);
 
-	// Get gif body
-	while (1) {
+	if (sink->begin != NULL && sink->begin(sink->context, image->pixels.cols, image->pixels.rows, indexed ? image->palette : NULL, indexed ? image->paletteSize : 0))
+		throw "Row sink failed.";
 
-		// Get block introducer from gif
-		readRetVal = readByteFromFile(inputFile, &Byte);
-		if (readRetVal == READ_WRITE_ERR) {
-            throw "Can not read input file.";
-		}
-		else if (readRetVal == END_OF_FILE) {
-            throw "Incorrect gif file.";
+	for (int y = 0; y < image->pixels.rows; y++) {
+		const u_int8_t *pixels = image->pixels.ptr<u_int8_t>(y);
+
+		if (expand) {
+			if (sink->outputMode == GIF_OUTPUT_BGRA)
+				expandPaletteRowAlpha(paletteTable, pixels, row.ptr<u_int8_t>(0), image->pixels.cols);
+			else
+				expandPaletteRow(paletteTable, pixels, row.ptr<u_int8_t>(0), image->pixels.cols);
+			pixels = row.ptr<u_int8_t>(0);
 		}
-		else { // End of file
-			if (Byte == GIF_END_OF_FILE) {
-				break;
-			}
-			else if (Byte == EXTENSION_INTRODUCER) { // Get extension label
-				readRetVal = readByteFromFile(inputFile, &Byte);
-				if (readRetVal == READ_WRITE_ERR) {
-                    throw "Can not read input file.";
-				}
-				else if (readRetVal == END_OF_FILE) {
-                    throw "Incorrect gif file.";
-				}
-				else {
-					switch (Byte) {
-						case(APPLICATION_EXTENSION_LABEL):	// Application ext.
-								if (getApplicationExt(inputFile)) {
-                                    throw;
-								}
-								break;
-						case(COMMENT_EXTENSION_LABEL):		// Comment ext.
-								if (getCommentExt(inputFile)) {
-                                    throw;
-								}
-								break;
-						case(PLAINTEXT_EXTENSION_LABEL):	// Plain text ext.
-								if (getPlainTextExt(inputFile)) {
-                                    throw;
-								}
-								break;
-						case(GRAPHICS_CONTROL_LABEL):		// Graphic control ext.
-								if (getGraphicControlExt(inputFile)) {
-                                    throw;
-								}
-
-								// Read next byte
-								readRetVal = readByteFromFile(inputFile, &Byte);
-								if (readRetVal == READ_WRITE_ERR) {
-                                    throw "Can not read input file.";
-								}
-								else if (readRetVal == END_OF_FILE) {
-                                    throw "Incorrect gif file.";
-								}
-								else {
-									switch (Byte) {
-										// Image descriptor
-										case(IMAGE_DESCRIPTOR_INTRODUCER):
-
-												// Read image descriptor
-												if (getImageDescriptor(inputFile, &imageDescriptor)) {
-                                                    throw;
-												}
-
-												// Init bmpWritter
-                                                bitMapWriter.actualColumn = imageDescriptor.leftPosHighByte*256 + imageDescriptor.leftPosLowByte;
-                                                bitMapWriter.actualRow = imageDescriptor.topPosHighByte*256 + imageDescriptor.topPosLowByte;
-                                                bitMapWriter.actualWidth = imageDescriptor.widthHighByte*256 + imageDescriptor.widthLowByte;
-                                                bitMapWriter.actualHeight = imageDescriptor.heightHighByte*256 + imageDescriptor.heightLowByte;
-                                                bitMapWriter.actualX = bitMapWriter.actualColumn;
-                                                bitMapWriter.actualY = bitMapWriter.actualRow;
-
-												// Set and read color table
-												if (imageDescriptor.localColorTableFlag) {
-													reader.activeColorTable = localColorTable;
-													reader.activeColorTableSize = imageDescriptor.localColorTableSize;
-													if (getColorTable(inputFile, localColorTable, imageDescriptor.localColorTableSize)) {
-                                                        throw;
-													}
-												}
-												else {
-													reader.activeColorTable = globalColorTable;
-													reader.activeColorTableSize = pic.colorTableLong;
-												}
-
-												// Get image data
-												reader.dataBlockSize = imageDescriptor.sizeInPixels;
-                                                if (getImageData(inputFile, &reader, bitMap, &bitMapWriter)) {
-                                                    throw;
-												}
-
-												break;
-
-										// Plain text extension
-										case(PLAINTEXT_EXTENSION_LABEL):
-
-												// Get plain text extension
-												if (getPlainTextExt(inputFile)) {
-                                                    throw;
-												}
-												break;
-										default:
-                                            throw "Incorrect gif file.";
-									}
-								}
-
-								break;
-						default:
-                            throw "Incorrect gif file.";
-					}
-
-				}
-			}
-			else if (Byte == IMAGE_DESCRIPTOR_INTRODUCER) {
-				if (getImageDescriptor(inputFile, &imageDescriptor)) {
-                    throw;
-				}
-
-				// Init bmpWritter
-                bitMapWriter.actualColumn = imageDescriptor.leftPosHighByte*256 + imageDescriptor.leftPosLowByte;
-                bitMapWriter.actualRow = imageDescriptor.topPosHighByte*256 + imageDescriptor.topPosLowByte;
-                bitMapWriter.actualWidth = imageDescriptor.widthHighByte*256 + imageDescriptor.widthLowByte;
-                bitMapWriter.actualHeight = imageDescriptor.heightHighByte*256 + imageDescriptor.heightLowByte;
-                bitMapWriter.actualX = bitMapWriter.actualColumn;
-                bitMapWriter.actualY = bitMapWriter.actualRow;
-
-				// Set and read color table
-				if (imageDescriptor.localColorTableFlag) {
-					reader.activeColorTable = localColorTable;
-					reader.activeColorTableSize = imageDescriptor.localColorTableSize;
-					if (getColorTable(inputFile, localColorTable, imageDescriptor.localColorTableSize)) {
-                        throw;
-					}
-				}
-				else {
-                    reader.activeColorTable = globalColorTable;
-                    reader.activeColorTableSize = pic.colorTableLong;
-				}
-
-				reader.dataBlockSize = imageDescriptor.sizeInPixels;
-                if (getImageData(inputFile, &reader, bitMap, &bitMapWriter)) {
-                    throw;
-				}
-
-			}
-			else {
-                throw "Incorrect gif file.";
-			}
+		else if (dropAlpha) {
+			cvtColor(image->pixels.row(y), row, CV_BGRA2BGR);
+			pixels = row.ptr<u_int8_t>(0);
 		}
+
+		if (sink->row(sink->context, y, pixels))
+			throw "Row sink failed.";
+	}
+}
+
+/**
+ * Function decode GIF89a and pass output rows to caller provided sink in top to bottom
+ * order. Single non interlaced image covering whole screen is passed while decoding,
+ * other GIFs (animations, partial or interlaced image blocks) are decoded whole
+ * first because their rows can be overwritten by later data. Palette is passed to
+ * sink begin only for index rows, it is NULL for BGR rows (index plane falls back
+ * to BGR when image blocks do not share palette or have transparent color). BGRA
+ * rows have zero alpha in pixels which are not covered by opaque pixels.
+ *
+ * @param context Pointer to decoder context
+ * @param stream Pointer to input stream
+ * @param options Pointer to decoder options, output mode is taken from sink
+ * @param sink Pointer to row sink
+ */
+void decodeGifRows(tGIFCONTEXT *context, tGIFSTREAM *stream, const tGIFDECODE_OPTIONS *options, const tROWSINK *sink){
+
+	tGIFDECODE_OPTIONS sinkOptions = *options;
+
+	sinkOptions.outputMode = sink->outputMode;
+	resetGifArena(&context->arena);
+
+	// Block structure decides if rows are final when decoded
+	if (buildGifIndex(stream, &context->index))
+		throw "Incorrect gif file.";
+
+	if (!rowsStreamable(&context->index)) {
+		tGIFIMAGE image;
+
+		// Built index is used to look for transparent color
+		if (sinkOptions.index == NULL)
+			sinkOptions.index = &context->index;
+
+		decodeGif(context, stream, &sinkOptions, &image);
+		emitGifImage(context, &image, sink);
 	}
+	else
+		streamGifRows(stream, context, &sinkOptions, sink);
 
-    return bitMap;
+	if (sink->end != NULL && sink->end(sink->context))
+		throw "Row sink failed.";
 }
 
-cv::Mat loadGif(const string &filename)
+/**
+ * Function decode GIF89a and pass output rows to caller provided sink with own context
+ *
+ * @param stream Pointer to input stream
+ * @param options Pointer to decoder options, output mode is taken from sink
+ * @param sink Pointer to row sink
+ */
+void decodeGifRows(tGIFSTREAM *stream, const tGIFDECODE_OPTIONS *options, const tROWSINK *sink){
+
+	tGIFCONTEXT context;
+
+	if (initGifContext(&context))
+		throw "Not enough memory.";
+
+	try {
+		decodeGifRows(&context, stream, options, sink);
+		freeGifContext(&context);
+	}
+	catch (...) {
+		freeGifContext(&context);
+		throw;
+	}
+}
+
+/**
+ * Function decode GIF89a
+ *
+ * @param stream Pointer to input stream
+ * @return color matrix of pixels
+ */
+cv::Mat gif2bmp(tGIFSTREAM *stream){
+
+	tGIFDECODE_OPTIONS options;
+	tGIFIMAGE image;
+
+	initDecodeOptions(&options);
+	decodeGif(stream, &options, &image);
+
+	return image.pixels;
+}
+
+/**
+ * Function decode GIF89a from caller provided memory
+ *
+ * @param data Pointer to GIF data
+ * @param size Size of data in bytes
+ * @return color matrix of pixels
+ */
+cv::Mat loadGif(const u_int8_t *data, size_t size)
 {
-    FILE *fgif = fopen(filename.c_str(), "rb");
+    tGIFSTREAM stream;
 
-    if (fgif == NULL)
+    initGifStream(&stream, data, size);
+
+    return gif2bmp(&stream);
+}
+
+/**
+ * Function decode GIF89a file, file is mapped or read into memory
+ *
+ * @param filename Input file name
+ * @param options Pointer to decoder options
+ * @param image Pointer to decoded image
+ */
+void loadGif(const string &filename, const tGIFDECODE_OPTIONS *options, tGIFIMAGE *image)
+{
+    tGIFSTREAM stream;
+
+    if (openGifStream(filename.c_str(), &stream))
         throw "Unable to open input file";
 
-    Mat m = gif2bmp(fgif);
+    try {
+        decodeGif(&stream, options, image);
+        closeGifStream(&stream);
+    }
+    catch (...) {
+        closeGifStream(&stream);
+        throw;
+    }
+}
+
+/**
+ * Function decode GIF89a file, file is mapped or read into memory
+ *
+ * @param filename Input file name
+ * @return color matrix of pixels
+ */
+cv::Mat loadGif(const string &filename)
+{
+    tGIFDECODE_OPTIONS options;
+    tGIFIMAGE image;
 
-    fclose(fgif);
+    initDecodeOptions(&options);
+    loadGif(filename, &options, &image);
 
-    return m;
+    return image.pixels;
 }
 
+/**
+ * Function decode GIF89a file row by row into sink, file is mapped or read into memory
+ *
+ * @param filename Input file name
+ * @param options Pointer to decoder options
+ * @param sink Pointer to row sink
+ */
+void loadGifRows(const string &filename, const tGIFDECODE_OPTIONS *options, const tROWSINK *sink)
+{
+    tGIFSTREAM stream;
+
+    if (openGifStream(filename.c_str(), &stream))
+        throw "Unable to open input file";
+
+    try {
+        decodeGifRows(&stream, options, sink);
+        closeGifStream(&stream);
+    }
+    catch (...) {
+        closeGifStream(&stream);
+        throw;
+    }
+}
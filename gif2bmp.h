@@ -22,15 +22,56 @@ using namespace cv;
 #ifndef GIF2BMP_H_
 #define GIF2BMP_H_
 
-u_int8_t readByteFromFile(FILE *ptr_file, u_int8_t *readedByte);
+/**
+ * @brief Decoded GIF - BGR bit map, BGRA bit map (GIF with transparent color)
+ * or color index plane with its palette, scaled image has already requested output size, cropped image contains
+ * only crop rectangle
+ */
+typedef struct{
+	Mat pixels;
+	int indexed;
+	int scaled;
+	int cropped;
+	tRGB palette[NUMBER_OF_COLORS];
+	int paletteSize;
+	int colorTableSize;
+} tGIFIMAGE;
+
+/**
+ * @brief Decoder context - reader buffers, scratch arena, block index and pixel buffers are kept
+ * between decoded images, same sized images are decoded without heap allocation. Pixels of decoded
+ * image share context buffers and are valid until next decode with same context.
+ */
+typedef struct{
+	tGIFREADER reader;
+	tGIFARENA arena;
+	tGIFINDEX index;
+	Mat pixels[GIF_OUTPUT_MODES];
+	Mat rows[GIF_OUTPUT_MODES];
+	Mat background;
+	u_int32_t pixelAllocations;
+} tGIFCONTEXT;
+
 u_int8_t writeByteToFile(FILE *ptr_file, u_int8_t *Byte);
 u_int8_t writeByteToFileOffset(FILE *ptr_file, u_int8_t *Byte, int offset);
-u_int8_t readBitsStreamFromFile (FILE *gifFile, tGIFREADER *reader, u_int32_t *readedBits, u_int8_t subBlockState);
-u_int8_t reverseByte(u_int8_t byte);
 int64_t getFileSize(FILE *file);
-cv::Mat gif2bmp(FILE *inputFile);
-u_int8_t readStdInIntoBuffer(u_int8_t *buffer);
+void initStructures (tRGB globalColorTable [], tRGB localColorTable [], tGIFREADER *reader);
+void initDecodeOptions(tGIFDECODE_OPTIONS *options);
+void expandIndexPlane(const Mat &indices, const tRGB *palette, Mat &bitMap);
+void grayIndexPlane(const Mat &indices, const tRGB *palette, Mat &gray);
+void expandGifImage(tGIFIMAGE *image);
+int initGifContext(tGIFCONTEXT *context);
+void freeGifContext(tGIFCONTEXT *context);
+u_int64_t getGifContextAllocations(const tGIFCONTEXT *context);
+void decodeGif(tGIFCONTEXT *context, tGIFSTREAM *stream, const tGIFDECODE_OPTIONS *options, tGIFIMAGE *image);
+void decodeGif(tGIFSTREAM *stream, const tGIFDECODE_OPTIONS *options, tGIFIMAGE *image);
+void decodeGifRows(tGIFCONTEXT *context, tGIFSTREAM *stream, const tGIFDECODE_OPTIONS *options, const tROWSINK *sink);
+void decodeGifRows(tGIFSTREAM *stream, const tGIFDECODE_OPTIONS *options, const tROWSINK *sink);
+cv::Mat gif2bmp(tGIFSTREAM *stream);
+cv::Mat loadGif(const u_int8_t *data, size_t size);
 cv::Mat loadGif(const string &filename);
+void loadGif(const string &filename, const tGIFDECODE_OPTIONS *options, tGIFIMAGE *image);
+void loadGifRows(const string &filename, const tGIFDECODE_OPTIONS *options, const tROWSINK *sink);
 
 
 #endif /* GIF2BMP_H_ */
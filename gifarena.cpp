@@ -0,0 +1,129 @@
+/*
+ *  File name: gifarena.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Include functions for scratch memory arena. Memory is taken from single
+ *               block by moving offset, full block is chained and bigger one is allocated.
+ *               Reset joins chained blocks into one, so same sized images reuse it without
+ *               allocation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "gifarena.h"
+#include "constant.h"
+
+/**
+ * Function init empty arena, memory is allocated with first taken block
+ *
+ * @param arena Pointer to arena
+ */
+void initGifArena(tGIFARENA *arena) {
+
+	arena->block = NULL;
+	arena->blockSize = 0;
+	arena->used = 0;
+	arena->taken = 0;
+	arena->allocations = 0;
+}
+
+/**
+ * Function free block chain starting with given block
+ *
+ * @param block Pointer to newest block
+ */
+static void freeGifArenaBlocks(u_int8_t *block) {
+
+	while (block != NULL) {
+		u_int8_t *previous = *(u_int8_t **)block;
+		free(block);
+		block = previous;
+	}
+}
+
+/**
+ * Function allocate new arena block, current block is linked from its header
+ *
+ * @param arena Pointer to arena
+ * @param size Block size including header
+ * @return 0 on success, 1 on failure
+ */
+static int addGifArenaBlock(tGIFARENA *arena, size_t size) {
+
+	u_int8_t *block = (u_int8_t *)malloc(size);
+	if (block == NULL)
+		return EXIT_FAILURE;
+
+	*(u_int8_t **)block = arena->block;
+	arena->block = block;
+	arena->blockSize = size;
+	arena->used = GIF_ARENA_ALIGNMENT;
+	arena->allocations++;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function free all arena blocks, allocation counter is kept
+ *
+ * @param arena Pointer to arena
+ */
+void freeGifArena(tGIFARENA *arena) {
+
+	u_int32_t allocations = arena->allocations;
+
+	freeGifArenaBlocks(arena->block);
+	initGifArena(arena);
+	arena->allocations = allocations;
+}
+
+/**
+ * Function release all taken blocks, memory is kept. Chained blocks are replaced by
+ * one block big enough for everything taken since last reset.
+ *
+ * @param arena Pointer to arena
+ */
+void resetGifArena(tGIFARENA *arena) {
+
+	if (arena->block != NULL && *(u_int8_t **)arena->block != NULL) {
+		size_t size = arena->taken + GIF_ARENA_ALIGNMENT;
+
+		if (size < arena->blockSize)
+			size = arena->blockSize;
+
+		freeGifArenaBlocks(arena->block);
+		arena->block = NULL;
+		arena->blockSize = 0;
+
+		// Failed allocation is repeated by next take
+		addGifArenaBlock(arena, size);
+	}
+
+	arena->used = GIF_ARENA_ALIGNMENT;
+	arena->taken = 0;
+}
+
+/**
+ * Function take memory block from arena, block is valid until arena reset
+ *
+ * @param arena Pointer to arena
+ * @param size Size in bytes
+ * @return pointer to aligned memory, NULL when memory can not be allocated
+ */
+void *takeGifArena(tGIFARENA *arena, size_t size) {
+
+	size = (size + GIF_ARENA_ALIGNMENT - 1) & ~(size_t)(GIF_ARENA_ALIGNMENT - 1);
+
+	if (arena->block == NULL || size > arena->blockSize - arena->used) {
+		size_t blockSize = arena->blockSize ? arena->blockSize * 2 : GIF_ARENA_INIT_SIZE;
+
+		if (blockSize < size + GIF_ARENA_ALIGNMENT)
+			blockSize = size + GIF_ARENA_ALIGNMENT;
+		if (addGifArenaBlock(arena, blockSize))
+			return NULL;
+	}
+
+	void *memory = arena->block + arena->used;
+	arena->used += size;
+	arena->taken += size;
+	return memory;
+}
@@ -0,0 +1,22 @@
+/*
+ *  File name: gifarena.h
+ *  Created on: 17. 10. 2026
+ *  Type: Header file
+ *  Description: Include functions declarations for scratch memory arena
+ */
+
+#ifndef GIFARENA_H_
+#define GIFARENA_H_
+
+#include "constant.h"
+
+// Every taken block starts at aligned offset, block header links previous block
+#define GIF_ARENA_ALIGNMENT 				16
+#define GIF_ARENA_INIT_SIZE 				65536
+
+void initGifArena(tGIFARENA *arena);
+void freeGifArena(tGIFARENA *arena);
+void resetGifArena(tGIFARENA *arena);
+void *takeGifArena(tGIFARENA *arena, size_t size);
+
+#endif /* GIFARENA_H_ */
@@ -3,6 +3,12 @@
 
 #include <iostream>
 #include <set>
+#include <vector>
+#include <algorithm>
+
+// Open addressing table of records, twice the maximal number of LZW codes
+#define GIF_ENCODER_HASH_BITS 13
+#define GIF_ENCODER_HASH_SIZE (1 << GIF_ENCODER_HASH_BITS)
 
 using namespace std;
 
@@ -10,30 +16,67 @@ class GIFdictionary
 {
 private:
     vector<unsigned int> palette;
-    vector<vector<unsigned int> >dictionary;
+
+    /// Palette colors + 1 (zero marks empty slot) and their indexes, table has at least twice more slots than colors
+    vector<unsigned int> color_keys;
+    vector<unsigned int> color_indexes;
+    unsigned int color_bits;
+
+    /// Records keyed by (prefix code, color index) + 1, zero marks empty slot
+    vector<unsigned long long> record_keys;
+    vector<unsigned int> record_codes;
     unsigned int sz;
     unsigned int palette_size;
     unsigned int last_record;
 
+    inline static unsigned long long recordKey(unsigned int prefix, unsigned int color)
+    {
+        return ((unsigned long long)prefix << 32 | color) + 1;
+    }
+
+    inline static unsigned int recordSlot(unsigned long long key)
+    {
+        return (unsigned int)((key * 0x9E3779B97F4A7C15ULL) >> (64 - GIF_ENCODER_HASH_BITS));
+    }
+
+    inline unsigned int colorSlot(unsigned int key) const
+    {
+        return (unsigned int)(((unsigned long long)key * 0x9E3779B97F4A7C15ULL) >> (64 - this->color_bits));
+    }
+
 public:
     GIFdictionary()
     {
         this->sz = 0;
         this->palette_size = 0;
         this->last_record = -1;
+        this->color_bits = 1;
     }
 
-    inline void addColors(set<unsigned int> & colors)
+    inline void addColors(const vector<unsigned int> & colors)
     {
+        // Color table is sized for all distinct colors, padding colors are not looked up
+        while ((1u << this->color_bits) < 2 * colors.size())
+            this->color_bits++;
+        this->color_keys.assign(1u << this->color_bits, 0);
+        this->color_indexes.assign(1u << this->color_bits, 0);
+
         // Saves colors
-        for (set<unsigned int>::iterator it = colors.begin();
+        for (vector<unsigned int>::const_iterator it = colors.begin();
              it != colors.end();
              it++)
         {
+            unsigned int slot = this->colorSlot(*it + 1);
+            while (this->color_keys[slot] != 0)
+                slot = (slot + 1) & ((1u << this->color_bits) - 1);
+            this->color_keys[slot] = *it + 1;
+            this->color_indexes[slot] = this->palette.size();
+
             this->palette.push_back(*it);
             this->last_record++;
 
-            if (this->last_record > pow(2, this->sz+1))
+            // Palette of 2^(sz+1) colors is full
+            if (this->last_record >= pow(2, this->sz+1))
                 this->sz++;
         }
 
@@ -54,38 +97,74 @@ public:
         this->sz++;
     }
 
-    inline int findColor(unsigned int color)
+    /**
+     * @brief Finds palette index of color in constant time
+     * @param color Color code (blue << 16 | green << 8 | red)
+     * @return Palette index, -1 if color is not in palette
+     */
+    inline int findColor(unsigned int color) const
     {
-        unsigned int i = 0;
-        for (vector<unsigned int>::iterator it = this->palette.begin();
-             it != this->palette.end();
-             i++, it++)
+        if (this->color_keys.empty())
+            return -1;
+
+        for (unsigned int slot = this->colorSlot(color + 1);
+             this->color_keys[slot] != 0;
+             slot = (slot + 1) & ((1u << this->color_bits) - 1))
         {
-            if (*it == color)
-                return i;
+            if (this->color_keys[slot] == color + 1)
+                return this->color_indexes[slot];
         }
+
         return -1;
     }
 
-    inline int find(vector<unsigned int> & record)
+    /**
+     * @brief Finds record of sequence extended by one color
+     * @param prefix Code of sequence (color index or record code)
+     * @param color Palette index of next color
+     * @return Code of extended sequence, -1 if it is not in dictionary
+     */
+    inline int find(unsigned int prefix, unsigned int color) const
     {
-        unsigned int i = 0;
-        for (vector<vector<unsigned int> >::iterator it = this->dictionary.begin();
-             it != this->dictionary.end();
-             it ++, i++)
+        if (this->record_keys.empty())
+            return -1;
+
+        unsigned long long key = recordKey(prefix, color);
+        for (unsigned int slot = recordSlot(key);
+             this->record_keys[slot] != 0;
+             slot = (slot + 1) & (GIF_ENCODER_HASH_SIZE - 1))
         {
-            if (record == (*it))
-                return i + this->palette.size()+2;
+            if (this->record_keys[slot] == key)
+                return this->record_codes[slot];
         }
 
         return -1;
     }
 
-    inline int addRecord(vector<unsigned int> & record)
+    /**
+     * @brief Adds record of sequence extended by one color, it gets next code
+     * @param prefix Code of sequence (color index or record code)
+     * @param color Palette index of next color
+     * @return Code of new record
+     */
+    inline int addRecord(unsigned int prefix, unsigned int color)
     {
-        this->dictionary.push_back(vector<unsigned int>(record));
+        // Table is allocated with first record, copies of empty dictionary are cheap
+        if (this->record_keys.empty())
+        {
+            this->record_keys.assign(GIF_ENCODER_HASH_SIZE, 0);
+            this->record_codes.assign(GIF_ENCODER_HASH_SIZE, 0);
+        }
+
         this->last_record++;
 
+        unsigned long long key = recordKey(prefix, color);
+        unsigned int slot = recordSlot(key);
+        while (this->record_keys[slot] != 0)
+            slot = (slot + 1) & (GIF_ENCODER_HASH_SIZE - 1);
+        this->record_keys[slot] = key;
+        this->record_codes[slot] = this->last_record;
+
         if (this->last_record >= pow(2, this->sz+1))
             this->sz++;
 
@@ -122,9 +201,18 @@ public:
         return this->last_record;
     }
 
+    /**
+     * @brief Releases record table after subblock was encoded
+     */
+    inline void freeRecords()
+    {
+        vector<unsigned long long>().swap(this->record_keys);
+        vector<unsigned int>().swap(this->record_codes);
+    }
+
     inline void clear()
     {
-        this->dictionary.clear();
+        fill(this->record_keys.begin(), this->record_keys.end(), 0);
         this->last_record = this->palette.size() + 1;
         this->sz = palette_size + 1;
     }
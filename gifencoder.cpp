@@ -1,11 +1,16 @@
 #include "gifencoder.h"
+#include <new>
 
 /**
  * @brief GIFencoder constructor
  * @param filename Output filename
  * @param image Mat containing image to be saved
+ * @param level Quantizer speed/quality level for images with more than 256 colors
+ * @param dither Dithering of quantized image
+ * @param truecolor Image with more than 256 colors is stored losslessly in tiles instead of quantized
  */
-GIFencoder::GIFencoder(const string &filename, const Mat &image)
+GIFencoder::GIFencoder(const string &filename, const Mat &image, enum quantize_level level,
+                       enum dither_mode dither, bool truecolor)
     : writer(filename)
 {
     Mat tmp(image);
@@ -13,37 +18,94 @@ GIFencoder::GIFencoder(const string &filename, const Mat &image)
     // Converts mat to CV_8U
     tmp.convertTo(tmp, CV_8U);
 
-    // Convert to 3 channels
-    if (tmp.channels() != 3)
+    // Convert to 3 channels, transparency is not stored
+    if (tmp.channels() == 4)
+        cvtColor(tmp,tmp,CV_BGRA2BGR);
+    else if (tmp.channels() != 3)
         cvtColor(tmp,tmp,CV_GRAY2RGB);
 
     // Checks if the output image is CV_8UC3
     if (tmp.type() != CV_8UC3)
         throw "Failed to convert internal reprezentaion of GIF image to type CV_8UC3";
 
-    // Determines subblocks with maximum of 256 colors
-    this->createSubBlocks(tmp);
+    // Big images are processed in row stripes on pool threads
+    this->threads = NULL;
+    if ((long long)tmp.rows * tmp.cols >= COLOR_HISTOGRAM_PARALLEL_PIXELS &&
+        getCpuCount() > 1 &&
+        !initThreadPool(&this->pool, getCpuCount() - 1))
+        this->threads = &this->pool;
 
-    // Writes header of the gif file
-    this->writeHeader(tmp);
+    // Destructor is not called when constructor throws, pool threads are stopped here
+    try
+    {
+        int64 start = getTickCount();
 
-    writer.write(0x21, 8);
-    writer.write(0xF9, 8);
-    writer.write(0x04, 8);
-    writer.write(0, 8);
-    writer.write(0, 8);
-    writer.write(0, 8);
-    writer.write(0, 8);
-    writer.write(0, 8);
+        // Reduces true color image to palette colors or keeps it in tiles with local palettes
+        vector<unsigned int> colors;
+        bool tiled = false;
+        if (!ColorHistogram::build(tmp, colors, this->threads))
+        {
+            if (truecolor)
+                tiled = true;
 
-    // Writes all subblocks
-    for (vector<SubBlock>::iterator it = this->subimages.begin();
-         it != this->subimages.end();
-         it ++)
-        this->writeSubBlock(*(it));
+            else
+            {
+                // Input is not modified
+                if (tmp.data == image.data)
+                    tmp = tmp.clone();
+
+                ColorQuantizer quantizer(level);
+                quantizer.quantize(tmp, tmp, this->threads, dither);
+
+                // Quantized pixels are palette colors, image is not scanned again
+                colors.clear();
+                for (unsigned int i = 0; i < quantizer.getColors(); i++)
+                    colors.push_back(quantizer.getColor(i));
+            }
+        }
+
+        // Determines subblocks with maximum of 256 colors
+        this->createSubBlocks(tmp, tiled, colors);
+        this->times.quantize = (getTickCount() - start) / getTickFrequency();
+        start = getTickCount();
+
+        // Writes header of the gif file
+        this->writeHeader(tmp);
+
+        writer.write(0x21, 8);
+        writer.write(0xF9, 8);
+        writer.write(0x04, 8);
+        writer.write(0, 8);
+        writer.write(0, 8);
+        writer.write(0, 8);
+        writer.write(0, 8);
+        writer.write(0, 8);
+
+        // Writes all subblocks
+        this->writeSubBlocks();
+
+        // Writes termination block
+        this->writer.write(0x3B, 8);
 
-    // Writes termination block
-    this->writer.write(0x3B, 8);
+        // Subblocks are encoded in between, their time is measured separately
+        this->times.write = (getTickCount() - start) / getTickFrequency() - this->times.lzw;
+    }
+    catch (...)
+    {
+        if (this->threads != NULL)
+            freeThreadPool(this->threads);
+        this->threads = NULL;
+        throw;
+    }
+}
+
+/**
+ * @brief GIFencoder destructor, stops pool threads
+ */
+GIFencoder::~GIFencoder()
+{
+    if (this->threads != NULL)
+        freeThreadPool(this->threads);
 }
 
 /**
@@ -76,142 +138,209 @@ void GIFencoder::writeHeader(const Mat &image)
 /**
  * @brief Creates SubBlocks from the original image that have less than 256 colors
  * @param image Source image
+ * @param tiled Image has more than 256 colors and is split into tiles
+ * @param colors Colors of whole image when it is not tiled
+ */
+void GIFencoder::createSubBlocks(const Mat &image, bool tiled, const vector<unsigned int> &colors)
+{
+    if (tiled)
+        this->splitTile(image, 0, 0, image.cols, image.rows);
+    else
+        this->subimages.push_back(SubBlock(image, 0,0,image.cols, image.rows, colors));
+}
+
+/**
+ * @brief Adds tile as SubBlock if it has at most 256 colors, otherwise halves
+ * it along longer side, big areas of few colors stay in one tile
+ * @param image Source image
+ * @param x Left column of tile
+ * @param y Top row of tile
+ * @param width Tile width
+ * @param height Tile height
  */
-void GIFencoder::createSubBlocks(const Mat &image)
+void GIFencoder::splitTile(const Mat &image, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
 {
-    this->subimages.push_back(SubBlock(image, 0,0,image.cols, image.rows));
-//    for (int y = 0; y < image.rows ; y += 16)
-//    {
-//        for (int x = 0; x < image.cols; x+= 16)
-//        {
-//            this->subimages.push_back(
-//                SubBlock(image,
-//                         x,
-//                         y,
-//                         (x < (int)(image.cols) - 16) ? 16 : (int)(image.cols) - x,
-//                         (y < (int)(image.rows) - 16) ? 16 : (int)(image.rows) - y));
-//        }
-//    }
+    vector<unsigned int> colors;
+
+    if (ColorHistogram::build(Mat(image, Rect(x, y, width, height)), colors))
+    {
+        this->subimages.push_back(SubBlock(image, x, y, width, height, colors));
+        return;
+    }
+
+    // Tile of more than 256 pixels always has two non-empty halves
+    if (width >= height)
+    {
+        this->splitTile(image, x, y, width / 2, height);
+        this->splitTile(image, x + width / 2, y, width - width / 2, height);
+    }
+    else
+    {
+        this->splitTile(image, x, y, width, height / 2);
+        this->splitTile(image, x, y + height / 2, width, height - height / 2);
+    }
 }
 
-vector<output_struct> GIFencoder::LZW(SubBlock & block)
+/**
+ * @brief Maps pixels of subblock to palette indexes, run of same colors is looked up once
+ * @param block Image subblock
+ * @param indices Output index plane
+ */
+void GIFencoder::mapColors(SubBlock & block, Mat &indices)
+{
+    GIFdictionary &dictionary = block.getDictionary();
+    const Mat &data = block.getData();
+
+    indices.create(data.rows, data.cols, CV_8UC1);
+
+    unsigned int last_color = 0;
+    int last_index = -1;
+
+    for (int y = 0; y < data.rows; y++)
+    {
+        const u_int8_t *pixels = data.ptr<u_int8_t>(y);
+        u_int8_t *bytes = indices.ptr<u_int8_t>(y);
+
+        for (int x = 0; x < data.cols; x++, pixels += 3)
+        {
+            unsigned int color = pixels[0] << 16 | pixels[1] << 8 | pixels[2];
+
+            if (color != last_color || last_index < 0)
+            {
+                last_color = color;
+                last_index = dictionary.findColor(color);
+
+                // Palette is built from colors of subblock
+                if (last_index < 0)
+                    throw "Color of subblock is missing in its palette";
+            }
+
+            bytes[x] = (u_int8_t)last_index;
+        }
+    }
+}
+
+/**
+ * @brief Encodes index plane of image subblock by LZW, sequence is kept as code
+ * of its prefix and looked up by (prefix code, next color) pair
+ * @param block Image subblock
+ * @param indices Palette indexes of subblock pixels
+ * @return Output codes with their bit lengths
+ */
+vector<output_struct> GIFencoder::LZW(SubBlock & block, const Mat &indices)
 {
     vector<output_struct> output;
-    vector<unsigned int> loaded_pixels;
+    GIFdictionary &dictionary = block.getDictionary();
     output_struct last_found(PALETTE, -1);
+    bool loaded = false;
 
     // Pushes clear code
-    output.push_back(output_struct(block.getDictionary().getClear(),
-                                   block.getDictionary().getCurrentSize()));
+    output.push_back(output_struct(dictionary.getClear(),
+                                   dictionary.getCurrentSize()));
 
     // Goes through whole image subblock
-    for (unsigned int y = 0; y < block.getData().rows; y++)
+    for (int y = 0; y < indices.rows; y++)
     {
-        for (unsigned int x = 0; x < block.getData().cols; x++)
+        const u_int8_t *row = indices.ptr<u_int8_t>(y);
+
+        for (int x = 0; x < indices.cols; x++)
         {
-            // Adds current collor to sequence
-            loaded_pixels.push_back(block.getData().at<Vec3b>(y, x).val[0] << 16 |
-                                    block.getData().at<Vec3b>(y, x).val[1] << 8 |
-                                    block.getData().at<Vec3b>(y, x).val[2]);
+            int color = row[x];
 
             // Just one color was loaded, load more
-            if (loaded_pixels.size() == 1)
+            if (!loaded)
             {
-                last_found = output_struct(block.getDictionary().findColor(loaded_pixels.back()),
-                                           block.getDictionary().getCurrentSize());
+                loaded = true;
+                last_found = output_struct(color, dictionary.getCurrentSize());
                 continue;
             }
 
-            // Determines index of current sequence
-            int record = block.getDictionary().find(loaded_pixels);
+            // Determines index of loaded sequence extended by current color
+            int record = dictionary.find(last_found.index, color);
 
             // Record is in dictionary, continue loading input
             if (record != -1)
             {
-                last_found = output_struct(record, block.getDictionary().getCurrentSize());
+                last_found = output_struct(record, dictionary.getCurrentSize());
                 continue;
             }
 
             // Stores record to output
             output.push_back(last_found);
 
-
             // Adds new record to dicionary
-            block.getDictionary().addRecord(loaded_pixels);
+            dictionary.addRecord(last_found.index, color);
 
             // LZW is too big
-            if (block.getDictionary().getCurrentSize() > 12)
+            if (dictionary.getCurrentSize() > 12)
             {
-                output.push_back(output_struct(block.getDictionary().getClear(), 12));
-                block.getDictionary().clear();
+                output.push_back(output_struct(dictionary.getClear(), 12));
+                dictionary.clear();
             }
 
-            // Removes all pixels from loaded sequence except for last one
-            unsigned int tmp = loaded_pixels.back();
-            loaded_pixels.clear();
-            loaded_pixels.push_back(tmp);
-
-            // Determines color of last loaded pixel
-            last_found = output_struct(block.getDictionary().findColor(tmp),
-                                       block.getDictionary().getCurrentSize());
+            // Loaded sequence starts with current color
+            last_found = output_struct(color, dictionary.getCurrentSize());
         }
     }
 
     // Stores last record to output
-    if (!loaded_pixels.empty())
+    if (loaded)
         output.push_back(last_found);
 
     // Stores EOI
-    output.push_back(output_struct(block.getDictionary().getEOI(), block.getDictionary().getCurrentSize()));
+    output.push_back(output_struct(dictionary.getEOI(), dictionary.getCurrentSize()));
     return output;
 }
 
-void GIFencoder::writeImageDescriptor(SubBlock &block)
+void GIFencoder::writeImageDescriptor(SubBlock &block, GIFwriter &writer)
 {
     // Image separator
-    this->writer.write(0x2C, 8);
+    writer.write(0x2C, 8);
     // Image left
-    this->writer.write(block.offset_x, 8);
-    this->writer.write(block.offset_x >> 8, 8);
+    writer.write(block.offset_x, 8);
+    writer.write(block.offset_x >> 8, 8);
     // Image right
-    this->writer.write(block.offset_y, 8);
-    this->writer.write(block.offset_y >> 8, 8);
+    writer.write(block.offset_y, 8);
+    writer.write(block.offset_y >> 8, 8);
     // Image width
-    this->writer.write(block.width, 8);
-    this->writer.write(block.width >> 8, 8);
+    writer.write(block.width, 8);
+    writer.write(block.width >> 8, 8);
     // Image height
-    this->writer.write(block.height, 8);
-    this->writer.write(block.height >> 8, 8);
+    writer.write(block.height, 8);
+    writer.write(block.height >> 8, 8);
     // Packed field
-    this->writer.write(128 | block.dictionary.getPaletteSize(), 8);
+    writer.write(128 | block.dictionary.getPaletteSize(), 8);
 }
 
-void GIFencoder::writePalette(SubBlock &block)
+void GIFencoder::writePalette(SubBlock &block, GIFwriter &writer)
 {
     // Write color palette
     for (vector<unsigned int>::iterator it = block.getDictionary().getPalette().begin();
          it != block.getDictionary().getPalette().end();
          it ++)
-        this->writer.write(*it, 24);
+        writer.write(*it, 24);
 }
 
-void GIFencoder::writeData(vector<output_struct> &output)
+void GIFencoder::writeData(vector<output_struct> &output, GIFwriter &writer)
 {
     // LZW Min code size
-    this->writer.write(output.front().size-1, 8);
+    writer.write(output.front().size-1, 8);
 
     unsigned int rest_length = 0;
     unsigned int rest_of_data = 0;
 
+    // Written records are skipped instead of erased from front
+    vector<output_struct>::iterator next = output.begin();
+
     // While there is something to write
-    while (!output.empty())
+    while (next != output.end())
     {
         // Current length is 0 + rest_length
         unsigned int length = rest_length;
 
         // Determines number of bites that can be read
         bool broken = false;
-        for (vector<output_struct>::iterator it = output.begin();
+        for (vector<output_struct>::iterator it = next;
              it != output.end();
              it++)
         {
@@ -246,24 +375,24 @@ void GIFencoder::writeData(vector<output_struct> &output)
 
         for (; i < length;)
         {
-            if (output.empty())
+            if (next == output.end())
                 throw "Not all data was written";
 
-            i += output.front().size;
-            this->writer.write(output.front().index, output.front().size);
-            output.erase(output.begin());
+            i += next->size;
+            writer.write(next->index, next->size);
+            next++;
         }
 
         // Splits last record to next frame
-        if (output.size() != 0 && (2040 - length != 0))
+        if (next != output.end() && (2040 - length != 0))
         {
             unsigned int to_be_written = 2040 - length;
             i+= to_be_written;
-            rest_length = output.front().size - to_be_written;
+            rest_length = next->size - to_be_written;
             length = rest_length;
-            rest_of_data = output.front().index >> to_be_written;
-            writer.write(output.front().index, to_be_written);
-            output.erase(output.begin());
+            rest_of_data = next->index >> to_be_written;
+            writer.write(next->index, to_be_written);
+            next++;
         }
 
         else
@@ -276,21 +405,85 @@ void GIFencoder::writeData(vector<output_struct> &output)
     writer.write(0, 8);
 }
 
-void GIFencoder::writeSubBlock(SubBlock &block)
+void GIFencoder::writeSubBlock(SubBlock &block, GIFwriter &writer)
 {
+    Mat indices;
+
+    // Maps colors to palette indexes, LZW runs over index plane
+    this->mapColors(block, indices);
+
     // Encodes using LZW
-    vector<output_struct> output = this->LZW(block);
+    vector<output_struct> output = this->LZW(block, indices);
 
     // No data
     if (output.empty())
         return;
 
     // Writes image Descriptor
-    this->writeImageDescriptor(block);
+    this->writeImageDescriptor(block, writer);
 
     // Writes color palette
-    this->writePalette(block);
+    this->writePalette(block, writer);
 
     // Writes data
-    this->writeData(output);
+    this->writeData(output, writer);
+}
+
+/**
+ * @brief Pool task, encodes subblock into memory and releases its LZW records
+ * @param argument Pointer to SubBlockTask
+ */
+void GIFencoder::encodeSubBlockTask(void *argument)
+{
+    SubBlockTask *task = (SubBlockTask *)argument;
+
+    // Exceptions can not leave pool thread
+    try
+    {
+        GIFwriter writer;
+        task->encoder->writeSubBlock(*task->block, writer);
+        task->data = writer.getData();
+    }
+    catch (const char *error)
+    {
+        task->error = error;
+    }
+    catch (const bad_alloc &)
+    {
+        task->error = "Out of memory while encoding tile";
+    }
+    catch (...)
+    {
+        task->error = "Unable to encode tile";
+    }
+
+    task->block->getDictionary().freeRecords();
+}
+
+/**
+ * @brief Encodes all subblocks on pool threads and writes them in order
+ */
+void GIFencoder::writeSubBlocks()
+{
+    vector<SubBlockTask> tasks(this->subimages.size());
+
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        tasks[i].encoder = this;
+        tasks[i].block = &this->subimages[i];
+        tasks[i].error = NULL;
+    }
+
+    int64 start = getTickCount();
+    if (!tasks.empty())
+        runTasks(this->threads, encodeSubBlockTask, &tasks[0], sizeof(SubBlockTask), tasks.size());
+    this->times.lzw = (getTickCount() - start) / getTickFrequency();
+
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+        if (tasks[i].error != NULL)
+            throw tasks[i].error;
+
+        this->writer.append(tasks[i].data);
+    }
 }
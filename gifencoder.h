@@ -7,6 +7,9 @@
 #include "subblock.h"
 #include "gifwriter.h"
 #include "gifdictionary.h"
+#include "colorhistogram.h"
+#include "quantizer.h"
+#include "threadpool.h"
 
 using namespace cv;
 using namespace std;
@@ -29,21 +32,59 @@ struct output_struct
     }
 };
 
+/**
+ * @brief Wall time of encoder phases in seconds
+ */
+struct EncoderTimes
+{
+    double quantize;    ///< Color histogram, quantization and subblock palettes
+    double lzw;         ///< Color mapping, LZW and sub block packing of all subblocks
+    double write;       ///< Header and encoded subblocks written to output file
+};
+
+class GIFencoder;
+
+/**
+ * @brief SubBlock encoded into memory by pool task
+ */
+struct SubBlockTask
+{
+    GIFencoder *encoder;
+    SubBlock *block;
+    string data;
+    const char *error;
+};
+
 class GIFencoder
 {
 private:
     vector<SubBlock> subimages;
     GIFwriter writer;
+    tTHREADPOOL pool;
+    tTHREADPOOL *threads;
+    EncoderTimes times;
 
-    void createSubBlocks(const Mat &image);
+    void createSubBlocks(const Mat &image, bool tiled, const vector<unsigned int> &colors);
+    void splitTile(const Mat &image, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
     void writeHeader(const Mat &image);
-    void writeSubBlock(SubBlock &block);
-    vector<output_struct> LZW(SubBlock & block);
-    void writeImageDescriptor(SubBlock &block);
-    void writePalette(SubBlock &block);
-    void writeData(vector<output_struct> &output);
+    void writeSubBlocks();
+    void writeSubBlock(SubBlock &block, GIFwriter &writer);
+    void mapColors(SubBlock & block, Mat &indices);
+    vector<output_struct> LZW(SubBlock & block, const Mat &indices);
+    void writeImageDescriptor(SubBlock &block, GIFwriter &writer);
+    void writePalette(SubBlock &block, GIFwriter &writer);
+    void writeData(vector<output_struct> &output, GIFwriter &writer);
+    static void encodeSubBlockTask(void *argument);
 public:
-    GIFencoder(const string &filename, const Mat &image);
+    GIFencoder(const string &filename, const Mat &image, enum quantize_level level = QUANTIZE_NORMAL,
+               enum dither_mode dither = DITHER_NONE, bool truecolor = false);
+    ~GIFencoder();
+
+    /**
+     * @brief Gets wall time of encoder phases
+     * @return Phase times
+     */
+    inline const EncoderTimes & getTimes() const {return this->times;}
 };
 
 #endif // GIFENCODER_H
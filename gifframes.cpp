@@ -0,0 +1,440 @@
+/*
+ *  File name: gifframes.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Include functions for frame by frame decoding of animated gif. Frames
+ *               are composited into one canvas, disposal "restore to previous" uses
+ *               one backup buffer, so memory does not depend on number of frames.
+ *               Parallel reader uses index of block structure and decodes window of
+ *               following frames into index planes on thread pool, frames are
+ *               composited in order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include "gifframes.h"
+#include "gif2bmp.h"
+#include "gif.h"
+#include "gifindex.h"
+#include "gifstream.h"
+#include "threadpool.h"
+#include "constant.h"
+
+// Number of frames decoded ahead for each pool thread
+#define FRAME_WINDOW_PER_THREAD 			2
+
+/**
+ * Function read gif header, get index of block structure and prepare canvas, stream
+ * has to be set. Index is checked or built only here, canvas type and parallel reader
+ * use it. Canvas of gif with transparent color is BGRA, uncovered pixels are transparent.
+ *
+ * @param frames Pointer to frame reader
+ * @param index Index from decoder options, it is built when it is NULL or does not match input
+ * @return 0 on success, 1 on failure
+ */
+static int startGifFrames(tGIFFRAMEREADER *frames, const tGIFINDEX *index) {
+
+	frames->parallel = 0;
+	frames->index = NULL;
+	initGifIndex(&frames->ownIndex);
+	frames->jobs = NULL;
+	frames->jobCount = 0;
+
+	// Init used structures
+	initStructures(frames->globalColorTable, frames->localColorTable, &frames->reader);
+
+	// Read header and global color table
+	if (getGifHeader(&frames->stream, &frames->reader, &frames->pic, frames->globalColorTable))
+		return EXIT_FAILURE;
+
+	// Broken file keeps blocks found before error, reader reports the error
+	if (index != NULL && checkGifIndex(index, &frames->stream) == EXIT_SUCCESS)
+		frames->index = index;
+	else {
+		if (index != NULL)
+			fprintf(stderr, "%s", "GIF index does not match input, index is rebuilt.\n");
+		if (buildGifIndex(&frames->stream, &frames->ownIndex))
+			return EXIT_FAILURE;
+		frames->index = &frames->ownIndex;
+	}
+
+	// Canvas starts with background color (white as in gif2bmp)
+	frames->canvas = Mat(frames->pic.heightInPixHighByte*256 + frames->pic.heightInPixLowByte,
+						 frames->pic.widthInPixHighByte*256 + frames->pic.widthInPixLowByte,
+						 hasTransparentIndexFrames(frames->index) ? CV_8UC4 : CV_8UC3, Scalar(255,255,255,0));
+	frames->backup.release();
+	frames->previous.disposalMethod = DISPOSAL_NONE;
+	frames->previous.width = 0;
+	frames->previous.height = 0;
+	frames->frameCount = 0;
+	frames->finished = 0;
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Pool task - decode image data of one frame into color index plane
+ *
+ * @param argument Pointer to frame job
+ */
+static void decodeFrameTask(void *argument) {
+
+	tGIFFRAMEJOB *job = (tGIFFRAMEJOB *)argument;
+	tGIFFRAMEREADER *frames = job->frames;
+	u_int32_t writtenPixels = 0;
+
+	int result = decodeGifIndexFrame(&frames->stream, frames->index, job->frame, &job->reader, job->indices, NULL, &writtenPixels);
+
+	pthread_mutex_lock(&frames->jobMutex);
+	job->writtenPixels = writtenPixels;
+	job->result = result;
+	job->done = 1;
+	pthread_cond_broadcast(&frames->jobDone);
+	pthread_mutex_unlock(&frames->jobMutex);
+}
+
+/**
+ * Function submit decoding of frame, frames behind the end are ignored
+ *
+ * @param frames Pointer to frame reader
+ * @param job Pointer to free frame job
+ * @param index Frame index
+ */
+static void startFrameJob(tGIFFRAMEREADER *frames, tGIFFRAMEJOB *job, u_int32_t index) {
+
+	if (index >= frames->index->frameCount)
+		return;
+
+	job->frame = index;
+	job->done = 0;
+
+	// Decode in calling thread when task can not be queued
+	if (submitTask(&frames->pool, decodeFrameTask, job))
+		decodeFrameTask(job);
+}
+
+/**
+ * Function start thread pool and first window of frame jobs, index of frame reader
+ * has to be set
+ *
+ * @param frames Pointer to frame reader
+ * @param threads Number of pool threads
+ * @return 0 on success, 1 on failure
+ */
+static int startParallelFrames(tGIFFRAMEREADER *frames, int threads) {
+
+	int jobCount = threads * FRAME_WINDOW_PER_THREAD;
+	frames->jobs = new (std::nothrow) tGIFFRAMEJOB[jobCount];
+	if (frames->jobs == NULL)
+		return EXIT_FAILURE;
+
+	for (frames->jobCount = 0; frames->jobCount < jobCount; frames->jobCount++) {
+		tGIFFRAMEJOB *job = &frames->jobs[frames->jobCount];
+		job->frames = frames;
+		job->done = 1;
+		job->result = EXIT_SUCCESS;
+		if (initGifReader(&job->reader))
+			return EXIT_FAILURE;
+	}
+
+	pthread_mutex_init(&frames->jobMutex, NULL);
+	pthread_cond_init(&frames->jobDone, NULL);
+	if (initThreadPool(&frames->pool, threads)) {
+		pthread_mutex_destroy(&frames->jobMutex);
+		pthread_cond_destroy(&frames->jobDone);
+		return EXIT_FAILURE;
+	}
+	frames->parallel = 1;
+
+	for (int i = 0; i < frames->jobCount; i++)
+		startFrameJob(frames, &frames->jobs[i], i);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function return number of pool threads from decoder options
+ *
+ * @param options Pointer to decoder options, can be NULL
+ * @return Number of threads, 1 for sequential reader
+ */
+static int getFrameThreads(const tGIFDECODE_OPTIONS *options) {
+
+	if (options == NULL)
+		return 1;
+
+	// All CPUs
+	if (options->threads <= 0)
+		return getCpuCount();
+
+	return options->threads;
+}
+
+/**
+ * Function init frame reader for gif in caller provided memory
+ *
+ * @param data Pointer to GIF data, has to be valid until frame reader is closed
+ * @param size Size of data in bytes
+ * @param frames Pointer to frame reader
+ * @param options Pointer to decoder options (threads, index), NULL for sequential reader
+ */
+void initGifFrames(const u_int8_t *data, size_t size, tGIFFRAMEREADER *frames, const tGIFDECODE_OPTIONS *options) {
+
+	initGifStream(&frames->stream, data, size);
+
+	if (initGifReader(&frames->reader))
+		throw "Not enough memory.";
+
+	if (startGifFrames(frames, options != NULL ? options->index : NULL)) {
+		closeGifFrames(frames);
+		throw "Incorrect gif file.";
+	}
+
+	int threads = getFrameThreads(options);
+	if (threads > 1 && startParallelFrames(frames, threads)) {
+		closeGifFrames(frames);
+		throw "Not enough memory.";
+	}
+}
+
+/**
+ * Function init frame reader for gif file, file is mapped into memory
+ *
+ * @param filename Input file name
+ * @param frames Pointer to frame reader
+ * @param options Pointer to decoder options (threads, index), NULL for sequential reader
+ */
+void openGifFrames(const string &filename, tGIFFRAMEREADER *frames, const tGIFDECODE_OPTIONS *options) {
+
+	if (openGifStream(filename.c_str(), &frames->stream))
+		throw "Unable to open input file";
+
+	if (initGifReader(&frames->reader)) {
+		closeGifStream(&frames->stream);
+		throw "Not enough memory.";
+	}
+
+	if (startGifFrames(frames, options != NULL ? options->index : NULL)) {
+		closeGifFrames(frames);
+		throw "Incorrect gif file.";
+	}
+
+	int threads = getFrameThreads(options);
+	if (threads > 1 && startParallelFrames(frames, threads)) {
+		closeGifFrames(frames);
+		throw "Not enough memory.";
+	}
+}
+
+/**
+ * Function free frame reader buffers and unmap input file
+ *
+ * @param frames Pointer to frame reader
+ */
+void closeGifFrames(tGIFFRAMEREADER *frames) {
+
+	// Running jobs use stream and job readers
+	if (frames->parallel) {
+		waitThreadPool(&frames->pool);
+		freeThreadPool(&frames->pool);
+		pthread_mutex_destroy(&frames->jobMutex);
+		pthread_cond_destroy(&frames->jobDone);
+		frames->parallel = 0;
+	}
+
+	for (int i = 0; i < frames->jobCount; i++)
+		freeGifReader(&frames->jobs[i].reader);
+	delete [] frames->jobs;
+	frames->jobs = NULL;
+	frames->jobCount = 0;
+
+	freeGifIndex(&frames->ownIndex);
+	frames->index = NULL;
+
+	freeGifReader(&frames->reader);
+	closeGifStream(&frames->stream);
+	frames->canvas.release();
+	frames->backup.release();
+}
+
+/**
+ * Function return frame area clipped to canvas
+ *
+ * @param canvas Canvas matrix
+ * @param frame Pointer to frame
+ * @return Clipped frame area, can be empty
+ */
+static Rect getFrameArea(const Mat &canvas, const tGIFFRAME *frame) {
+
+	int left = min(frame->left, canvas.cols);
+	int top = min(frame->top, canvas.rows);
+	int right = min(frame->left + frame->width, canvas.cols);
+	int bottom = min(frame->top + frame->height, canvas.rows);
+
+	return Rect(left, top, right - left, bottom - top);
+}
+
+/**
+ * Function apply disposal method of previous frame to canvas
+ *
+ * @param frames Pointer to frame reader
+ */
+static void disposeGifFrame(tGIFFRAMEREADER *frames) {
+
+	Rect area = getFrameArea(frames->canvas, &frames->previous);
+
+	if (area.width == 0 || area.height == 0)
+		return;
+
+	switch (frames->previous.disposalMethod) {
+		case DISPOSAL_BACKGROUND:
+			frames->canvas(area).setTo(Scalar(255,255,255,0));
+			break;
+		case DISPOSAL_PREVIOUS:
+			frames->backup(area).copyTo(frames->canvas(area));
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * Function fill frame properties, apply disposal of previous frame and save
+ * area for "restore to previous" disposal
+ *
+ * @param frames Pointer to frame reader
+ * @param frame Pointer to output frame
+ * @param control Graphic control of frame
+ * @param bitMapWriter Writer initialized from image descriptor
+ */
+static void beginGifFrame(tGIFFRAMEREADER *frames, tGIFFRAME *frame, const tGRAPHIC_CONTROL *control, tBITMAPWRITER *bitMapWriter) {
+
+	// Canvas is modified by next frame only now
+	disposeGifFrame(frames);
+
+	frame->index = frames->frameCount++;
+	frame->delayTime = control->delayTime;
+	frame->disposalMethod = control->disposalMethod;
+	frame->transparentIndex = control->transparentColorFlag ? control->transparentColorIndex : NO_TRANSPARENT_COLOR;
+	frame->left = bitMapWriter->actualX;
+	frame->top = bitMapWriter->actualY;
+	frame->width = bitMapWriter->actualWidth;
+	frame->height = bitMapWriter->actualHeight;
+
+	// Save area which is restored after this frame
+	if (frame->disposalMethod == DISPOSAL_PREVIOUS) {
+		Rect area = getFrameArea(frames->canvas, frame);
+
+		if (frames->backup.empty())
+			frames->backup.create(frames->canvas.rows, frames->canvas.cols, frames->canvas.type());
+		if (area.width > 0 && area.height > 0)
+			frames->canvas(area).copyTo(frames->backup(area));
+	}
+
+	// Transparent pixels keep canvas
+	bitMapWriter->transparentIndex = frame->transparentIndex;
+	bitMapWriter->outputMode = frames->canvas.channels() == 4 ? GIF_OUTPUT_BGRA : GIF_OUTPUT_BGR;
+}
+
+/**
+ * Function composite frame decoded by pool thread and start decoding of next frame
+ * in the window
+ *
+ * @param frames Pointer to frame reader
+ * @param frame Pointer to output frame, image shares canvas data
+ * @return 1 when frame was read, 0 at the end of gif
+ */
+static int readParallelFrame(tGIFFRAMEREADER *frames, tGIFFRAME *frame) {
+
+	tGIFSTREAM stream;
+	tIMAGE_DESCRIPTOR imageDescriptor;
+	tBITMAPWRITER bitMapWriter;
+	u_int32_t index = frames->frameCount;
+
+	if (index >= frames->index->frameCount) {
+		frames->finished = 1;
+		if (!frames->index->complete)
+			throw "Incorrect gif file.";
+		return 0;
+	}
+
+	const tGIFINDEXFRAME *info = &frames->index->frames[index];
+	tGIFFRAMEJOB *job = &frames->jobs[index % frames->jobCount];
+
+	// Wait for decoded index plane
+	pthread_mutex_lock(&frames->jobMutex);
+	while (!job->done)
+		pthread_cond_wait(&frames->jobDone, &frames->jobMutex);
+	pthread_mutex_unlock(&frames->jobMutex);
+
+	if (job->result)
+		throw "Incorrect gif file.";
+
+	// Read descriptor and color table again for writer
+	initGifStream(&stream, frames->stream.data + info->descriptorOffset, frames->stream.size - info->descriptorOffset);
+	if (getImageHeader(&stream, &frames->reader, &frames->pic, frames->globalColorTable, frames->localColorTable, &imageDescriptor, &bitMapWriter))
+		throw "Incorrect gif file.";
+
+	beginGifFrame(frames, frame, &info->control, &bitMapWriter);
+
+	// Pixels behind the image wrap to the first row as in sequential decoder
+	u_int32_t pixels = job->writtenPixels;
+	if (pixels > imageDescriptor.sizeInPixels)
+		pixels = imageDescriptor.sizeInPixels;
+	drawIndexPlane(job->indices, pixels, frames->canvas, &bitMapWriter);
+
+	// Job is free for next frame of the window
+	startFrameJob(frames, job, index + frames->jobCount);
+
+	frames->previous = *frame;
+	frame->image = frames->canvas;
+
+	return 1;
+}
+
+/**
+ * Function decode next frame and composite it into canvas
+ *
+ * @param frames Pointer to frame reader
+ * @param frame Pointer to output frame, image shares canvas data
+ * @return 1 when frame was read, 0 at the end of gif
+ */
+int readGifFrame(tGIFFRAMEREADER *frames, tGIFFRAME *frame) {
+
+	tGRAPHIC_CONTROL control;
+	tIMAGE_DESCRIPTOR imageDescriptor;
+	tBITMAPWRITER bitMapWriter;
+	u_int8_t Byte = 0;
+
+	if (frames->finished)
+		return 0;
+
+	if (frames->parallel)
+		return readParallelFrame(frames, frame);
+
+	// Find next image, control values are valid only for it
+	initGraphicControl(&control);
+	if (getNextBlock(&frames->stream, &control, NULL, &Byte))
+		throw "Incorrect gif file.";
+
+	if (Byte == GIF_END_OF_FILE) {
+		frames->finished = 1;
+		return 0;
+	}
+
+	if (getImageHeader(&frames->stream, &frames->reader, &frames->pic, frames->globalColorTable, frames->localColorTable, &imageDescriptor, &bitMapWriter))
+		throw "Incorrect gif file.";
+
+	beginGifFrame(frames, frame, &control, &bitMapWriter);
+
+	// Composite frame
+	if (getImageData(&frames->stream, &frames->reader, frames->canvas, &bitMapWriter))
+		throw "Incorrect gif file.";
+
+	frames->previous = *frame;
+	frame->image = frames->canvas;
+
+	return 1;
+}
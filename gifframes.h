@@ -0,0 +1,82 @@
+/*
+ *  File name: gifframes.h
+ *  Created on: 17. 10. 2026
+ *  Type: Header file
+ *  Description: Include functions declarations for frame by frame decoding of animated gif
+ */
+
+#include <cv.h>
+#include <string>
+#include <pthread.h>
+#include "constant.h"
+#include "threadpool.h"
+
+using namespace std;
+using namespace cv;
+
+#ifndef GIFFRAMES_H_
+#define GIFFRAMES_H_
+
+/**
+ * @brief Composited animation frame, image is shared with frame reader canvas
+ * (BGRA when gif has transparent color, BGR otherwise) and stays valid until
+ * next frame is read
+ */
+typedef struct{
+	Mat image;
+	int index;
+	u_int16_t delayTime;
+	u_int8_t disposalMethod;
+	int transparentIndex;
+	int left;
+	int top;
+	int width;
+	int height;
+} tGIFFRAME;
+
+typedef struct tGIFFRAMEREADER tGIFFRAMEREADER;
+
+/**
+ * @brief Image block decoded by pool thread into color index plane
+ */
+typedef struct{
+	tGIFFRAMEREADER *frames;
+	u_int32_t frame;
+	tGIFREADER reader;
+	Mat indices;
+	u_int32_t writtenPixels;
+	int result;
+	int done;
+} tGIFFRAMEJOB;
+
+/**
+ * @brief Frame reader - single canvas and one backup buffer for whole animation.
+ * Parallel reader decodes window of following frames on thread pool.
+ */
+struct tGIFFRAMEREADER{
+	tGIFSTREAM stream;
+	tGIFREADER reader;
+	tPIC_PROPERTY pic;
+	tRGB globalColorTable[NUMBER_OF_COLORS];
+	tRGB localColorTable[NUMBER_OF_COLORS];
+	Mat canvas;
+	Mat backup;
+	tGIFFRAME previous;
+	int frameCount;
+	int finished;
+	int parallel;
+	tGIFINDEX ownIndex;
+	const tGIFINDEX *index;
+	tTHREADPOOL pool;
+	tGIFFRAMEJOB *jobs;
+	int jobCount;
+	pthread_mutex_t jobMutex;
+	pthread_cond_t jobDone;
+};
+
+void initGifFrames(const u_int8_t *data, size_t size, tGIFFRAMEREADER *frames, const tGIFDECODE_OPTIONS *options);
+void openGifFrames(const string &filename, tGIFFRAMEREADER *frames, const tGIFDECODE_OPTIONS *options);
+int readGifFrame(tGIFFRAMEREADER *frames, tGIFFRAME *frame);
+void closeGifFrames(tGIFFRAMEREADER *frames);
+
+#endif /* GIFFRAMES_H_ */
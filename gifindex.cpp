@@ -0,0 +1,543 @@
+/*
+ *  File name: gifindex.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Include functions for GIF block structure index. Index is built by
+ *               hopping over sub block lengths without LZW decompression, it is used
+ *               for random frame access, parallel decoding and metadata queries and
+ *               it can be saved to file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gif2bmp.h"
+#include "gif.h"
+#include "gifindex.h"
+#include "gifstream.h"
+#include "constant.h"
+
+// Serialized record sizes in bytes
+#define GIFINDEX_HEADER_SIZE 				(GIFINDEX_MAGIC_SIZE + 8 + LOGICAL_SCREEN_DESCRIPTOR_SIZE + 4 + 1 + 8 + 4)
+#define GIFINDEX_FRAME_SIZE 				51
+
+/**
+ * Function init empty index
+ *
+ * @param index Pointer to index
+ */
+void initGifIndex(tGIFINDEX *index) {
+
+	memset(index, 0, sizeof(tGIFINDEX));
+	index->loopCount = -1;
+}
+
+/**
+ * Function free index frame records
+ *
+ * @param index Pointer to index
+ */
+void freeGifIndex(tGIFINDEX *index) {
+
+	free(index->frames);
+	initGifIndex(index);
+}
+
+/**
+ * Function clear index, frame records buffer is kept for next build
+ *
+ * @param index Pointer to index
+ */
+static void resetGifIndex(tGIFINDEX *index) {
+
+	tGIFINDEXFRAME *frames = index->frames;
+	u_int32_t frameCapacity = index->frameCapacity;
+	u_int32_t allocations = index->allocations;
+
+	initGifIndex(index);
+	index->frames = frames;
+	index->frameCapacity = frameCapacity;
+	index->allocations = allocations;
+}
+
+/**
+ * Function return pointer to new frame record at the end of index
+ *
+ * @param index Pointer to index
+ * @return Pointer to frame record, NULL when memory can not be allocated
+ */
+static tGIFINDEXFRAME *addGifIndexFrame(tGIFINDEX *index) {
+
+	if (index->frameCount == index->frameCapacity) {
+		u_int32_t capacity = index->frameCapacity ? index->frameCapacity * 2 : 64;
+		tGIFINDEXFRAME *frames = (tGIFINDEXFRAME *)realloc(index->frames, capacity * sizeof(tGIFINDEXFRAME));
+		if (frames == NULL)
+			return NULL;
+
+		index->frames = frames;
+		index->frameCapacity = capacity;
+		index->allocations++;
+	}
+
+	return &index->frames[index->frameCount];
+}
+
+/**
+ * Function set screen properties of index from logical screen descriptor
+ *
+ * @param index Pointer to index with saved screen descriptor
+ */
+static void setGifIndexScreen(tGIFINDEX *index) {
+
+	const u_int8_t *descriptor = index->screenDescriptor;
+
+	index->width = descriptor[0] + descriptor[1]*256;
+	index->height = descriptor[2] + descriptor[3]*256;
+	index->globalColorTable = (u_int8_t)((descriptor[4] & GIFMASK_GLOBAL_COLOR_PALETTE) >> 7);
+	index->globalColorTableSize = index->globalColorTable ? 2 << (descriptor[4] & GIFMASK_GLOBAL_COLOR_PALETTE_SIZE) : 0;
+	index->backgroundColor = descriptor[5];
+	index->pixelAspectRatio = descriptor[6];
+}
+
+/**
+ * Function build index of GIF block structure, image data are skipped by sub block
+ * lengths. Broken block structure behind header is not error, frames found before
+ * it are kept and index is marked incomplete.
+ *
+ * @param stream Pointer to input stream, whole data are indexed
+ * @param index Pointer to index, has to be initialized
+ * @return 0 on success, 1 on failure (incorrect header or not enough memory)
+ */
+int buildGifIndex(const tGIFSTREAM *stream, tGIFINDEX *index) {
+
+	tGIFSTREAM view;
+	tGRAPHIC_CONTROL control;
+	tIMAGE_DESCRIPTOR imageDescriptor;
+	u_int8_t Byte = 0;
+
+	resetGifIndex(index);
+	initGifStream(&view, stream->data, stream->size);
+	index->sourceSize = stream->size;
+
+	// Header and logical screen descriptor
+	if (checkGifVersion(&view))
+		return EXIT_FAILURE;
+
+	const u_int8_t *descriptor = takeFromStream(&view, LOGICAL_SCREEN_DESCRIPTOR_SIZE);
+	if (descriptor == NULL)
+		return EXIT_FAILURE;
+
+	memcpy(index->screenDescriptor, descriptor, LOGICAL_SCREEN_DESCRIPTOR_SIZE);
+	setGifIndexScreen(index);
+
+	// Skip global color table
+	index->globalColorTableOffset = view.position;
+	if (takeFromStream(&view, index->globalColorTableSize * 3) == NULL)
+		return EXIT_FAILURE;
+
+	while (1) {
+
+		initGraphicControl(&control);
+		if (getNextBlock(&view, &control, &index->loopCount, &Byte))
+			return EXIT_SUCCESS;
+
+		if (Byte == GIF_END_OF_FILE) {
+			index->complete = 1;
+			return EXIT_SUCCESS;
+		}
+
+		tGIFINDEXFRAME *frame = addGifIndexFrame(index);
+		if (frame == NULL)
+			return EXIT_FAILURE;
+
+		frame->descriptorOffset = view.position;
+		if (getImageDescriptor(&view, &imageDescriptor))
+			return EXIT_SUCCESS;
+
+		frame->left = imageDescriptor.leftPosLowByte + imageDescriptor.leftPosHighByte*256;
+		frame->top = imageDescriptor.topPosLowByte + imageDescriptor.topPosHighByte*256;
+		frame->width = imageDescriptor.widthLowByte + imageDescriptor.widthHighByte*256;
+		frame->height = imageDescriptor.heightLowByte + imageDescriptor.heightHighByte*256;
+		frame->localColorTable = imageDescriptor.localColorTableFlag;
+		frame->interlaced = imageDescriptor.interlaceFlag;
+		frame->control = control;
+
+		// Local color table or global one (its size is used even if it is missing)
+		if (frame->localColorTable) {
+			frame->colorTableOffset = view.position;
+			frame->colorTableSize = imageDescriptor.localColorTableSize;
+			if (takeFromStream(&view, imageDescriptor.localColorTableSize * 3) == NULL)
+				return EXIT_SUCCESS;
+		}
+		else {
+			frame->colorTableOffset = index->globalColorTableOffset;
+			frame->colorTableSize = 2 << (index->screenDescriptor[4] & GIFMASK_GLOBAL_COLOR_PALETTE_SIZE);
+		}
+
+		// LZW size and image data sub block chain
+		frame->dataOffset = view.position;
+		if (readByteFromStream(&view, &frame->lzwSize) != READ_WRITE_OK || skipSubBlocks(&view))
+			return EXIT_SUCCESS;
+		frame->dataLength = view.position - frame->dataOffset;
+
+		index->frameCount++;
+	}
+}
+
+/**
+ * Function check that byte range lies inside input, sum of offset and length is
+ * never computed so it can not overflow
+ *
+ * @param offset Range offset
+ * @param length Range length
+ * @param size Input size
+ * @return 1 when range is inside input, 0 otherwise
+ */
+static int isGifIndexRange(u_int64_t offset, u_int64_t length, u_int64_t size) {
+
+	return offset <= size && length <= size - offset;
+}
+
+/**
+ * Function check if color table size is power of two between 2 and 256
+ *
+ * @param size Color table size
+ * @return 1 when size is valid, 0 otherwise
+ */
+static int isGifIndexTableSize(u_int32_t size) {
+
+	return size >= 2 && size <= NUMBER_OF_COLORS && (size & (size - 1)) == 0;
+}
+
+/**
+ * Function check that index was built from input data. Index can be loaded from
+ * file, so every offset is bounds checked and every frame record has to match its
+ * image descriptor in input before decoder uses it.
+ *
+ * @param index Pointer to index
+ * @param stream Pointer to input stream
+ * @return 0 when index matches input, 1 otherwise
+ */
+int checkGifIndex(const tGIFINDEX *index, const tGIFSTREAM *stream) {
+
+	const u_int64_t descriptorSize = IMAGE_DESCRIPTOR_SIZE - 1;
+	const u_int64_t globalOffset = 6 + LOGICAL_SCREEN_DESCRIPTOR_SIZE;
+
+	if (index->sourceSize != stream->size || stream->size < globalOffset)
+		return EXIT_FAILURE;
+
+	if (memcmp(index->screenDescriptor, stream->data + 6, LOGICAL_SCREEN_DESCRIPTOR_SIZE) != 0)
+		return EXIT_FAILURE;
+
+	// Global color table follows screen descriptor, its size is used by frames without local one
+	u_int32_t globalSize = 2 << (index->screenDescriptor[4] & GIFMASK_GLOBAL_COLOR_PALETTE_SIZE);
+	if (index->frameCount > 0 && index->globalColorTableOffset != globalOffset)
+		return EXIT_FAILURE;
+	if (index->globalColorTable && !isGifIndexRange(globalOffset, globalSize * 3, stream->size))
+		return EXIT_FAILURE;
+
+	// Every image block has to start on indexed position
+	for (u_int32_t i = 0; i < index->frameCount; i++) {
+		const tGIFINDEXFRAME *frame = &index->frames[i];
+
+		if (frame->descriptorOffset == 0 || !isGifIndexRange(frame->descriptorOffset, descriptorSize, stream->size))
+			return EXIT_FAILURE;
+		if (stream->data[frame->descriptorOffset - 1] != IMAGE_DESCRIPTOR_INTRODUCER)
+			return EXIT_FAILURE;
+
+		// Frame record has to match image descriptor
+		const u_int8_t *descriptor = stream->data + frame->descriptorOffset;
+		if (frame->left != descriptor[0] + descriptor[1]*256 || frame->top != descriptor[2] + descriptor[3]*256 ||
+			frame->width != descriptor[4] + descriptor[5]*256 || frame->height != descriptor[6] + descriptor[7]*256)
+			return EXIT_FAILURE;
+		if (frame->localColorTable != ((descriptor[8] & GIFMASK_LOCAL_COLOR_PALETTE) != 0) ||
+			frame->interlaced != ((descriptor[8] & GIFMASK_LOCAL_INTERLACE) != 0))
+			return EXIT_FAILURE;
+
+		// Color table is read into table of NUMBER_OF_COLORS entries
+		if (!isGifIndexTableSize(frame->colorTableSize))
+			return EXIT_FAILURE;
+
+		u_int64_t dataOffset = frame->descriptorOffset + descriptorSize;
+		if (frame->localColorTable) {
+			if (frame->colorTableOffset != dataOffset ||
+				frame->colorTableSize != 2 << (descriptor[8] & GIFMASK_LOCAL_COLOR_PALETTE_SIZE) ||
+				!isGifIndexRange(frame->colorTableOffset, frame->colorTableSize * 3, stream->size))
+				return EXIT_FAILURE;
+			dataOffset += frame->colorTableSize * 3;
+		}
+		else if (frame->colorTableOffset != globalOffset || frame->colorTableSize != globalSize)
+			return EXIT_FAILURE;
+
+		// LZW size byte and sub block chain
+		if (frame->dataOffset != dataOffset || frame->dataLength == 0 ||
+			!isGifIndexRange(frame->dataOffset, frame->dataLength, stream->size))
+			return EXIT_FAILURE;
+		if (stream->data[frame->dataOffset] != frame->lzwSize)
+			return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function check if some indexed frame has transparent color, index is not checked
+ *
+ * @param index Pointer to index
+ * @return 1 if some frame has transparent color, 0 otherwise
+ */
+int hasTransparentIndexFrames(const tGIFINDEX *index) {
+
+	for (u_int32_t i = 0; i < index->frameCount; i++)
+		if (index->frames[i].control.transparentColorFlag)
+			return 1;
+
+	return 0;
+}
+
+/**
+ * Function check if some image block of GIF has transparent color. Index is used
+ * when it matches input, otherwise block structure is scanned (image data are skipped).
+ *
+ * @param stream Pointer to input stream
+ * @param index Pointer to index of input, can be NULL
+ * @return 1 if some image block has transparent color, 0 otherwise
+ */
+int hasTransparentFrames(const tGIFSTREAM *stream, const tGIFINDEX *index) {
+
+	tGIFINDEX ownIndex;
+
+	// Broken file keeps blocks found before error, decoder reports the error
+	initGifIndex(&ownIndex);
+	if (index == NULL || checkGifIndex(index, stream) != EXIT_SUCCESS) {
+		buildGifIndex(stream, &ownIndex);
+		index = &ownIndex;
+	}
+
+	int transparent = hasTransparentIndexFrames(index);
+
+	freeGifIndex(&ownIndex);
+	return transparent;
+}
+
+/**
+ * Function save little endian value into buffer and move buffer pointer
+ *
+ * @param buffer Pointer to buffer pointer
+ * @param value Saved value
+ * @param bytes Number of bytes
+ */
+static void putIndexValue(u_int8_t **buffer, u_int64_t value, int bytes) {
+
+	for (int i = 0; i < bytes; i++)
+		*(*buffer)++ = (u_int8_t)(value >> (8 * i));
+}
+
+/**
+ * Function read little endian value from buffer and move buffer pointer
+ *
+ * @param buffer Pointer to buffer pointer
+ * @param bytes Number of bytes
+ * @return Read value
+ */
+static u_int64_t getIndexValue(const u_int8_t **buffer, int bytes) {
+
+	u_int64_t value = 0;
+
+	for (int i = 0; i < bytes; i++)
+		value |= (u_int64_t)*(*buffer)++ << (8 * i);
+
+	return value;
+}
+
+/**
+ * Function save index into file (little endian, independent on platform)
+ *
+ * @param index Pointer to index
+ * @param filename Output file name
+ * @return 0 on success, 1 on failure
+ */
+int saveGifIndex(const tGIFINDEX *index, const char *filename) {
+
+	u_int8_t header[GIFINDEX_HEADER_SIZE];
+	u_int8_t record[GIFINDEX_FRAME_SIZE];
+	u_int8_t *p = header;
+
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL)
+		return EXIT_FAILURE;
+
+	memcpy(p, GIFINDEX_MAGIC, GIFINDEX_MAGIC_SIZE);
+	p += GIFINDEX_MAGIC_SIZE;
+	putIndexValue(&p, index->sourceSize, 8);
+	memcpy(p, index->screenDescriptor, LOGICAL_SCREEN_DESCRIPTOR_SIZE);
+	p += LOGICAL_SCREEN_DESCRIPTOR_SIZE;
+	putIndexValue(&p, (u_int32_t)index->loopCount, 4);
+	putIndexValue(&p, index->complete, 1);
+	putIndexValue(&p, index->globalColorTableOffset, 8);
+	putIndexValue(&p, index->frameCount, 4);
+
+	int result = fwrite(header, sizeof(header), 1, file) == 1 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+	for (u_int32_t i = 0; i < index->frameCount && result == EXIT_SUCCESS; i++) {
+		const tGIFINDEXFRAME *frame = &index->frames[i];
+
+		p = record;
+		putIndexValue(&p, frame->descriptorOffset, 8);
+		putIndexValue(&p, frame->colorTableOffset, 8);
+		putIndexValue(&p, frame->dataOffset, 8);
+		putIndexValue(&p, frame->dataLength, 8);
+		putIndexValue(&p, frame->left, 2);
+		putIndexValue(&p, frame->top, 2);
+		putIndexValue(&p, frame->width, 2);
+		putIndexValue(&p, frame->height, 2);
+		putIndexValue(&p, frame->colorTableSize, 2);
+		putIndexValue(&p, frame->localColorTable, 1);
+		putIndexValue(&p, frame->interlaced, 1);
+		putIndexValue(&p, frame->lzwSize, 1);
+		putIndexValue(&p, frame->control.disposalMethod, 1);
+		putIndexValue(&p, frame->control.userInputFlag, 1);
+		putIndexValue(&p, frame->control.transparentColorFlag, 1);
+		putIndexValue(&p, frame->control.delayTime, 2);
+		putIndexValue(&p, frame->control.transparentColorIndex, 1);
+
+		if (fwrite(record, sizeof(record), 1, file) != 1)
+			result = EXIT_FAILURE;
+	}
+
+	if (fclose(file))
+		result = EXIT_FAILURE;
+
+	return result;
+}
+
+/**
+ * Function load index from file saved by saveGifIndex
+ *
+ * @param filename Input file name
+ * @param index Pointer to index, has to be initialized
+ * @return 0 on success, 1 on failure
+ */
+int loadGifIndex(const char *filename, tGIFINDEX *index) {
+
+	u_int8_t header[GIFINDEX_HEADER_SIZE];
+	u_int8_t record[GIFINDEX_FRAME_SIZE];
+	const u_int8_t *p = header;
+
+	freeGifIndex(index);
+
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL)
+		return EXIT_FAILURE;
+
+	if (fread(header, sizeof(header), 1, file) != 1 || memcmp(header, GIFINDEX_MAGIC, GIFINDEX_MAGIC_SIZE) != 0) {
+		fclose(file);
+		return EXIT_FAILURE;
+	}
+
+	p += GIFINDEX_MAGIC_SIZE;
+	index->sourceSize = getIndexValue(&p, 8);
+	memcpy(index->screenDescriptor, p, LOGICAL_SCREEN_DESCRIPTOR_SIZE);
+	p += LOGICAL_SCREEN_DESCRIPTOR_SIZE;
+	index->loopCount = (int32_t)getIndexValue(&p, 4);
+	index->complete = (int)getIndexValue(&p, 1);
+	index->globalColorTableOffset = getIndexValue(&p, 8);
+	u_int32_t frameCount = (u_int32_t)getIndexValue(&p, 4);
+	setGifIndexScreen(index);
+
+	for (u_int32_t i = 0; i < frameCount; i++) {
+
+		tGIFINDEXFRAME *frame = addGifIndexFrame(index);
+		if (frame == NULL || fread(record, sizeof(record), 1, file) != 1) {
+			fclose(file);
+			freeGifIndex(index);
+			return EXIT_FAILURE;
+		}
+
+		p = record;
+		frame->descriptorOffset = getIndexValue(&p, 8);
+		frame->colorTableOffset = getIndexValue(&p, 8);
+		frame->dataOffset = getIndexValue(&p, 8);
+		frame->dataLength = getIndexValue(&p, 8);
+		frame->left = (u_int16_t)getIndexValue(&p, 2);
+		frame->top = (u_int16_t)getIndexValue(&p, 2);
+		frame->width = (u_int16_t)getIndexValue(&p, 2);
+		frame->height = (u_int16_t)getIndexValue(&p, 2);
+		frame->colorTableSize = (u_int16_t)getIndexValue(&p, 2);
+		frame->localColorTable = (u_int8_t)getIndexValue(&p, 1);
+		frame->interlaced = (u_int8_t)getIndexValue(&p, 1);
+		frame->lzwSize = (u_int8_t)getIndexValue(&p, 1);
+		frame->control.disposalMethod = (u_int8_t)getIndexValue(&p, 1);
+		frame->control.userInputFlag = (u_int8_t)getIndexValue(&p, 1);
+		frame->control.transparentColorFlag = (u_int8_t)getIndexValue(&p, 1);
+		frame->control.delayTime = (u_int16_t)getIndexValue(&p, 2);
+		frame->control.transparentColorIndex = (u_int8_t)getIndexValue(&p, 1);
+
+		index->frameCount++;
+	}
+
+	fclose(file);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function decode image data of one indexed frame into color index plane, frame is
+ * not composited with previous frames
+ *
+ * @param stream Pointer to input stream, index has to match it
+ * @param index Pointer to index
+ * @param frame Frame number
+ * @param reader Pointer to initialized GIF reader
+ * @param indices Output color index plane (frame width x height)
+ * @param colorTable Output color table of frame, NULL to skip
+ * @param writtenPixels Output number of decoded pixels, NULL to skip
+ * @return 0 on success, 1 on failure
+ */
+int decodeGifIndexFrame(const tGIFSTREAM *stream, const tGIFINDEX *index, u_int32_t frame, tGIFREADER *reader, Mat &indices, tRGB colorTable [], u_int32_t *writtenPixels) {
+
+	tGIFSTREAM view;
+	tBITMAPWRITER bitMapWriter;
+
+	if (frame >= index->frameCount)
+		return EXIT_FAILURE;
+
+	const tGIFINDEXFRAME *info = &index->frames[frame];
+
+	// Frame color table
+	if (colorTable != NULL) {
+		memset(colorTable, 0, NUMBER_OF_COLORS * sizeof(tRGB));
+		initGifStream(&view, stream->data + info->colorTableOffset, stream->size - info->colorTableOffset);
+		if ((info->localColorTable || index->globalColorTable) && getColorTable(&view, colorTable, info->colorTableSize))
+			return EXIT_FAILURE;
+	}
+
+	// Writer of index plane
+	bitMapWriter.actualColumn = 0;
+	bitMapWriter.actualRow = 0;
+	bitMapWriter.actualWidth = info->width;
+	bitMapWriter.actualHeight = info->height;
+	bitMapWriter.actualX = 0;
+	bitMapWriter.actualY = 0;
+	bitMapWriter.outputMode = GIF_OUTPUT_INDEX;
+	bitMapWriter.rowBuffer = reader->rowBuffer;
+	bitMapWriter.transparentIndex = NO_TRANSPARENT_COLOR;
+	bitMapWriter.writtenPixels = 0;
+	bitMapWriter.interlaced = info->interlaced;
+	bitMapWriter.interlacePass = 0;
+	bitMapWriter.passLimit = GIF_INTERLACE_PASSES;
+	bitMapWriter.scale = NULL;
+	bitMapWriter.rowOutput = NULL;
+
+	reader->activeColorTableSize = info->colorTableSize;
+	reader->dataBlockSize = (u_int32_t)info->width * info->height;
+	indices.create(info->height, info->width, CV_8UC1);
+
+	// Image data are read from own view of input
+	initGifStream(&view, stream->data + info->dataOffset, stream->size - info->dataOffset);
+	int result = getImageData(&view, reader, indices, &bitMapWriter);
+
+	if (writtenPixels != NULL)
+		*writtenPixels = bitMapWriter.writtenPixels;
+
+	return result;
+}
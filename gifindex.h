@@ -0,0 +1,29 @@
+/*
+ *  File name: gifindex.h
+ *  Created on: 17. 10. 2026
+ *  Type: Header file
+ *  Description: Include functions declarations for GIF block structure index
+ */
+
+#include <cv.h>
+#include "constant.h"
+
+using namespace cv;
+
+#ifndef GIFINDEX_H_
+#define GIFINDEX_H_
+
+#define GIFINDEX_MAGIC 						"GIFINDX1"
+#define GIFINDEX_MAGIC_SIZE 				8
+
+void initGifIndex(tGIFINDEX *index);
+void freeGifIndex(tGIFINDEX *index);
+int buildGifIndex(const tGIFSTREAM *stream, tGIFINDEX *index);
+int checkGifIndex(const tGIFINDEX *index, const tGIFSTREAM *stream);
+int hasTransparentIndexFrames(const tGIFINDEX *index);
+int hasTransparentFrames(const tGIFSTREAM *stream, const tGIFINDEX *index);
+int saveGifIndex(const tGIFINDEX *index, const char *filename);
+int loadGifIndex(const char *filename, tGIFINDEX *index);
+int decodeGifIndexFrame(const tGIFSTREAM *stream, const tGIFINDEX *index, u_int32_t frame, tGIFREADER *reader, Mat &indices, tRGB colorTable [], u_int32_t *writtenPixels);
+
+#endif /* GIFINDEX_H_ */
@@ -0,0 +1,192 @@
+/*
+ *  File name: gifstream.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Include functions for GIF input stream (memory mapped file, buffered pipe
+ *               or byte span)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "gifstream.h"
+#include "constant.h"
+
+/**
+ * Function init input stream over caller provided byte span, data are not copied
+ *
+ * @param stream Pointer to input stream
+ * @param data Pointer to GIF data
+ * @param size Size of data in bytes
+ */
+void initGifStream(tGIFSTREAM *stream, const u_int8_t *data, size_t size) {
+
+	stream->data = data;
+	stream->size = size;
+	stream->position = 0;
+	stream->mapping = NULL;
+	stream->mappingSize = 0;
+	stream->buffer = NULL;
+}
+
+/**
+ * Function read whole input (standard input, pipe) into growable buffer in single pass
+ *
+ * @param fd Input file descriptor
+ * @param stream Pointer to input stream
+ * @return 0 on success, 1 on failure
+ */
+int readGifStream(int fd, tGIFSTREAM *stream) {
+
+	size_t capacity = GIF_STREAM_READ_CHUNK;
+	size_t size = 0;
+
+	initGifStream(stream, NULL, 0);
+
+	u_int8_t *buffer = (u_int8_t *)malloc(capacity);
+	if (buffer == NULL) {
+		fprintf(stderr, "%s", "Memory allocation error.");
+		return EXIT_FAILURE;
+	}
+
+	while (1) {
+
+		// Capacity is doubled, input size is not known in advance
+		if (size == capacity) {
+			u_int8_t *grown = (u_int8_t *)realloc(buffer, capacity * 2);
+			if (grown == NULL) {
+				fprintf(stderr, "%s", "Memory allocation error.");
+				free(buffer);
+				return EXIT_FAILURE;
+			}
+			buffer = grown;
+			capacity *= 2;
+		}
+
+		ssize_t count = read(fd, buffer + size, capacity - size);
+		if (count == 0)
+			break;
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "%s", "Can not read input file.");
+			free(buffer);
+			return EXIT_FAILURE;
+		}
+		size += count;
+	}
+
+	initGifStream(stream, buffer, size);
+	stream->buffer = buffer;
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function map input file into memory and init input stream over it, standard input ("-")
+ * and other files which can not be mapped (pipes, FIFOs) are read into memory
+ *
+ * @param filename Input file name, "-" for standard input
+ * @param stream Pointer to input stream
+ * @return 0 on success, 1 on failure
+ */
+int openGifStream(const char *filename, tGIFSTREAM *stream) {
+
+	struct stat fileInfo;
+
+	initGifStream(stream, NULL, 0);
+
+	if (strcmp(filename, "-") == 0)
+		return readGifStream(STDIN_FILENO, stream);
+
+	int fd = open(filename, O_RDONLY);
+	if (fd == -1) {
+		fprintf(stderr, "%s", "Can not open input file.");
+		return EXIT_FAILURE;
+	}
+
+	if (fstat(fd, &fileInfo) == -1) {
+		fprintf(stderr, "%s", "Can not read input file.");
+		close(fd);
+		return EXIT_FAILURE;
+	}
+
+	// Pipe has no size and can not be mapped
+	if (!S_ISREG(fileInfo.st_mode)) {
+		int result = readGifStream(fd, stream);
+		close(fd);
+		return result;
+	}
+
+	// Empty file can not be mapped, parser reports it
+	if (fileInfo.st_size == 0) {
+		close(fd);
+		return EXIT_SUCCESS;
+	}
+
+	void *mapping = mmap(NULL, fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		fprintf(stderr, "%s", "Can not read input file.");
+		return EXIT_FAILURE;
+	}
+
+	// File is parsed front to back
+	madvise(mapping, fileInfo.st_size, MADV_SEQUENTIAL);
+
+	initGifStream(stream, (const u_int8_t *)mapping, fileInfo.st_size);
+	stream->mapping = mapping;
+	stream->mappingSize = fileInfo.st_size;
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function unmap input file or free read buffer, caller provided span is left untouched
+ *
+ * @param stream Pointer to input stream
+ */
+void closeGifStream(tGIFSTREAM *stream) {
+
+	if (stream->mapping != NULL)
+		munmap(stream->mapping, stream->mappingSize);
+
+	free(stream->buffer);
+
+	initGifStream(stream, NULL, 0);
+}
+
+/**
+ * Function skip data sub block chain up to block terminator
+ *
+ * @param stream Pointer to input stream
+ * @return 0 on success, 1 on failure
+ */
+int skipSubBlocks(tGIFSTREAM *stream) {
+
+	u_int8_t Byte = 0;
+
+	while (1) {
+
+		// Get sub block size
+		if (readByteFromStream(stream, &Byte) != READ_WRITE_OK) {
+			fprintf(stderr, "%s", "Incorrect gif file.");
+			return EXIT_FAILURE;
+		}
+
+		if (Byte == BLOCK_TERMINATOR)
+			return EXIT_SUCCESS;
+
+		// Hop over sub block data
+		if (takeFromStream(stream, Byte) == NULL) {
+			fprintf(stderr, "%s", "Incorrect gif file.");
+			return EXIT_FAILURE;
+		}
+	}
+}
@@ -0,0 +1,54 @@
+/*
+ *  File name: gifstream.h
+ *  Created on: 17. 10. 2026
+ *  Type: Header file
+ *  Description: Include functions declarations for GIF input stream (memory mapped file,
+ *               buffered pipe or byte span)
+ */
+
+#ifndef GIFSTREAM_H_
+#define GIFSTREAM_H_
+
+#include <stdio.h>
+#include "constant.h"
+
+int openGifStream(const char *filename, tGIFSTREAM *stream);
+int readGifStream(int fd, tGIFSTREAM *stream);
+void initGifStream(tGIFSTREAM *stream, const u_int8_t *data, size_t size);
+void closeGifStream(tGIFSTREAM *stream);
+int skipSubBlocks(tGIFSTREAM *stream);
+
+/**
+ * Function read byte from input stream
+ *
+ * @param stream Pointer to input stream
+ * @param Byte Pointer to byte buffer
+ * @return status code READ_WRITE_OK on success and END_OF_FILE when end of stream is reached
+ */
+static inline u_int8_t readByteFromStream(tGIFSTREAM *stream, u_int8_t *Byte) {
+
+	if (stream->position >= stream->size)
+		return END_OF_FILE;
+
+	*Byte = stream->data[stream->position++];
+	return READ_WRITE_OK;
+}
+
+/**
+ * Function take n bytes from input stream without copying them
+ *
+ * @param stream Pointer to input stream
+ * @param size Number of bytes
+ * @return pointer to first byte, NULL when stream is shorter
+ */
+static inline const u_int8_t *takeFromStream(tGIFSTREAM *stream, size_t size) {
+
+	if (size > stream->size - stream->position)
+		return NULL;
+
+	const u_int8_t *data = stream->data + stream->position;
+	stream->position += size;
+	return data;
+}
+
+#endif /* GIFSTREAM_H_ */
@@ -1,11 +1,10 @@
 #include "gifwriter.h"
 
-unsigned long long cnt = 0;
-
 GIFwriter::GIFwriter(const string & filename)
 {
     this->overflow = 0;
     this->data = 0;
+    this->stream = &this->file;
 
     this->file.open (filename.c_str(), ios::out | ios::binary);
 
@@ -13,6 +12,16 @@ GIFwriter::GIFwriter(const string & filename)
         throw "Unable to open output gif file";
 }
 
+/**
+ * @brief Creates writer that keeps written bytes in memory
+ */
+GIFwriter::GIFwriter()
+{
+    this->overflow = 0;
+    this->data = 0;
+    this->stream = &this->memory;
+}
+
 GIFwriter::~GIFwriter()
 {
     this->file.close();
@@ -20,14 +29,14 @@ GIFwriter::~GIFwriter()
 
 void GIFwriter::write(const int &data, unsigned int length)
 {
-    this->data |= data << this->overflow;
+    // Bits above length would leak into following writes
+    this->data |= (static_cast<unsigned long long>(data) & ((1ULL << length) - 1)) << this->overflow;
     this->overflow += length;
     while (this->overflow >= 8)
     {
-        this->file << static_cast<char>(this->data & 0xFF);
+        *this->stream << static_cast<char>(this->data & 0xFF);
         this->data = this->data >> 8;
         this->overflow -= 8;
-        cnt ++;
     }
 }
 
@@ -42,3 +51,24 @@ void GIFwriter::finish()
     if (this->overflow != 0)
         this->write(0, 8 - this->overflow);
 }
+
+/**
+ * @brief Appends bytes written by other writer, output has to be byte aligned
+ * @param bytes Bytes to append
+ */
+void GIFwriter::append(const string & bytes)
+{
+    if (this->overflow != 0)
+        throw "Unaligned GIF data can not be appended";
+
+    this->stream->write(bytes.data(), bytes.size());
+}
+
+/**
+ * @brief Gets bytes written to memory writer
+ * @return Written bytes
+ */
+string GIFwriter::getData() const
+{
+    return this->memory.str();
+}
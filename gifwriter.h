@@ -13,15 +13,22 @@ class GIFwriter
 {
 private:
     ofstream file;
+    ostringstream memory;
+
+    /// File or memory stream
+    ostream *stream;
 
 public:
     unsigned int overflow;
     unsigned long long data;
     GIFwriter(const string & filename);
+    GIFwriter();
     ~GIFwriter();
     void write(const int &data, unsigned int length);
     void write(const char *data, unsigned int length);
     void finish();
+    void append(const string & bytes);
+    string getData() const;
     void writeOut(unsigned int i, unsigned int i2);
 };
 
@@ -9,6 +9,8 @@
 
 #include "imageprocessing.h"
 #include "gif2bmp.h"
+#include "gifstream.h"
+#include "gifindex.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <getopt.h>
@@ -22,50 +24,148 @@
 
 
 /**
- * @brief Detects if input file is GIF
- * @param filename Filename
+ * @brief Detects if input data are GIF by signature in first bytes
+ * @param stream Input stream
  * @return True if gif was recognized
  */
-bool ImageProcessing::isGif(const string &filename)
+bool ImageProcessing::isGif(const tGIFSTREAM &stream)
 {
-	// Tries to open file
-    FILE * fp = fopen(filename.c_str(), "rb");
+    return stream.size >= 3 && memcmp(stream.data, "GIF", 3) == 0;
+}
+
+/**
+ * @brief ImageProcessing constructor
+ * @param filename Input file, "-" for standard input
+ * @param arg Arguments reference, requested output size is passed to GIF decoder
+ */
+ImageProcessing::ImageProcessing(const string filename, Arguments &arg)
+{
+    this->gif.indexed = 0;
+    this->gif.scaled = 0;
+    this->gif.cropped = 0;
 
-    if (fp == 0)
+    tGIFSTREAM stream;
+
+    // Input is opened once, file is mapped, standard input and pipes are read into memory
+    if (openGifStream(filename.c_str(), &stream))
         throw "Unable to open file: " + filename;
 
-    char gif[3];
-	
-	// Reads frist three bytes
-    int i = fread(&gif, sizeof(char), 3, fp);
+    try
+    {
+        this->decode(stream, arg);
+        closeGifStream(&stream);
+    }
+    catch (...)
+    {
+        closeGifStream(&stream);
+        throw;
+    }
 
-    fclose(fp);
+    // Failed to load data
+    if (this->image.total() == 0)
+        throw "No image data in file: " + filename;
+}
 
-    if (i != 3)
-        throw "Error reading head of file: " + filename;
+/**
+ * @brief Decodes input data, format is sniffed from first bytes
+ * @param stream Input stream
+ * @param arg Arguments reference, requested output size is passed to GIF decoder
+ */
+void ImageProcessing::decode(tGIFSTREAM &stream, Arguments &arg)
+{
+    if (this->isGif(stream))
+    {
+        tGIFDECODE_OPTIONS options;
+
+        initDecodeOptions(&options);
+        options.outputMode = GIF_OUTPUT_INDEX;
 
-	// Tests if its a GIF
-    if (strcmp(gif, "GIF") == 0)
-        return true;
+        if (arg.getResize() == PERCENT)
+        {
+            options.scaleX = arg.getResizePercentX();
+            options.scaleY = arg.getResizePercentY();
+        }
+        else if (arg.getResize() == DIMENSION)
+        {
+            options.targetWidth = arg.getWidth();
+            options.targetHeight = arg.getHeight();
+        }
 
-    return false;
+        if (arg.isCrop())
+        {
+            options.cropX = arg.getCropX();
+            options.cropY = arg.getCropY();
+            options.cropWidth = arg.getCropWidth();
+            options.cropHeight = arg.getCropHeight();
+        }
+
+        // Saved block index is used when it matches input, otherwise it is rebuilt and saved
+        tGIFINDEX index;
+        initGifIndex(&index);
+        if (!arg.getIndexFile().empty())
+        {
+            const char *indexFile = arg.getIndexFile().c_str();
+            if (loadGifIndex(indexFile, &index) || checkGifIndex(&index, &stream))
+            {
+                if (buildGifIndex(&stream, &index) == EXIT_SUCCESS && saveGifIndex(&index, indexFile))
+                    cerr << "Unable to save GIF index: " << indexFile << endl;
+            }
+            options.index = &index;
+        }
+
+        try
+        {
+            decodeGif(&stream, &options, &this->gif);
+            freeGifIndex(&index);
+        }
+        catch (...)
+        {
+            freeGifIndex(&index);
+            throw;
+        }
+        this->image = this->gif.pixels;
+    }
+
+    // Other formats are decoded by OpenCV from same memory, decoded image is a copy
+    else if (stream.size > 0)
+        this->image = imdecode(Mat(1, (int)stream.size, CV_8UC1, (void *)stream.data), CV_LOAD_IMAGE_COLOR);
 }
 
 /**
- * @brief ImageProcessing constructor
- * @param filename Input file
+ * @brief Expands GIF color index plane into BGR image
  */
-ImageProcessing::ImageProcessing(const string filename)
+void ImageProcessing::expandPalette()
 {
-    if (this->isGif(filename))
-        this->image = loadGif(filename);
+    if (!this->gif.indexed)
+        return;
 
-    else
-        this->image = imread(filename);
+    expandGifImage(&this->gif);
+    this->image = this->gif.pixels;
+}
 
-    // Failed to load data
-    if (this->image.total() == 0)
-        throw "No image data in file: " + filename;
+/**
+ * @brief Crops image to rectangle specified in arguments
+ * @param arg Arguments reference
+ */
+void ImageProcessing::crop(Arguments &arg)
+{
+    // GIF decoder stores only crop rectangle
+    if (!arg.isCrop() || this->gif.cropped)
+        return;
+
+    int left = max(arg.getCropX(), 0);
+    int top = max(arg.getCropY(), 0);
+    int right = min(arg.getCropX() + arg.getCropWidth(), this->image.cols);
+    int bottom = min(arg.getCropY() + arg.getCropHeight(), this->image.rows);
+
+    if (left >= right || top >= bottom)
+        throw "Crop rectangle is outside of image.";
+
+    // Crop rectangle covers whole image
+    if (right - left == this->image.cols && bottom - top == this->image.rows)
+        return;
+
+    this->image = this->image(Rect(left, top, right - left, bottom - top)).clone();
 }
 
 /**
@@ -74,8 +174,17 @@ ImageProcessing::ImageProcessing(const string filename)
  */
 void ImageProcessing::convertToGrayscale(bool convert)
 {
-    if (convert)
-        cvtColor(this->image, this->image, CV_BGR2GRAY);
+    if (!convert)
+        return;
+
+    // Index plane is converted through palette, each color only once
+    if (this->gif.indexed)
+    {
+        grayIndexPlane(this->image, this->gif.palette, this->image);
+        this->gif.indexed = 0;
+    }
+    else
+        cvtColor(this->image, this->image, this->image.channels() == 4 ? CV_BGRA2GRAY : CV_BGR2GRAY);
 }
 
 /**
@@ -84,6 +193,14 @@ void ImageProcessing::convertToGrayscale(bool convert)
  */
 void ImageProcessing::resize(Arguments &arg)
 {
+    // GIF decoder already sampled pixels into requested size
+    if (this->gif.scaled)
+        return;
+
+    // Interpolation needs real colors
+    if (arg.getResize() != NONE)
+        this->expandPalette();
+
     if (arg.getResize() == PERCENT)
         cv::resize(this->image, this->image, Size(0,0), arg.getResizePercentX(), arg.getResizePercentY());
 
@@ -95,9 +212,15 @@ void ImageProcessing::resize(Arguments &arg)
  * @brief Saves image to output
  * @param filename Filename with path
  * @param file_types Types of the saved image
+ * @param level Quantizer level of GIF output
+ * @param dither Dithering of GIF output
+ * @param truecolor GIF output keeps all colors in tiles with local palettes
  */
-void ImageProcessing::save(const string & filename, set<enum img_type> & file_types)
+void ImageProcessing::save(const string & filename, set<enum img_type> & file_types,
+                           enum quantize_level level, enum dither_mode dither, bool truecolor)
 {
+    this->expandPalette();
+
     for (set<enum img_type>::iterator it = file_types.begin();
          it != file_types.end();
          it ++)
@@ -119,7 +242,7 @@ void ImageProcessing::save(const string & filename, set<enum img_type> & file_ty
                 break;
 
             case GIF:
-                GIFencoder(filename + ".gif", this->image);
+                GIFencoder(filename + ".gif", this->image, level, dither, truecolor);
                 break;
 
             case BMP:
@@ -178,6 +301,7 @@ void ImageProcessing::displayImage(bool display)
 {
     if (display)
     {
+        this->expandPalette();
         namedWindow("Output", CV_WINDOW_AUTOSIZE);
         imshow("Output", this->image);
         waitKey(0);
@@ -15,6 +15,7 @@
 #include <highgui.h>
 #include "arguments.h"
 #include "gifencoder.h"
+#include "gif2bmp.h"
 
 using namespace cv;
 
@@ -25,12 +26,20 @@ class ImageProcessing
 {
     Mat image;
 
-    bool isGif(const string &filename);
+    /// Decoded GIF is kept as color index plane until colors are needed
+    tGIFIMAGE gif;
+
+    bool isGif(const tGIFSTREAM &stream);
+    void decode(tGIFSTREAM &stream, Arguments &arg);
+    void expandPalette();
 public:
-    ImageProcessing(const string str);
+    ImageProcessing(const string str, Arguments &arg);
+    void crop(Arguments &arg);
     void convertToGrayscale(bool convert = false);
     void resize(Arguments &arg);
-    void save(const string & filename, set<enum img_type> & file_types);
+    void save(const string & filename, set<enum img_type> & file_types,
+              enum quantize_level level = QUANTIZE_NORMAL,
+              enum dither_mode dither = DITHER_NONE, bool truecolor = false);
     void displayImage(bool = false);
 };
 
@@ -8,6 +8,7 @@
  */
 
 #include "imageprocessing.h"
+#include "probe.h"
 
 /**
  * @brief Main function
@@ -21,7 +22,28 @@ int main( int argc, const char* argv[] )
     try
     {
         Arguments arg(argc, argv);
-        ImageProcessing processor(arg.getInputFile());
+
+        // Prints image properties only
+        if (arg.isProbe())
+        {
+            tIMAGE_PROBE probe;
+
+            initImageProbe(&probe);
+            if (probeImage(arg.getInputFile().c_str(), &probe))
+            {
+                freeImageProbe(&probe);
+                throw "Unable to probe file: " + arg.getInputFile();
+            }
+
+            printImageProbe(stdout, arg.getInputFile().c_str(), &probe);
+            freeImageProbe(&probe);
+            return EXIT_SUCCESS;
+        }
+
+        ImageProcessing processor(arg.getInputFile(), arg);
+
+        // Crop rectangle
+        processor.crop(arg);
 
         // Grayscale conversion
         processor.convertToGrayscale(arg.isGrayscale());
@@ -33,7 +55,8 @@ int main( int argc, const char* argv[] )
         processor.displayImage(arg.showOutput());
 
         // Saves output
-        processor.save(arg.getOutputFile(), arg.getOutput());
+        processor.save(arg.getOutputFile(), arg.getOutput(), arg.getQuantize(), arg.getDither(),
+                       arg.isTrueColor());
     }
     catch(string e)
     {
@@ -0,0 +1,296 @@
+/*
+ *  File name: palette.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Include functions for color index to BGR and BGRA expansion, SIMD kernels
+ *               are selected at runtime by CPU features
+ */
+
+#include <string.h>
+#include "palette.h"
+#include "constant.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PALETTE_X86
+#endif
+
+/**
+ * Function build expansion table from color table, each color is packed
+ * into 32 bits as B, G, R, 255 bytes (opaque BGRA pixel)
+ *
+ * @param paletteTable Output expansion table (NUMBER_OF_COLORS items)
+ * @param colorTable Color table
+ */
+void initPaletteTable(u_int32_t paletteTable [], const tRGB colorTable []) {
+
+	for (int i = 0; i < NUMBER_OF_COLORS; i++) {
+		u_int8_t bgra[4] = {colorTable[i].blue, colorTable[i].green, colorTable[i].red, 255};
+		memcpy(&paletteTable[i], bgra, sizeof(u_int32_t));
+	}
+}
+
+/**
+ * Function expand color indexes into BGR pixels, one pixel at a time
+ *
+ * @param paletteTable Expansion table
+ * @param indices Color indexes
+ * @param bitMap Output BGR pixels
+ * @param count Number of pixels
+ */
+static void expandPaletteRowScalar(const u_int32_t paletteTable [], const u_int8_t *indices, u_int8_t *bitMap, u_int32_t count) {
+
+	for (u_int32_t i = 0; i < count; i++) {
+		const u_int8_t *color = (const u_int8_t *)&paletteTable[indices[i]];
+		*bitMap++ = color[0];
+		*bitMap++ = color[1];
+		*bitMap++ = color[2];
+	}
+}
+
+#ifdef PALETTE_X86
+
+// Older GCC reports undefined vectors inside AVX-512 intrinsics headers
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/**
+ * Function expand color indexes into BGR pixels, 16 pixels per iteration.
+ * Colors are looked up one by one and packed from 4 to 3 bytes by shuffle.
+ *
+ * @param paletteTable Expansion table
+ * @param indices Color indexes
+ * @param bitMap Output BGR pixels
+ * @param count Number of pixels
+ */
+__attribute__((target("sse4.1")))
+static void expandPaletteRowSSE41(const u_int32_t paletteTable [], const u_int8_t *indices, u_int8_t *bitMap, u_int32_t count) {
+
+	const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	u_int32_t i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		const u_int8_t *in = indices + i;
+		__m128i c0 = _mm_setr_epi32(paletteTable[in[0]], paletteTable[in[1]], paletteTable[in[2]], paletteTable[in[3]]);
+		__m128i c1 = _mm_setr_epi32(paletteTable[in[4]], paletteTable[in[5]], paletteTable[in[6]], paletteTable[in[7]]);
+		__m128i c2 = _mm_setr_epi32(paletteTable[in[8]], paletteTable[in[9]], paletteTable[in[10]], paletteTable[in[11]]);
+		__m128i c3 = _mm_setr_epi32(paletteTable[in[12]], paletteTable[in[13]], paletteTable[in[14]], paletteTable[in[15]]);
+
+		// 12 valid bytes in each vector
+		c0 = _mm_shuffle_epi8(c0, pack);
+		c1 = _mm_shuffle_epi8(c1, pack);
+		c2 = _mm_shuffle_epi8(c2, pack);
+		c3 = _mm_shuffle_epi8(c3, pack);
+
+		// Join 4 x 12 bytes into 3 x 16 bytes
+		_mm_storeu_si128((__m128i *)(bitMap), _mm_or_si128(c0, _mm_slli_si128(c1, 12)));
+		_mm_storeu_si128((__m128i *)(bitMap + 16), _mm_or_si128(_mm_srli_si128(c1, 4), _mm_slli_si128(c2, 8)));
+		_mm_storeu_si128((__m128i *)(bitMap + 32), _mm_or_si128(_mm_srli_si128(c2, 8), _mm_slli_si128(c3, 4)));
+		bitMap += 48;
+	}
+
+	expandPaletteRowScalar(paletteTable, indices + i, bitMap, count - i);
+}
+
+/**
+ * Function expand color indexes into BGR pixels, 16 pixels per iteration.
+ * Colors are loaded by gather and packed from 4 to 3 bytes in each lane.
+ *
+ * @param paletteTable Expansion table
+ * @param indices Color indexes
+ * @param bitMap Output BGR pixels
+ * @param count Number of pixels
+ */
+__attribute__((target("avx2")))
+static void expandPaletteRowAVX2(const u_int32_t paletteTable [], const u_int8_t *indices, u_int8_t *bitMap, u_int32_t count) {
+
+	const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+										  0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	const __m256i join = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+	u_int32_t i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		__m256i i0 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(indices + i)));
+		__m256i i1 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(indices + i + 8)));
+		__m256i c0 = _mm256_i32gather_epi32((const int *)paletteTable, i0, 4);
+		__m256i c1 = _mm256_i32gather_epi32((const int *)paletteTable, i1, 4);
+
+		// 24 valid bytes at the beginning of each vector
+		c0 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(c0, pack), join);
+		c1 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(c1, pack), join);
+
+		_mm256_storeu_si256((__m256i *)(bitMap), _mm256_blend_epi32(c0, _mm256_permute4x64_epi64(c1, 0x00), 0xC0));
+		_mm_storeu_si128((__m128i *)(bitMap + 32), _mm256_castsi256_si128(_mm256_permute4x64_epi64(c1, 0x09)));
+		bitMap += 48;
+	}
+
+	expandPaletteRowScalar(paletteTable, indices + i, bitMap, count - i);
+}
+
+/**
+ * Function expand color indexes into BGR pixels, 32 pixels per iteration.
+ * Colors are loaded by gather, packed in each lane and joined by permutation.
+ *
+ * @param paletteTable Expansion table
+ * @param indices Color indexes
+ * @param bitMap Output BGR pixels
+ * @param count Number of pixels
+ */
+__attribute__((target("avx512f,avx512bw")))
+static void expandPaletteRowAVX512(const u_int32_t paletteTable [], const u_int8_t *indices, u_int8_t *bitMap, u_int32_t count) {
+
+	const __m512i pack = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1));
+	const __m512i join = _mm512_setr_epi32(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 3, 7, 11, 15);
+	u_int32_t i = 0;
+
+	for (; i + 32 <= count; i += 32) {
+		__m512i i0 = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)(indices + i)));
+		__m512i i1 = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *)(indices + i + 16)));
+		__m512i c0 = _mm512_i32gather_epi32(i0, (const int *)paletteTable, 4);
+		__m512i c1 = _mm512_i32gather_epi32(i1, (const int *)paletteTable, 4);
+
+		// 48 valid bytes at the beginning of each vector
+		c0 = _mm512_permutexvar_epi32(join, _mm512_shuffle_epi8(c0, pack));
+		c1 = _mm512_permutexvar_epi32(join, _mm512_shuffle_epi8(c1, pack));
+
+		_mm512_mask_storeu_epi32(bitMap, 0x0FFF, c0);
+		_mm512_mask_storeu_epi32(bitMap + 48, 0x0FFF, c1);
+		bitMap += 96;
+	}
+
+	expandPaletteRowScalar(paletteTable, indices + i, bitMap, count - i);
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+/**
+ * Function check if expansion kernel can run on this CPU
+ *
+ * @param kernel Kernel identifier (PALETTE_KERNEL_*)
+ * @return 1 if kernel is supported, 0 otherwise
+ */
+int paletteKernelSupported(int kernel) {
+
+	switch (kernel) {
+		case PALETTE_KERNEL_SCALAR:
+			return 1;
+#ifdef PALETTE_X86
+		case PALETTE_KERNEL_SSE41:
+			return __builtin_cpu_supports("sse4.1") != 0;
+		case PALETTE_KERNEL_AVX2:
+			return __builtin_cpu_supports("avx2") != 0;
+		case PALETTE_KERNEL_AVX512:
+			return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Function return name of expansion kernel
+ *
+ * @param kernel Kernel identifier (PALETTE_KERNEL_*)
+ * @return Kernel name
+ */
+const char *paletteKernelName(int kernel) {
+
+	static const char *names[PALETTE_KERNEL_COUNT] = {"scalar", "sse4.1", "avx2", "avx512"};
+
+	if (kernel < 0 || kernel >= PALETTE_KERNEL_COUNT)
+		return "unknown";
+
+	return names[kernel];
+}
+
+/**
+ * Function select best expansion kernel supported by CPU
+ *
+ * @return Kernel identifier (PALETTE_KERNEL_*)
+ */
+static int selectPaletteKernel(void) {
+
+#ifdef PALETTE_X86
+	__builtin_cpu_init();
+#endif
+
+	for (int kernel = PALETTE_KERNEL_COUNT - 1; kernel > PALETTE_KERNEL_SCALAR; kernel--)
+		if (paletteKernelSupported(kernel))
+			return kernel;
+
+	return PALETTE_KERNEL_SCALAR;
+}
+
+/**
+ * Function return expansion kernel used by expandPaletteRow
+ *
+ * @return Kernel identifier (PALETTE_KERNEL_*)
+ */
+int getPaletteKernel(void) {
+
+	// Detected once, initialization of local static is thread safe
+	static const int kernel = selectPaletteKernel();
+
+	return kernel;
+}
+
+/**
+ * Function expand color indexes into BGR pixels with selected kernel,
+ * kernel has to be supported by CPU (paletteKernelSupported)
+ *
+ * @param kernel Kernel identifier (PALETTE_KERNEL_*)
+ * @param paletteTable Expansion table
+ * @param indices Color indexes
+ * @param bitMap Output BGR pixels
+ * @param count Number of pixels
+ */
+void expandPaletteRowKernel(int kernel, const u_int32_t paletteTable [], const u_int8_t *indices, u_int8_t *bitMap, u_int32_t count) {
+
+	switch (kernel) {
+#ifdef PALETTE_X86
+		case PALETTE_KERNEL_SSE41:
+			expandPaletteRowSSE41(paletteTable, indices, bitMap, count);
+			break;
+		case PALETTE_KERNEL_AVX2:
+			expandPaletteRowAVX2(paletteTable, indices, bitMap, count);
+			break;
+		case PALETTE_KERNEL_AVX512:
+			expandPaletteRowAVX512(paletteTable, indices, bitMap, count);
+			break;
+#endif
+		default:
+			expandPaletteRowScalar(paletteTable, indices, bitMap, count);
+			break;
+	}
+}
+
+/**
+ * Function expand color indexes into BGR pixels with best kernel for this CPU
+ *
+ * @param paletteTable Expansion table
+ * @param indices Color indexes
+ * @param bitMap Output BGR pixels
+ * @param count Number of pixels
+ */
+void expandPaletteRow(const u_int32_t paletteTable [], const u_int8_t *indices, u_int8_t *bitMap, u_int32_t count) {
+
+	expandPaletteRowKernel(getPaletteKernel(), paletteTable, indices, bitMap, count);
+}
+
+/**
+ * Function expand color indexes into opaque BGRA pixels, table items are
+ * stored directly
+ *
+ * @param paletteTable Expansion table
+ * @param indices Color indexes
+ * @param bitMap Output BGRA pixels
+ * @param count Number of pixels
+ */
+void expandPaletteRowAlpha(const u_int32_t paletteTable [], const u_int8_t *indices, u_int8_t *bitMap, u_int32_t count) {
+
+	for (u_int32_t i = 0; i < count; i++)
+		memcpy(bitMap + 4 * i, &paletteTable[indices[i]], sizeof(u_int32_t));
+}
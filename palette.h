@@ -0,0 +1,27 @@
+/*
+ *  File name: palette.h
+ *  Created on: 17. 10. 2026
+ *  Type: Header file
+ *  Description: Include functions declarations for color index to BGR and BGRA expansion
+ */
+
+#ifndef PALETTE_H_
+#define PALETTE_H_
+
+#include "constant.h"
+
+#define PALETTE_KERNEL_SCALAR 				0
+#define PALETTE_KERNEL_SSE41 				1
+#define PALETTE_KERNEL_AVX2 				2
+#define PALETTE_KERNEL_AVX512 				3
+#define PALETTE_KERNEL_COUNT 				4
+
+void initPaletteTable(u_int32_t paletteTable [], const tRGB colorTable []);
+int getPaletteKernel(void);
+int paletteKernelSupported(int kernel);
+const char *paletteKernelName(int kernel);
+void expandPaletteRowKernel(int kernel, const u_int32_t paletteTable [], const u_int8_t *indices, u_int8_t *bitMap, u_int32_t count);
+void expandPaletteRow(const u_int32_t paletteTable [], const u_int8_t *indices, u_int8_t *bitMap, u_int32_t count);
+void expandPaletteRowAlpha(const u_int32_t paletteTable [], const u_int8_t *indices, u_int8_t *bitMap, u_int32_t count);
+
+#endif /* PALETTE_H_ */
@@ -0,0 +1,600 @@
+/*
+ *  File name: probe.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Include functions for image probe. GIF is probed by logical screen
+ *               descriptor and block index, other formats by header bytes only,
+ *               no pixel buffer is allocated.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include "probe.h"
+#include "gifindex.h"
+#include "gifstream.h"
+#include "constant.h"
+
+// Maximal number of TIFF directories counted as frames
+#define PROBE_MAX_TIFF_PAGES 				65536
+
+/**
+ * Function init empty probe result
+ *
+ * @param probe Pointer to probe result
+ */
+void initImageProbe(tIMAGE_PROBE *probe) {
+
+	probe->format = PROBE_FORMAT_UNKNOWN;
+	probe->width = 0;
+	probe->height = 0;
+	probe->channels = 0;
+	probe->bitDepth = 0;
+	probe->frameCount = 0;
+	initGifIndex(&probe->gifIndex);
+}
+
+/**
+ * Function free probe result
+ *
+ * @param probe Pointer to probe result
+ */
+void freeImageProbe(tIMAGE_PROBE *probe) {
+
+	freeGifIndex(&probe->gifIndex);
+	initImageProbe(probe);
+}
+
+/**
+ * Function return format name used in probe output
+ *
+ * @param format Format (PROBE_FORMAT_*)
+ * @return Format name
+ */
+const char *probeFormatName(int format) {
+
+	switch (format) {
+		case PROBE_FORMAT_GIF:			return "gif";
+		case PROBE_FORMAT_PNG:			return "png";
+		case PROBE_FORMAT_JPEG:			return "jpeg";
+		case PROBE_FORMAT_BMP:			return "bmp";
+		case PROBE_FORMAT_TIFF:			return "tiff";
+		case PROBE_FORMAT_PNM:			return "pnm";
+		case PROBE_FORMAT_SUN_RASTER:	return "ras";
+		case PROBE_FORMAT_JP2:			return "jp2";
+		default:						return "unknown";
+	}
+}
+
+/**
+ * Function read big endian value
+ *
+ * @param data Pointer to value
+ * @param bytes Number of bytes
+ * @return Value
+ */
+static u_int32_t getBigEndian(const u_int8_t *data, int bytes) {
+
+	u_int32_t value = 0;
+
+	for (int i = 0; i < bytes; i++)
+		value = (value << 8) | data[i];
+
+	return value;
+}
+
+/**
+ * Function read little endian value
+ *
+ * @param data Pointer to value
+ * @param bytes Number of bytes
+ * @return Value
+ */
+static u_int32_t getLittleEndian(const u_int8_t *data, int bytes) {
+
+	u_int32_t value = 0;
+
+	for (int i = bytes - 1; i >= 0; i--)
+		value = (value << 8) | data[i];
+
+	return value;
+}
+
+/**
+ * Function read bytes from given position of input stream
+ *
+ * @param stream Pointer to input stream
+ * @param offset File position
+ * @param buffer Output buffer
+ * @param size Number of bytes
+ * @return 0 on success, 1 on failure
+ */
+static int readProbeBytes(const tGIFSTREAM *stream, off_t offset, u_int8_t *buffer, size_t size) {
+
+	if (offset < 0 || (u_int64_t)offset > stream->size || size > stream->size - (size_t)offset)
+		return EXIT_FAILURE;
+
+	memcpy(buffer, stream->data + offset, size);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function probe GIF by logical screen descriptor and block index, GIF with
+ * transparent color is decoded into BGRA so it has 4 channels
+ *
+ * @param stream Pointer to input stream with whole GIF
+ * @param probe Pointer to probe result, has to be initialized
+ * @return 0 on success, 1 on failure (incorrect header)
+ */
+int probeGif(const tGIFSTREAM *stream, tIMAGE_PROBE *probe) {
+
+	if (buildGifIndex(stream, &probe->gifIndex))
+		return EXIT_FAILURE;
+
+	probe->format = PROBE_FORMAT_GIF;
+	probe->width = probe->gifIndex.width;
+	probe->height = probe->gifIndex.height;
+	probe->channels = hasTransparentIndexFrames(&probe->gifIndex) ? 4 : 3;
+	probe->bitDepth = ((probe->gifIndex.screenDescriptor[4] & GIFMASK_COLOR_BITS_PER_PIXEL) >> 4) + 1;
+	probe->frameCount = probe->gifIndex.frameCount;
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function probe PNG by IHDR chunk
+ *
+ * @param header File header
+ * @param size Header size
+ * @param probe Pointer to probe result
+ * @return 0 on success, 1 on failure
+ */
+static int probePng(const u_int8_t *header, size_t size, tIMAGE_PROBE *probe) {
+
+	static const int channels[7] = {1, 0, 3, 1, 2, 0, 4};
+
+	if (size < 26 || memcmp(header + 12, "IHDR", 4) != 0 || header[25] > 6)
+		return EXIT_FAILURE;
+
+	probe->width = getBigEndian(header + 16, 4);
+	probe->height = getBigEndian(header + 20, 4);
+	probe->bitDepth = header[24];
+	probe->channels = channels[header[25]];
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function probe JPEG by start of frame marker, other segments are skipped
+ *
+ * @param stream Pointer to input stream
+ * @param probe Pointer to probe result
+ * @return 0 on success, 1 on failure
+ */
+static int probeJpeg(const tGIFSTREAM *stream, tIMAGE_PROBE *probe) {
+
+	u_int8_t segment[8];
+	off_t position = 2;
+
+	while (readProbeBytes(stream, position, segment, 4) == EXIT_SUCCESS) {
+
+		// Fill bytes before marker
+		if (segment[0] != 0xFF)
+			return EXIT_FAILURE;
+		if (segment[1] == 0xFF) {
+			position++;
+			continue;
+		}
+
+		u_int8_t marker = segment[1];
+
+		// Start of scan - no frame header before image data
+		if (marker == 0xDA || marker == 0xD9)
+			return EXIT_FAILURE;
+
+		// Markers without length
+		if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+			position += 2;
+			continue;
+		}
+
+		// Start of frame (except DHT, JPG and DAC)
+		if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+			if (readProbeBytes(stream, position + 4, segment, 6))
+				return EXIT_FAILURE;
+
+			probe->bitDepth = segment[0];
+			probe->height = getBigEndian(segment + 1, 2);
+			probe->width = getBigEndian(segment + 3, 2);
+			probe->channels = segment[5];
+			return EXIT_SUCCESS;
+		}
+
+		position += 2 + getBigEndian(segment + 2, 2);
+	}
+
+	return EXIT_FAILURE;
+}
+
+/**
+ * Function probe Windows bitmap by file and info header
+ *
+ * @param header File header
+ * @param size Header size
+ * @param probe Pointer to probe result
+ * @return 0 on success, 1 on failure
+ */
+static int probeBmp(const u_int8_t *header, size_t size, tIMAGE_PROBE *probe) {
+
+	if (size < 26)
+		return EXIT_FAILURE;
+
+	int bitsPerPixel;
+
+	// OS/2 core header has 16 bit dimensions
+	if (getLittleEndian(header + 14, 4) == 12) {
+		probe->width = getLittleEndian(header + 18, 2);
+		probe->height = getLittleEndian(header + 20, 2);
+		bitsPerPixel = getLittleEndian(header + 24, 2);
+	}
+	else {
+		if (size < 30)
+			return EXIT_FAILURE;
+
+		// Negative height is top-down bitmap
+		int32_t height = (int32_t)getLittleEndian(header + 22, 4);
+		probe->width = getLittleEndian(header + 18, 4);
+		probe->height = height < 0 ? (u_int32_t)-(int64_t)height : (u_int32_t)height;
+		bitsPerPixel = getLittleEndian(header + 28, 2);
+	}
+
+	if (bitsPerPixel >= 24) {
+		probe->channels = bitsPerPixel / 8;
+		probe->bitDepth = 8;
+	}
+	else if (bitsPerPixel == 16) {
+		probe->channels = 3;
+		probe->bitDepth = 5;
+	}
+	else {
+		probe->channels = 1;
+		probe->bitDepth = bitsPerPixel;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function read TIFF value by byte order of file
+ *
+ * @param data Pointer to value
+ * @param bytes Number of bytes
+ * @param bigEndian Byte order of file
+ * @return Value
+ */
+static u_int32_t getTiffValue(const u_int8_t *data, int bytes, int bigEndian) {
+
+	return bigEndian ? getBigEndian(data, bytes) : getLittleEndian(data, bytes);
+}
+
+/**
+ * Function probe TIFF by first image file directory, other directories are counted as frames
+ *
+ * @param stream Pointer to input stream
+ * @param header File header
+ * @param probe Pointer to probe result
+ * @return 0 on success, 1 on failure
+ */
+static int probeTiff(const tGIFSTREAM *stream, const u_int8_t *header, tIMAGE_PROBE *probe) {
+
+	u_int8_t entry[12];
+	int bigEndian = header[0] == 'M';
+	u_int32_t offset = getTiffValue(header + 4, 4, bigEndian);
+
+	probe->channels = 1;
+	probe->bitDepth = 1;
+
+	while (offset != 0 && probe->frameCount < PROBE_MAX_TIFF_PAGES) {
+
+		if (readProbeBytes(stream, offset, entry, 2))
+			return probe->frameCount ? EXIT_SUCCESS : EXIT_FAILURE;
+
+		u_int32_t entries = getTiffValue(entry, 2, bigEndian);
+
+		// Only first directory is read, others are skipped
+		if (probe->frameCount == 0) {
+			for (u_int32_t i = 0; i < entries; i++) {
+				if (readProbeBytes(stream, (off_t)offset + 2 + (off_t)i * 12, entry, sizeof(entry)))
+					return EXIT_FAILURE;
+
+				u_int32_t tag = getTiffValue(entry, 2, bigEndian);
+				u_int32_t type = getTiffValue(entry + 2, 2, bigEndian);
+				u_int32_t value = type == 3 ? getTiffValue(entry + 8, 2, bigEndian) : getTiffValue(entry + 8, 4, bigEndian);
+
+				switch (tag) {
+					case 256:	probe->width = value;	break;
+					case 257:	probe->height = value;	break;
+					case 277:	probe->channels = value;	break;
+					case 258:
+						// More samples store offset to values, all of them are same in practice
+						if (getTiffValue(entry + 4, 4, bigEndian) <= 2)
+							probe->bitDepth = value;
+						else
+							probe->bitDepth = 8;
+						break;
+					default:
+						break;
+				}
+			}
+		}
+
+		if (readProbeBytes(stream, (off_t)offset + 2 + (off_t)entries * 12, entry, 4))
+			return EXIT_FAILURE;
+
+		offset = getTiffValue(entry, 4, bigEndian);
+		probe->frameCount++;
+	}
+
+	return probe->width && probe->height ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Function read next unsigned number from PNM header, comments are skipped
+ *
+ * @param header File header
+ * @param size Header size
+ * @param position Pointer to actual position in header
+ * @param value Output value
+ * @return 0 on success, 1 on failure
+ */
+static int getPnmValue(const u_int8_t *header, size_t size, size_t *position, u_int32_t *value) {
+
+	size_t i = *position;
+
+	while (i < size && (header[i] == '#' || header[i] == ' ' || header[i] == '\t' || header[i] == '\r' || header[i] == '\n')) {
+		if (header[i] == '#')
+			while (i < size && header[i] != '\n')
+				i++;
+		else
+			i++;
+	}
+
+	if (i >= size || header[i] < '0' || header[i] > '9')
+		return EXIT_FAILURE;
+
+	*value = 0;
+	while (i < size && header[i] >= '0' && header[i] <= '9')
+		*value = *value * 10 + (header[i++] - '0');
+
+	*position = i;
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function probe portable bitmap, graymap or pixmap by text header
+ *
+ * @param header File header
+ * @param size Header size
+ * @param probe Pointer to probe result
+ * @return 0 on success, 1 on failure
+ */
+static int probePnm(const u_int8_t *header, size_t size, tIMAGE_PROBE *probe) {
+
+	size_t position = 2;
+	u_int32_t maxValue = 1;
+	int type = header[1] - '0';
+
+	if (getPnmValue(header, size, &position, &probe->width) || getPnmValue(header, size, &position, &probe->height))
+		return EXIT_FAILURE;
+
+	// Bitmaps have no maximal value
+	if (type != 1 && type != 4 && getPnmValue(header, size, &position, &maxValue))
+		return EXIT_FAILURE;
+
+	probe->channels = (type == 3 || type == 6) ? 3 : 1;
+	probe->bitDepth = maxValue > 255 ? 16 : (maxValue == 1 ? 1 : 8);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function probe JPEG 2000 by image header box or raw codestream SIZ marker
+ *
+ * @param stream Pointer to input stream
+ * @param header File header
+ * @param size Header size
+ * @param probe Pointer to probe result
+ * @return 0 on success, 1 on failure
+ */
+static int probeJp2(const tGIFSTREAM *stream, const u_int8_t *header, size_t size, tIMAGE_PROBE *probe) {
+
+	u_int8_t box[16];
+	off_t position = 0;
+	off_t end = -1;
+
+	// Raw codestream - SIZ marker follows SOC
+	if (header[0] == 0xFF) {
+		if (size < 44)
+			return EXIT_FAILURE;
+
+		probe->width = getBigEndian(header + 8, 4) - getBigEndian(header + 16, 4);
+		probe->height = getBigEndian(header + 12, 4) - getBigEndian(header + 20, 4);
+		probe->channels = getBigEndian(header + 40, 2);
+		probe->bitDepth = (header[42] & 0x7F) + 1;
+		return EXIT_SUCCESS;
+	}
+
+	// Boxes are hopped by their lengths, jp2h is entered
+	while ((end < 0 || position < end) && readProbeBytes(stream, position, box, 8) == EXIT_SUCCESS) {
+
+		u_int64_t length = getBigEndian(box, 4);
+		int headerLength = 8;
+
+		if (length == 1) {
+			if (readProbeBytes(stream, position + 8, box + 8, 8))
+				return EXIT_FAILURE;
+			length = ((u_int64_t)getBigEndian(box + 8, 4) << 32) | getBigEndian(box + 12, 4);
+			headerLength = 16;
+		}
+
+		if (memcmp(box + 4, "jp2h", 4) == 0) {
+			end = length ? position + (off_t)length : -1;
+			position += headerLength;
+			continue;
+		}
+
+		if (memcmp(box + 4, "ihdr", 4) == 0) {
+			if (readProbeBytes(stream, position + headerLength, box, 11))
+				return EXIT_FAILURE;
+
+			probe->height = getBigEndian(box, 4);
+			probe->width = getBigEndian(box + 4, 4);
+			probe->channels = getBigEndian(box + 8, 2);
+			probe->bitDepth = (box[10] & 0x7F) + 1;
+			return EXIT_SUCCESS;
+		}
+
+		// Box till the end of file or incorrect length
+		if (length == 0 || length < (u_int64_t)headerLength)
+			return EXIT_FAILURE;
+
+		position += (off_t)length;
+	}
+
+	return EXIT_FAILURE;
+}
+
+/**
+ * Function probe image file, GIF is probed by block index, other formats by header
+ * bytes only, format is sniffed from first bytes so standard input and pipes are read once
+ *
+ * @param filename Input file name, "-" for standard input
+ * @param probe Pointer to probe result, has to be initialized
+ * @return 0 on success, 1 on failure (unknown format or incorrect header)
+ */
+int probeImage(const char *filename, tIMAGE_PROBE *probe) {
+
+	static const u_int8_t pngSignature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+	static const u_int8_t jp2Signature[12] = {0x00, 0x00, 0x00, 0x0C, 'j', 'P', ' ', ' ', 0x0D, 0x0A, 0x87, 0x0A};
+	static const u_int8_t j2kSignature[4] = {0xFF, 0x4F, 0xFF, 0x51};
+	static const u_int8_t rasSignature[4] = {0x59, 0xA6, 0x6A, 0x95};
+	tGIFSTREAM stream;
+	int result = EXIT_FAILURE;
+
+	freeImageProbe(probe);
+
+	// File is mapped, pipe is read into memory, nothing is read twice
+	if (openGifStream(filename, &stream))
+		return EXIT_FAILURE;
+
+	const u_int8_t *header = stream.data;
+	size_t size = stream.size < PROBE_HEADER_SIZE ? stream.size : PROBE_HEADER_SIZE;
+
+	// GIF image data are hopped by sub block lengths
+	if (size >= 3 && memcmp(header, "GIF", 3) == 0) {
+		result = probeGif(&stream, probe);
+		closeGifStream(&stream);
+		return result;
+	}
+
+	probe->frameCount = 1;
+
+	if (size >= 8 && memcmp(header, pngSignature, 8) == 0) {
+		probe->format = PROBE_FORMAT_PNG;
+		result = probePng(header, size, probe);
+	}
+	else if (size >= 3 && header[0] == 0xFF && header[1] == 0xD8 && header[2] == 0xFF) {
+		probe->format = PROBE_FORMAT_JPEG;
+		result = probeJpeg(&stream, probe);
+	}
+	else if (size >= 2 && header[0] == 'B' && header[1] == 'M') {
+		probe->format = PROBE_FORMAT_BMP;
+		result = probeBmp(header, size, probe);
+	}
+	else if (size >= 8 && (memcmp(header, "II*\0", 4) == 0 || memcmp(header, "MM\0*", 4) == 0)) {
+		probe->format = PROBE_FORMAT_TIFF;
+		probe->frameCount = 0;
+		result = probeTiff(&stream, header, probe);
+	}
+	else if (size >= 3 && header[0] == 'P' && header[1] >= '1' && header[1] <= '6') {
+		probe->format = PROBE_FORMAT_PNM;
+		result = probePnm(header, size, probe);
+	}
+	else if (size >= 16 && memcmp(header, rasSignature, 4) == 0) {
+		probe->format = PROBE_FORMAT_SUN_RASTER;
+		probe->width = getBigEndian(header + 4, 4);
+		probe->height = getBigEndian(header + 8, 4);
+		probe->bitDepth = getBigEndian(header + 12, 4);
+		probe->channels = probe->bitDepth >= 24 ? probe->bitDepth / 8 : 1;
+		if (probe->bitDepth >= 24)
+			probe->bitDepth = 8;
+		result = EXIT_SUCCESS;
+	}
+	else if ((size >= 12 && memcmp(header, jp2Signature, 12) == 0) || (size >= 4 && memcmp(header, j2kSignature, 4) == 0)) {
+		probe->format = PROBE_FORMAT_JP2;
+		result = probeJp2(&stream, header, size, probe);
+	}
+
+	closeGifStream(&stream);
+	return result;
+}
+
+/**
+ * Function print string as JSON string
+ *
+ * @param output Output file
+ * @param text Printed text
+ */
+static void printJsonString(FILE *output, const char *text) {
+
+	fputc('"', output);
+	for (const unsigned char *c = (const unsigned char *)text; *c; c++) {
+		if (*c == '"' || *c == '\\')
+			fprintf(output, "\\%c", *c);
+		else if (*c < 0x20)
+			fprintf(output, "\\u%04x", *c);
+		else
+			fputc(*c, output);
+	}
+	fputc('"', output);
+}
+
+/**
+ * Function print probe result as one line JSON object
+ *
+ * @param output Output file
+ * @param filename Input file name
+ * @param probe Pointer to probe result
+ */
+void printImageProbe(FILE *output, const char *filename, const tIMAGE_PROBE *probe) {
+
+	fprintf(output, "{\"file\":");
+	printJsonString(output, filename);
+	fprintf(output, ",\"format\":\"%s\",\"width\":%u,\"height\":%u,\"channels\":%d,\"bitDepth\":%d,\"frames\":%u",
+			probeFormatName(probe->format), probe->width, probe->height, probe->channels, probe->bitDepth, probe->frameCount);
+
+	if (probe->format == PROBE_FORMAT_GIF) {
+		const tGIFINDEX *index = &probe->gifIndex;
+		u_int64_t duration = 0;
+
+		for (u_int32_t i = 0; i < index->frameCount; i++)
+			duration += index->frames[i].control.delayTime;
+
+		// Delays are in hundredths of second
+		fprintf(output, ",\"complete\":%s,\"loopCount\":%d,\"globalColorTableSize\":%d,\"backgroundColor\":%d,\"duration\":%llu,\"frameInfo\":[",
+				index->complete ? "true" : "false", index->loopCount, index->globalColorTableSize, index->backgroundColor, (unsigned long long)duration);
+
+		for (u_int32_t i = 0; i < index->frameCount; i++) {
+			const tGIFINDEXFRAME *frame = &index->frames[i];
+
+			fprintf(output, "%s{\"left\":%d,\"top\":%d,\"width\":%d,\"height\":%d,\"colorTableSize\":%d,\"localColorTable\":%s,\"interlaced\":%s,\"delay\":%d,\"disposal\":%d,\"transparentIndex\":%d}",
+					i ? "," : "", frame->left, frame->top, frame->width, frame->height, frame->colorTableSize,
+					frame->localColorTable ? "true" : "false", frame->interlaced ? "true" : "false", frame->control.delayTime,
+					frame->control.disposalMethod, frame->control.transparentColorFlag ? frame->control.transparentColorIndex : NO_TRANSPARENT_COLOR);
+		}
+		fprintf(output, "]");
+	}
+
+	fprintf(output, "}\n");
+}
@@ -0,0 +1,48 @@
+/*
+ *  File name: probe.h
+ *  Created on: 17. 10. 2026
+ *  Type: Header file
+ *  Description: Include functions declarations for image probe - dimensions and frame
+ *               metadata are read from headers, pixels are never decoded
+ */
+
+#ifndef PROBE_H_
+#define PROBE_H_
+
+#include <stdio.h>
+#include "constant.h"
+
+#define PROBE_FORMAT_UNKNOWN 				0
+#define PROBE_FORMAT_GIF 					1
+#define PROBE_FORMAT_PNG 					2
+#define PROBE_FORMAT_JPEG 					3
+#define PROBE_FORMAT_BMP 					4
+#define PROBE_FORMAT_TIFF 					5
+#define PROBE_FORMAT_PNM 					6
+#define PROBE_FORMAT_SUN_RASTER 			7
+#define PROBE_FORMAT_JP2 					8
+
+// Bytes read from the start of non GIF file
+#define PROBE_HEADER_SIZE 					512
+
+/**
+ * @brief Image properties read by probe, GIF index is filled only for GIF
+ */
+typedef struct{
+	int format;
+	u_int32_t width;
+	u_int32_t height;
+	int channels;
+	int bitDepth;
+	u_int32_t frameCount;
+	tGIFINDEX gifIndex;
+} tIMAGE_PROBE;
+
+void initImageProbe(tIMAGE_PROBE *probe);
+void freeImageProbe(tIMAGE_PROBE *probe);
+int probeGif(const tGIFSTREAM *stream, tIMAGE_PROBE *probe);
+int probeImage(const char *filename, tIMAGE_PROBE *probe);
+const char *probeFormatName(int format);
+void printImageProbe(FILE *output, const char *filename, const tIMAGE_PROBE *probe);
+
+#endif /* PROBE_H_ */
@@ -0,0 +1,637 @@
+#include "quantizer.h"
+#include <algorithm>
+#include <climits>
+#include "palette.h"
+#include "ditherer.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define QUANTIZE_X86
+#endif
+
+/**
+ * @brief Rows or cube cells processed by one pool task
+ */
+struct QuantizeStripe
+{
+    ColorQuantizer *quantizer;
+    const Mat *image;
+    Mat *output;
+    unsigned int first;
+    unsigned int last;
+};
+
+/**
+ * @brief Histogram bin of one stripe
+ */
+struct StripeBin
+{
+    unsigned int count;
+    unsigned int blue;
+    unsigned int green;
+    unsigned int red;
+};
+
+/**
+ * @brief Box of histogram bins split by median cut
+ */
+struct QuantizeBox
+{
+    unsigned int begin;
+    unsigned int end;
+    double error;
+};
+
+/**
+ * @brief Finds nearest palette color, first one wins on equal distance
+ * @param blue Palette blue components
+ * @param green Palette green components
+ * @param red Palette red components
+ * @param count Number of palette colors
+ * @param b Blue component
+ * @param g Green component
+ * @param r Red component
+ * @return Palette index
+ */
+static int nearestScalar(const int *blue, const int *green, const int *red, unsigned int count, int b, int g, int r)
+{
+    int best = 0;
+    int best_distance = INT_MAX;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        int db = blue[i] - b;
+        int dg = green[i] - g;
+        int dr = red[i] - r;
+        int distance = db * db + dg * dg + dr * dr;
+
+        if (distance < best_distance)
+        {
+            best_distance = distance;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+#ifdef QUANTIZE_X86
+/**
+ * @brief Finds nearest palette color, 4 colors per iteration, first one wins
+ * on equal distance
+ * @param blue Palette blue components
+ * @param green Palette green components
+ * @param red Palette red components
+ * @param count Number of palette colors, multiple of 4
+ * @param b Blue component
+ * @param g Green component
+ * @param r Red component
+ * @return Palette index
+ */
+__attribute__((target("sse4.1")))
+static int nearestSSE41(const int *blue, const int *green, const int *red, unsigned int count, int b, int g, int r)
+{
+    const __m128i qb = _mm_set1_epi32(b);
+    const __m128i qg = _mm_set1_epi32(g);
+    const __m128i qr = _mm_set1_epi32(r);
+    const __m128i four = _mm_set1_epi32(4);
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i best = _mm_setzero_si128();
+    __m128i best_distance = _mm_set1_epi32(INT_MAX);
+
+    for (unsigned int i = 0; i < count; i += 4)
+    {
+        __m128i db = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(blue + i)), qb);
+        __m128i dg = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(green + i)), qg);
+        __m128i dr = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(red + i)), qr);
+        __m128i distance = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(db, db), _mm_mullo_epi32(dg, dg)),
+                                         _mm_mullo_epi32(dr, dr));
+
+        // Each lane keeps its first nearest color
+        __m128i closer = _mm_cmplt_epi32(distance, best_distance);
+        best_distance = _mm_min_epi32(distance, best_distance);
+        best = _mm_blendv_epi8(best, index, closer);
+        index = _mm_add_epi32(index, four);
+    }
+
+    int distances[4];
+    int indexes[4];
+    _mm_storeu_si128((__m128i *)distances, best_distance);
+    _mm_storeu_si128((__m128i *)indexes, best);
+
+    // Lanes are joined so that result is same as of scalar search
+    int lane = 0;
+    for (int i = 1; i < 4; i++)
+    {
+        if (distances[i] < distances[lane] ||
+            (distances[i] == distances[lane] && indexes[i] < indexes[lane]))
+            lane = i;
+    }
+
+    return indexes[lane];
+}
+#endif
+
+/**
+ * @brief Splits range into stripes for pool tasks
+ * @param quantizer Quantizer
+ * @param count Range length
+ * @param pixels Number of pixels in range
+ * @param pool Thread pool, NULL for stripes run on calling thread
+ * @param stripes Output stripes
+ */
+static void splitStripes(ColorQuantizer *quantizer, unsigned int count, unsigned long long pixels,
+                         tTHREADPOOL *pool, vector<QuantizeStripe> &stripes)
+{
+    unsigned int stripe_count = 1;
+
+    if (pool != NULL)
+        stripe_count = min((unsigned int)pool->threadCount + 1,
+                           max(1u, count / QUANTIZE_MIN_STRIPE_ROWS));
+
+    // Sums of one stripe have to fit in 32 bits
+    stripe_count = max(stripe_count, (unsigned int)((pixels + QUANTIZE_STRIPE_PIXELS - 1) / QUANTIZE_STRIPE_PIXELS));
+    stripe_count = max(1u, min(stripe_count, count));
+
+    stripes.resize(stripe_count);
+    for (unsigned int i = 0; i < stripe_count; i++)
+    {
+        stripes[i].quantizer = quantizer;
+        stripes[i].image = NULL;
+        stripes[i].output = NULL;
+        stripes[i].first = (unsigned int)((unsigned long long)count * i / stripe_count);
+        stripes[i].last = (unsigned int)((unsigned long long)count * (i + 1) / stripe_count);
+    }
+}
+
+/**
+ * @brief ColorQuantizer constructor
+ * @param level Speed/quality level
+ */
+ColorQuantizer::ColorQuantizer(enum quantize_level level)
+{
+    switch (level)
+    {
+    case QUANTIZE_FAST:
+        this->bits = QUANTIZE_FAST_BITS;
+        this->iterations = QUANTIZE_FAST_ITERATIONS;
+        break;
+
+    case QUANTIZE_BEST:
+        this->bits = QUANTIZE_BEST_BITS;
+        this->iterations = QUANTIZE_BEST_ITERATIONS;
+        break;
+
+    default:
+        this->bits = QUANTIZE_NORMAL_BITS;
+        this->iterations = QUANTIZE_NORMAL_ITERATIONS;
+        break;
+    }
+
+    this->simd = getPaletteKernel() >= PALETTE_KERNEL_SSE41;
+    this->colors = 0;
+    pthread_mutex_init(&this->mutex, NULL);
+}
+
+/**
+ * @brief ColorQuantizer destructor
+ */
+ColorQuantizer::~ColorQuantizer()
+{
+    pthread_mutex_destroy(&this->mutex);
+}
+
+/**
+ * @brief Finds nearest palette color
+ * @param blue Blue component
+ * @param green Green component
+ * @param red Red component
+ * @return Palette index
+ */
+int ColorQuantizer::findNearest(int blue, int green, int red) const
+{
+#ifdef QUANTIZE_X86
+    if (this->simd)
+        return nearestSSE41(this->blue, this->green, this->red, (this->colors + 3) & ~3u, blue, green, red);
+#endif
+
+    return nearestScalar(this->blue, this->green, this->red, this->colors, blue, green, red);
+}
+
+/**
+ * @brief Appends palette color and moves padding behind it
+ * @param blue Blue component
+ * @param green Green component
+ * @param red Red component
+ */
+void ColorQuantizer::addColor(int blue, int green, int red)
+{
+    this->blue[this->colors] = blue;
+    this->green[this->colors] = green;
+    this->red[this->colors] = red;
+    this->colors++;
+
+    for (unsigned int i = this->colors; i < ((this->colors + 3) & ~3u); i++)
+        this->blue[i] = this->green[i] = this->red[i] = QUANTIZE_PADDING_COLOR;
+}
+
+/**
+ * @brief Pool task, counts colors of stripe rows and adds them to histogram
+ * @param argument Pointer to QuantizeStripe
+ */
+void ColorQuantizer::histogramTask(void *argument)
+{
+    QuantizeStripe *stripe = (QuantizeStripe *)argument;
+    ColorQuantizer *quantizer = stripe->quantizer;
+    unsigned int bits = quantizer->bits;
+    unsigned int shift = 8 - bits;
+    vector<StripeBin> bins(quantizer->bins.size());
+
+    for (unsigned int y = stripe->first; y < stripe->last; y++)
+    {
+        const u_int8_t *pixel = stripe->image->ptr<u_int8_t>(y);
+        const u_int8_t *end = pixel + 3 * stripe->image->cols;
+
+        for (; pixel != end; pixel += 3)
+        {
+            StripeBin &bin = bins[(pixel[0] >> shift) << (2 * bits) | (pixel[1] >> shift) << bits | (pixel[2] >> shift)];
+            bin.count++;
+            bin.blue += pixel[0];
+            bin.green += pixel[1];
+            bin.red += pixel[2];
+        }
+    }
+
+    // Integer sums give same histogram for any order of stripes
+    pthread_mutex_lock(&quantizer->mutex);
+    for (size_t i = 0; i < bins.size(); i++)
+    {
+        if (bins[i].count == 0)
+            continue;
+
+        quantizer->bins[i].count += bins[i].count;
+        quantizer->bins[i].blue += bins[i].blue;
+        quantizer->bins[i].green += bins[i].green;
+        quantizer->bins[i].red += bins[i].red;
+    }
+    pthread_mutex_unlock(&quantizer->mutex);
+}
+
+/**
+ * @brief Builds histogram of color cube cells
+ * @param image CV_8UC3 image
+ * @param pool Thread pool, NULL to run on calling thread
+ */
+void ColorQuantizer::buildHistogram(const Mat &image, tTHREADPOOL *pool)
+{
+    QuantizeBin empty = {0, 0, 0, 0};
+    this->bins.assign(1u << (3 * this->bits), empty);
+
+    vector<QuantizeStripe> stripes;
+    splitStripes(this, image.rows, (unsigned long long)image.rows * image.cols, pool, stripes);
+    for (size_t i = 0; i < stripes.size(); i++)
+        stripes[i].image = &image;
+
+    runTasks(pool, histogramTask, &stripes[0], sizeof(QuantizeStripe), stripes.size());
+
+    this->occupied.clear();
+    for (unsigned int i = 0; i < this->bins.size(); i++)
+    {
+        if (this->bins[i].count != 0)
+            this->occupied.push_back(i);
+    }
+}
+
+/**
+ * @brief Computes squared error of box of bins against its mean color, bins
+ * are represented by their mean colors
+ * @param bins Histogram
+ * @param occupied Bin indexes
+ * @param begin First bin of box
+ * @param end Bin after last one
+ * @param errors Output errors of blue, green and red components, can be NULL
+ * @return Sum of errors
+ */
+static double boxError(const vector<QuantizeBin> &bins, const vector<unsigned int> &occupied,
+                       unsigned int begin, unsigned int end, double errors[3])
+{
+    double count = 0;
+    double sums[3] = {0, 0, 0};
+    double squares[3] = {0, 0, 0};
+
+    for (unsigned int i = begin; i < end; i++)
+    {
+        const QuantizeBin &bin = bins[occupied[i]];
+        double components[3] = {(double)bin.blue, (double)bin.green, (double)bin.red};
+
+        count += bin.count;
+        for (int c = 0; c < 3; c++)
+        {
+            sums[c] += components[c];
+            squares[c] += components[c] * components[c] / bin.count;
+        }
+    }
+
+    double error = 0;
+    for (int c = 0; c < 3; c++)
+    {
+        double component = squares[c] - sums[c] * sums[c] / count;
+        if (errors != NULL)
+            errors[c] = component;
+        error += component;
+    }
+
+    return error;
+}
+
+/**
+ * @brief Splits histogram into boxes until there are 256 of them, box with
+ * biggest error is cut across its widest component where summed error of
+ * both halves is smallest, palette colors are box means
+ */
+void ColorQuantizer::medianCut()
+{
+    vector<QuantizeBox> boxes;
+    vector<unsigned long long> keys;
+    QuantizeBox first = {0, (unsigned int)this->occupied.size(), 0};
+
+    first.error = boxError(this->bins, this->occupied, first.begin, first.end, NULL);
+    boxes.push_back(first);
+
+    while (boxes.size() < QUANTIZE_COLORS)
+    {
+        // Box with biggest error that has more than one bin
+        int split = -1;
+        for (size_t i = 0; i < boxes.size(); i++)
+        {
+            if (boxes[i].end - boxes[i].begin > 1 && boxes[i].error > 0 &&
+                (split < 0 || boxes[i].error > boxes[split].error))
+                split = i;
+        }
+
+        if (split < 0)
+            break;
+
+        QuantizeBox &box = boxes[split];
+        double errors[3];
+        boxError(this->bins, this->occupied, box.begin, box.end, errors);
+
+        int axis = 0;
+        for (int c = 1; c < 3; c++)
+        {
+            if (errors[c] > errors[axis])
+                axis = c;
+        }
+
+        // Bins are sorted by fixed point mean of axis component, ties by bin index
+        keys.resize(box.end - box.begin);
+        for (unsigned int i = box.begin; i < box.end; i++)
+        {
+            const QuantizeBin &bin = this->bins[this->occupied[i]];
+            unsigned long long sum = axis == 0 ? bin.blue : (axis == 1 ? bin.green : bin.red);
+            keys[i - box.begin] = (sum << QUANTIZE_MEAN_BITS) / bin.count << 32 | this->occupied[i];
+        }
+
+        sort(keys.begin(), keys.end());
+        for (unsigned int i = box.begin; i < box.end; i++)
+            this->occupied[i] = (unsigned int)keys[i - box.begin];
+
+        // Prefix sums give error of both halves for every cut
+        double total_count = 0;
+        double total_sums[3] = {0, 0, 0};
+        for (unsigned int i = box.begin; i < box.end; i++)
+        {
+            const QuantizeBin &bin = this->bins[this->occupied[i]];
+            total_count += bin.count;
+            total_sums[0] += bin.blue;
+            total_sums[1] += bin.green;
+            total_sums[2] += bin.red;
+        }
+
+        double count = 0;
+        double sums[3] = {0, 0, 0};
+        unsigned int cut = box.begin + 1;
+        double best = -1;
+        for (unsigned int i = box.begin; i + 1 < box.end; i++)
+        {
+            const QuantizeBin &bin = this->bins[this->occupied[i]];
+            count += bin.count;
+            sums[0] += bin.blue;
+            sums[1] += bin.green;
+            sums[2] += bin.red;
+
+            // Squares of bins are same for every cut, only means matter
+            double score = 0;
+            for (int c = 0; c < 3; c++)
+            {
+                double rest = total_sums[c] - sums[c];
+                score += sums[c] * sums[c] / count + rest * rest / (total_count - count);
+            }
+
+            if (score > best)
+            {
+                best = score;
+                cut = i + 1;
+            }
+        }
+
+        QuantizeBox second = {cut, box.end, 0};
+        box.end = cut;
+        box.error = boxError(this->bins, this->occupied, box.begin, box.end, NULL);
+        second.error = boxError(this->bins, this->occupied, second.begin, second.end, NULL);
+        boxes.push_back(second);
+    }
+
+    this->colors = 0;
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        unsigned long long count = 0, blue = 0, green = 0, red = 0;
+
+        for (unsigned int j = boxes[i].begin; j < boxes[i].end; j++)
+        {
+            const QuantizeBin &bin = this->bins[this->occupied[j]];
+            count += bin.count;
+            blue += bin.blue;
+            green += bin.green;
+            red += bin.red;
+        }
+
+        if (count != 0)
+            this->addColor((blue + count / 2) / count, (green + count / 2) / count, (red + count / 2) / count);
+    }
+}
+
+/**
+ * @brief Refines palette by k-means iterations over histogram bins
+ */
+void ColorQuantizer::refine()
+{
+    for (unsigned int iteration = 0; iteration < this->iterations; iteration++)
+    {
+        vector<QuantizeBin> clusters(this->colors);
+        QuantizeBin empty = {0, 0, 0, 0};
+        fill(clusters.begin(), clusters.end(), empty);
+
+        for (size_t i = 0; i < this->occupied.size(); i++)
+        {
+            const QuantizeBin &bin = this->bins[this->occupied[i]];
+            int nearest = this->findNearest((bin.blue + bin.count / 2) / bin.count,
+                                            (bin.green + bin.count / 2) / bin.count,
+                                            (bin.red + bin.count / 2) / bin.count);
+
+            clusters[nearest].count += bin.count;
+            clusters[nearest].blue += bin.blue;
+            clusters[nearest].green += bin.green;
+            clusters[nearest].red += bin.red;
+        }
+
+        // Colors without bins are kept
+        bool changed = false;
+        for (unsigned int i = 0; i < this->colors; i++)
+        {
+            const QuantizeBin &cluster = clusters[i];
+            if (cluster.count == 0)
+                continue;
+
+            int blue = (cluster.blue + cluster.count / 2) / cluster.count;
+            int green = (cluster.green + cluster.count / 2) / cluster.count;
+            int red = (cluster.red + cluster.count / 2) / cluster.count;
+
+            if (blue != this->blue[i] || green != this->green[i] || red != this->red[i])
+            {
+                this->blue[i] = blue;
+                this->green[i] = green;
+                this->red[i] = red;
+                changed = true;
+            }
+        }
+
+        if (!changed)
+            break;
+    }
+}
+
+/**
+ * @brief Pool task, finds nearest palette color of cube cells, cells with
+ * pixels use their mean color, empty cells their center
+ * @param argument Pointer to QuantizeStripe
+ */
+void ColorQuantizer::cubeTask(void *argument)
+{
+    QuantizeStripe *stripe = (QuantizeStripe *)argument;
+    ColorQuantizer *quantizer = stripe->quantizer;
+    unsigned int bits = quantizer->bits;
+    unsigned int shift = 8 - bits;
+    unsigned int mask = (1u << bits) - 1;
+    int half = 1 << (shift - 1);
+
+    for (unsigned int cell = stripe->first; cell < stripe->last; cell++)
+    {
+        const QuantizeBin &bin = quantizer->bins[cell];
+        int blue, green, red;
+
+        if (bin.count != 0)
+        {
+            blue = (bin.blue + bin.count / 2) / bin.count;
+            green = (bin.green + bin.count / 2) / bin.count;
+            red = (bin.red + bin.count / 2) / bin.count;
+        }
+        else
+        {
+            blue = ((cell >> (2 * bits)) << shift) + half;
+            green = (((cell >> bits) & mask) << shift) + half;
+            red = ((cell & mask) << shift) + half;
+        }
+
+        quantizer->cube[cell] = quantizer->findNearest(blue, green, red);
+    }
+}
+
+/**
+ * @brief Builds inverse color cube
+ * @param pool Thread pool, NULL to run on calling thread
+ */
+void ColorQuantizer::buildCube(tTHREADPOOL *pool)
+{
+    this->cube.resize(this->bins.size());
+
+    vector<QuantizeStripe> stripes;
+    splitStripes(this, this->cube.size(), 0, pool, stripes);
+
+    runTasks(pool, cubeTask, &stripes[0], sizeof(QuantizeStripe), stripes.size());
+}
+
+/**
+ * @brief Pool task, replaces stripe pixels by palette colors
+ * @param argument Pointer to QuantizeStripe
+ */
+void ColorQuantizer::mapTask(void *argument)
+{
+    QuantizeStripe *stripe = (QuantizeStripe *)argument;
+    const ColorQuantizer *quantizer = stripe->quantizer;
+    unsigned int bits = quantizer->bits;
+    unsigned int shift = 8 - bits;
+    const u_int8_t *cube = &quantizer->cube[0];
+
+    // Byte stores may alias anything, palette is copied to locals
+    u_int8_t palette[QUANTIZE_COLORS][3];
+    for (unsigned int i = 0; i < quantizer->colors; i++)
+    {
+        palette[i][0] = quantizer->blue[i];
+        palette[i][1] = quantizer->green[i];
+        palette[i][2] = quantizer->red[i];
+    }
+
+    for (unsigned int y = stripe->first; y < stripe->last; y++)
+    {
+        const u_int8_t *pixel = stripe->image->ptr<u_int8_t>(y);
+        const u_int8_t *end = pixel + 3 * stripe->image->cols;
+        u_int8_t *out = stripe->output->ptr<u_int8_t>(y);
+
+        for (; pixel != end; pixel += 3, out += 3)
+        {
+            const u_int8_t *color = palette[cube[(pixel[0] >> shift) << (2 * bits) |
+                                                 (pixel[1] >> shift) << bits |
+                                                 (pixel[2] >> shift)]];
+            out[0] = color[0];
+            out[1] = color[1];
+            out[2] = color[2];
+        }
+    }
+}
+
+/**
+ * @brief Reduces image to at most 256 colors
+ * @param image CV_8UC3 image
+ * @param output Output CV_8UC3 image with palette colors, can be same as image
+ * @param pool Thread pool for stripes, NULL to run on calling thread
+ * @param dither Dithering of mapped pixels
+ */
+void ColorQuantizer::quantize(const Mat &image, Mat &output, tTHREADPOOL *pool, enum dither_mode dither)
+{
+    if (image.type() != CV_8UC3)
+        throw "Quantizer accepts only CV_8UC3 images";
+
+    this->buildHistogram(image, pool);
+    this->medianCut();
+    this->refine();
+    this->buildCube(pool);
+
+    output.create(image.rows, image.cols, CV_8UC3);
+
+    if (dither != DITHER_NONE)
+    {
+        ColorDitherer::dither(*this, image, output, dither, pool);
+        return;
+    }
+
+    vector<QuantizeStripe> stripes;
+    splitStripes(this, image.rows, 0, pool, stripes);
+    for (size_t i = 0; i < stripes.size(); i++)
+    {
+        stripes[i].image = &image;
+        stripes[i].output = &output;
+    }
+
+    runTasks(pool, mapTask, &stripes[0], sizeof(QuantizeStripe), stripes.size());
+}
@@ -0,0 +1,139 @@
+#ifndef QUANTIZER_H
+#define QUANTIZER_H
+
+#include <cv.h>
+#include <vector>
+#include "threadpool.h"
+
+// Maximal number of palette colors
+#define QUANTIZE_COLORS 256
+
+// Palette is padded to 4 colors per SIMD step, padding color is never nearest
+#define QUANTIZE_PADDING_COLOR 4096
+
+// Histogram bits per channel and k-means iterations of quality levels
+#define QUANTIZE_FAST_BITS 5
+#define QUANTIZE_FAST_ITERATIONS 0
+#define QUANTIZE_NORMAL_BITS 5
+#define QUANTIZE_NORMAL_ITERATIONS 3
+#define QUANTIZE_BEST_BITS 6
+#define QUANTIZE_BEST_ITERATIONS 10
+
+// Fraction bits of component means that order bins in median cut
+#define QUANTIZE_MEAN_BITS 16
+
+// Stripe sums are kept in 32 bits, 255 * pixels has to fit
+#define QUANTIZE_STRIPE_PIXELS (1 << 24)
+#define QUANTIZE_MIN_STRIPE_ROWS 16
+
+using namespace cv;
+using namespace std;
+
+/**
+ * @brief Speed/quality levels of quantizer
+ */
+enum quantize_level
+{
+    QUANTIZE_FAST,      ///< Median cut
+    QUANTIZE_NORMAL,    ///< Median cut refined by k-means
+    QUANTIZE_BEST       ///< Median cut refined by k-means on finer histogram
+};
+
+/**
+ * @brief Dithering of quantized image
+ */
+enum dither_mode
+{
+    DITHER_NONE,                ///< Nearest palette color
+    DITHER_FLOYD_STEINBERG,     ///< Error diffusion, rows run as wavefront
+    DITHER_BAYER,               ///< Ordered dithering by Bayer matrix
+    DITHER_BLUE_NOISE           ///< Ordered dithering by blue noise matrix
+};
+
+/**
+ * @brief Histogram bin, color sums of pixels that fall into it
+ */
+struct QuantizeBin
+{
+    unsigned long long count;
+    unsigned long long blue;
+    unsigned long long green;
+    unsigned long long red;
+};
+
+/**
+ * @brief Reduces image to at most 256 colors, palette is built by median cut
+ * over histogram of color cube cells and pixels are mapped through inverse
+ * color lookup cube. Histogram, inverse cube and mapping run in parallel stripes,
+ * nearest color search has SSE4.1 kernel.
+ */
+class ColorQuantizer
+{
+private:
+    unsigned int bits;
+    unsigned int iterations;
+    bool simd;
+
+    vector<QuantizeBin> bins;
+    vector<unsigned int> occupied;
+    pthread_mutex_t mutex;
+
+    /// Palette components, padded to multiple of 4 colors
+    int blue[QUANTIZE_COLORS];
+    int green[QUANTIZE_COLORS];
+    int red[QUANTIZE_COLORS];
+    unsigned int colors;
+
+    /// Palette index of every cell of color cube
+    vector<u_int8_t> cube;
+
+    void buildHistogram(const Mat &image, tTHREADPOOL *pool);
+    void medianCut();
+    void refine();
+    void buildCube(tTHREADPOOL *pool);
+    void addColor(int blue, int green, int red);
+
+    static void histogramTask(void *argument);
+    static void cubeTask(void *argument);
+    static void mapTask(void *argument);
+
+public:
+    ColorQuantizer(enum quantize_level level = QUANTIZE_NORMAL);
+    ~ColorQuantizer();
+    void quantize(const Mat &image, Mat &output, tTHREADPOOL *pool = NULL,
+                  enum dither_mode dither = DITHER_NONE);
+    int findNearest(int blue, int green, int red) const;
+
+    /**
+     * @brief Looks up palette index of color in inverse color cube
+     * @param blue Blue component
+     * @param green Green component
+     * @param red Red component
+     * @return Palette index
+     */
+    inline u_int8_t lookup(int blue, int green, int red) const
+    {
+        unsigned int shift = 8 - this->bits;
+        return this->cube[(blue >> shift) << (2 * this->bits) |
+                          (green >> shift) << this->bits |
+                          (red >> shift)];
+    }
+
+    /**
+     * @brief Gets number of palette colors
+     * @return Number of colors
+     */
+    inline unsigned int getColors() const {return this->colors;}
+
+    /**
+     * @brief Gets palette color
+     * @param index Palette index
+     * @return Color code (blue << 16 | green << 8 | red)
+     */
+    inline unsigned int getColor(unsigned int index) const
+    {
+        return this->blue[index] << 16 | this->green[index] << 8 | this->red[index];
+    }
+};
+
+#endif // QUANTIZER_H
@@ -18,7 +18,8 @@ public:
     GIFdictionary dictionary;
 
 public:
-    inline SubBlock(const Mat &data, unsigned int offset_x, unsigned int offset_y ,unsigned int width, unsigned int height)
+    inline SubBlock(const Mat &data, unsigned int offset_x, unsigned int offset_y ,unsigned int width, unsigned int height,
+                    const vector<unsigned int> &colors)
     {
         this->data = Mat(data, Rect(offset_x, offset_y, width, height));
         this->offset_x = offset_x;
@@ -26,19 +27,7 @@ public:
         this->width = width;
         this->height = height;
 
-        set<unsigned int>colors;
-
-        for (unsigned int y = 0; y < this->data.rows; y++)
-        {
-            for (unsigned int x = 0; x < this->data.cols; x++)
-            {
-                // Creates color code
-                colors.insert(this->data.at<Vec3b>(y, x).val[0] << 16 |
-                              this->data.at<Vec3b>(y, x).val[1] << 8 |
-                              this->data.at<Vec3b>(y, x).val[2]);
-            }
-        }
-
+        // Colors were already collected by caller
         this->dictionary.addColors(colors);
     }
 
@@ -0,0 +1,225 @@
+/*
+ *  File name: threadpool.cpp
+ *  Created on: 17. 10. 2026
+ *  Type: Source file
+ *  Description: Include functions for fixed size pthread pool with FIFO task queue
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "threadpool.h"
+
+/**
+ * Function return number of online CPUs
+ *
+ * @return Number of CPUs, at least 1
+ */
+int getCpuCount(void) {
+
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return count > 0 ? (int)count : 1;
+}
+
+/**
+ * Worker thread - run queued tasks until pool is freed
+ *
+ * @param argument Pointer to thread pool
+ * @return NULL
+ */
+static void *threadPoolWorker(void *argument) {
+
+	tTHREADPOOL *pool = (tTHREADPOOL *)argument;
+
+	pthread_mutex_lock(&pool->mutex);
+	while (1) {
+
+		// Wait for task
+		while (pool->first == NULL && !pool->shutdown)
+			pthread_cond_wait(&pool->taskReady, &pool->mutex);
+
+		if (pool->first == NULL && pool->shutdown)
+			break;
+
+		// Take first task from queue
+		tTASK *task = pool->first;
+		pool->first = task->next;
+		if (pool->first == NULL)
+			pool->last = NULL;
+		pthread_mutex_unlock(&pool->mutex);
+
+		task->function(task->argument);
+		free(task);
+
+		pthread_mutex_lock(&pool->mutex);
+		pool->activeTasks--;
+		if (pool->activeTasks == 0)
+			pthread_cond_broadcast(&pool->allDone);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	return NULL;
+}
+
+/**
+ * Function start pool threads
+ *
+ * @param pool Pointer to thread pool
+ * @param threadCount Number of threads
+ * @return 0 on success, 1 on failure
+ */
+int initThreadPool(tTHREADPOOL *pool, int threadCount) {
+
+	pool->threads = (pthread_t *)malloc(threadCount * sizeof(pthread_t));
+	if (pool->threads == NULL)
+		return EXIT_FAILURE;
+
+	pool->threadCount = 0;
+	pool->first = NULL;
+	pool->last = NULL;
+	pool->activeTasks = 0;
+	pool->shutdown = 0;
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->taskReady, NULL);
+	pthread_cond_init(&pool->allDone, NULL);
+
+	for (int i = 0; i < threadCount; i++) {
+		if (pthread_create(&pool->threads[i], NULL, threadPoolWorker, pool)) {
+			freeThreadPool(pool);
+			return EXIT_FAILURE;
+		}
+		pool->threadCount++;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function add task at the end of queue
+ *
+ * @param pool Pointer to thread pool
+ * @param function Task function
+ * @param argument Task function argument
+ * @return 0 on success, 1 on failure
+ */
+int submitTask(tTHREADPOOL *pool, tTASKFUNCTION function, void *argument) {
+
+	tTASK *task = (tTASK *)malloc(sizeof(tTASK));
+	if (task == NULL)
+		return EXIT_FAILURE;
+
+	task->function = function;
+	task->argument = argument;
+	task->next = NULL;
+
+	pthread_mutex_lock(&pool->mutex);
+	if (pool->last == NULL)
+		pool->first = task;
+	else
+		pool->last->next = task;
+	pool->last = task;
+	pool->activeTasks++;
+	pthread_cond_signal(&pool->taskReady);
+	pthread_mutex_unlock(&pool->mutex);
+
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Function wait until all submitted tasks are finished
+ *
+ * @param pool Pointer to thread pool
+ */
+void waitThreadPool(tTHREADPOOL *pool) {
+
+	pthread_mutex_lock(&pool->mutex);
+	while (pool->activeTasks > 0)
+		pthread_cond_wait(&pool->allDone, &pool->mutex);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+/**
+ * Function run first queued task on calling thread
+ *
+ * @param pool Pointer to thread pool
+ * @return 1 when task was run, 0 when queue is empty
+ */
+static int runQueuedTask(tTHREADPOOL *pool) {
+
+	pthread_mutex_lock(&pool->mutex);
+	tTASK *task = pool->first;
+	if (task != NULL) {
+		pool->first = task->next;
+		if (pool->first == NULL)
+			pool->last = NULL;
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	if (task == NULL)
+		return 0;
+
+	task->function(task->argument);
+	free(task);
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->activeTasks--;
+	if (pool->activeTasks == 0)
+		pthread_cond_broadcast(&pool->allDone);
+	pthread_mutex_unlock(&pool->mutex);
+
+	return 1;
+}
+
+/**
+ * Function run array of tasks and wait until they are finished. First task runs
+ * on calling thread, then calling thread takes queued tasks until queue is empty,
+ * so pool with one thread less than CPUs keeps all CPUs busy. Task that can not
+ * be queued runs on calling thread too.
+ *
+ * @param pool Pointer to thread pool, NULL to run all tasks on calling thread
+ * @param function Task function
+ * @param arguments Array of task arguments
+ * @param size Size of one task argument in bytes
+ * @param count Number of tasks
+ */
+void runTasks(tTHREADPOOL *pool, tTASKFUNCTION function, void *arguments, size_t size, int count) {
+
+	char *argument = (char *)arguments;
+
+	for (int i = 1; i < count; i++)
+		if (pool == NULL || submitTask(pool, function, argument + i * size))
+			function(argument + i * size);
+
+	if (count > 0)
+		function(argument);
+
+	if (pool != NULL && count > 1) {
+		while (runQueuedTask(pool))
+			;
+		waitThreadPool(pool);
+	}
+}
+
+/**
+ * Function finish queued tasks and stop pool threads
+ *
+ * @param pool Pointer to thread pool
+ */
+void freeThreadPool(tTHREADPOOL *pool) {
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->shutdown = 1;
+	pthread_cond_broadcast(&pool->taskReady);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (int i = 0; i < pool->threadCount; i++)
+		pthread_join(pool->threads[i], NULL);
+
+	pthread_mutex_destroy(&pool->mutex);
+	pthread_cond_destroy(&pool->taskReady);
+	pthread_cond_destroy(&pool->allDone);
+	free(pool->threads);
+	pool->threads = NULL;
+	pool->threadCount = 0;
+}
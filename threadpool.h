@@ -0,0 +1,47 @@
+/*
+ *  File name: threadpool.h
+ *  Created on: 17. 10. 2026
+ *  Type: Header file
+ *  Description: Include functions declarations for fixed size pthread pool
+ */
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <pthread.h>
+#include <stddef.h>
+
+typedef void (*tTASKFUNCTION)(void *argument);
+
+/**
+ * @brief Queued task
+ */
+typedef struct tTASK{
+	tTASKFUNCTION function;
+	void *argument;
+	struct tTASK *next;
+} tTASK;
+
+/**
+ * @brief Thread pool struct
+ */
+typedef struct{
+	pthread_t *threads;
+	int threadCount;
+	tTASK *first;
+	tTASK *last;
+	int activeTasks;
+	int shutdown;
+	pthread_mutex_t mutex;
+	pthread_cond_t taskReady;
+	pthread_cond_t allDone;
+} tTHREADPOOL;
+
+int getCpuCount(void);
+int initThreadPool(tTHREADPOOL *pool, int threadCount);
+int submitTask(tTHREADPOOL *pool, tTASKFUNCTION function, void *argument);
+void waitThreadPool(tTHREADPOOL *pool);
+void runTasks(tTHREADPOOL *pool, tTASKFUNCTION function, void *arguments, size_t size, int count);
+void freeThreadPool(tTHREADPOOL *pool);
+
+#endif /* THREADPOOL_H_ */